@@ -0,0 +1,224 @@
+#include "../include/crafting.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Recipe matching benchmark: a synthetic book of shaped and shapeless recipes (10k by
+// default), matched against 3x3 grids holding placed, shifted and mirrored recipes
+// plus random clutter. RecipeBook::Match is timed against a scan over every recipe,
+// and the two have to agree on every grid the scan is run on.
+//
+// Headless; see the "build crafting bench" task.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        int recipes = 10000;
+        int items = 64;
+        int queries = 200000;
+        int scanQueries = 2000;
+        uint32_t seed = 1;
+    };
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --recipes N        recipes in the book (10000)\n"
+                  << "  --items N          distinct ingredient items (64)\n"
+                  << "  --queries N        grids matched through the index (200000)\n"
+                  << "  --scan-queries N   of those, also matched by scanning (2000)\n"
+                  << "  --seed S           synthetic data randomness (1)" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (name == "--recipes") options.recipes = atoi(value.c_str());
+            else if (name == "--items") options.items = atoi(value.c_str());
+            else if (name == "--queries") options.queries = atoi(value.c_str());
+            else if (name == "--scan-queries") options.scanQueries = atoi(value.c_str());
+            else if (name == "--seed") options.seed = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+            else return false;
+        }
+        return options.recipes > 0 && options.items > 1 && options.queries > 0 &&
+               options.scanQueries >= 0 && options.scanQueries <= options.queries;
+    }
+
+    uint32_t NextRandom(uint32_t& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    int RandomInt(uint32_t& state, int count) {
+        return (int)(NextRandom(state) % (uint32_t)count);
+    }
+
+    int RandomItem(uint32_t& state, const Options& options) {
+        return 1 + RandomInt(state, options.items);
+    }
+
+    // Random recipes until the book holds the requested count; duplicates are refused
+    // by the book and simply retried
+    void FillBook(RecipeBook& book, const Options& options, uint32_t& state) {
+        while (book.GetRecipeCount() < options.recipes) {
+            std::string name = "recipe_" + std::to_string(book.GetRecipeCount());
+            if (RandomInt(state, 10) < 7) {
+                int width = 1 + RandomInt(state, 3);
+                int height = 1 + RandomInt(state, 3);
+                std::vector<int> pattern(width * height);
+                for (int& slot : pattern) {
+                    slot = RandomInt(state, 10) < 3 ? ITEM_NONE : RandomItem(state, options);
+                }
+                book.AddShaped(name, width, height, pattern, RandomItem(state, options), 1);
+            } else {
+                std::vector<int> ingredients(1 + RandomInt(state, 9));
+                for (int& item : ingredients) {
+                    item = RandomItem(state, options);
+                }
+                book.AddShapeless(name, ingredients, RandomItem(state, options), 1);
+            }
+        }
+    }
+
+    // Half the grids lay out a recipe from the book, the rest are random clutter
+    CraftingGrid MakeGrid(const RecipeBook& book, const Options& options, uint32_t& state) {
+        CraftingGrid grid(3, 3);
+        if (RandomInt(state, 2) == 0) {
+            for (int& slot : grid.items) {
+                slot = RandomInt(state, 2) == 0 ? ITEM_NONE : RandomItem(state, options);
+            }
+            return grid;
+        }
+
+        const Recipe& recipe = book.GetRecipe(RandomInt(state, book.GetRecipeCount()));
+        if (recipe.shaped) {
+            int offsetX = RandomInt(state, 4 - recipe.width);
+            int offsetY = RandomInt(state, 4 - recipe.height);
+            bool mirrored = RandomInt(state, 2) == 0;
+            for (int y = 0; y < recipe.height; y++) {
+                for (int x = 0; x < recipe.width; x++) {
+                    int sourceX = mirrored ? recipe.width - 1 - x : x;
+                    grid.Set(offsetX + x, offsetY + y, recipe.ingredients[y * recipe.width + sourceX]);
+                }
+            }
+        } else {
+            // Shapeless ingredients go into random distinct slots
+            std::vector<int> slots = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+            for (size_t i = 0; i < recipe.ingredients.size(); i++) {
+                std::swap(slots[i], slots[i + RandomInt(state, 9 - (int)i)]);
+                grid.items[slots[i]] = recipe.ingredients[i];
+            }
+        }
+        return grid;
+    }
+
+    bool SamePattern(const Recipe& recipe, int width, int height, const std::vector<int>& items, bool mirrored) {
+        if (recipe.width != width || recipe.height != height) return false;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int sourceX = mirrored ? width - 1 - x : x;
+                if (recipe.ingredients[y * width + sourceX] != items[y * width + x]) return false;
+            }
+        }
+        return true;
+    }
+
+    // What matching costs without the index: every recipe is checked in turn. Same
+    // precedence as RecipeBook::Match - shaped before shapeless, first registered wins.
+    int ScanMatch(const RecipeBook& book, const CraftingGrid& grid) {
+        int minX = grid.width, minY = grid.height, maxX = -1, maxY = -1;
+        std::vector<int> ingredients;
+        for (int y = 0; y < grid.height; y++) {
+            for (int x = 0; x < grid.width; x++) {
+                int item = grid.Get(x, y);
+                if (item == ITEM_NONE) continue;
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+                ingredients.push_back(item);
+            }
+        }
+        if (maxX < 0) return -1;
+
+        int width = maxX - minX + 1, height = maxY - minY + 1;
+        std::vector<int> trimmed(width * height);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                trimmed[y * width + x] = grid.Get(minX + x, minY + y);
+            }
+        }
+        std::sort(ingredients.begin(), ingredients.end());
+
+        for (int i = 0; i < book.GetRecipeCount(); i++) {
+            const Recipe& recipe = book.GetRecipe(i);
+            if (recipe.shaped && (SamePattern(recipe, width, height, trimmed, false) ||
+                                  SamePattern(recipe, width, height, trimmed, true))) {
+                return i;
+            }
+        }
+        for (int i = 0; i < book.GetRecipeCount(); i++) {
+            const Recipe& recipe = book.GetRecipe(i);
+            if (!recipe.shaped && recipe.ingredients == ingredients) return i;
+        }
+        return -1;
+    }
+
+    double Seconds(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    uint32_t state = options.seed;
+    RecipeBook book;
+    Clock::time_point start = Clock::now();
+    FillBook(book, options, state);
+    double buildTime = Seconds(start);
+
+    std::vector<CraftingGrid> grids;
+    grids.reserve(options.queries);
+    for (int i = 0; i < options.queries; i++) {
+        grids.push_back(MakeGrid(book, options, state));
+    }
+
+    std::vector<int> indexed(grids.size());
+    start = Clock::now();
+    for (size_t i = 0; i < grids.size(); i++) {
+        indexed[i] = book.Match(grids[i]);
+    }
+    double indexTime = Seconds(start);
+
+    int mismatches = 0;
+    start = Clock::now();
+    for (int i = 0; i < options.scanQueries; i++) {
+        if (ScanMatch(book, grids[i]) != indexed[i]) mismatches++;
+    }
+    double scanTime = Seconds(start);
+
+    int matched = 0;
+    for (int result : indexed) matched += result >= 0 ? 1 : 0;
+
+    double indexNs = indexTime * 1e9 / options.queries;
+    printf("%d recipes over %d items, built in %.2f ms\n", book.GetRecipeCount(), options.items, buildTime * 1e3);
+    printf("  indexed match: %9.1f ns/grid over %d grids, %d matched\n", indexNs, options.queries, matched);
+    if (options.scanQueries > 0) {
+        double scanNs = scanTime * 1e9 / options.scanQueries;
+        printf("  full scan:     %9.1f ns/grid over %d grids, %.0fx slower\n", scanNs, options.scanQueries, scanNs / indexNs);
+        printf("  disagreements: %d\n", mismatches);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
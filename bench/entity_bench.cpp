@@ -0,0 +1,416 @@
+#include "../include/entity.h"
+#include "../include/spatial_grid.h"
+#include "../include/block_registry.h"
+#include "../include/job_system.h"
+#include "../include/voxel.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Entity benchmark: EntityWorld's archetype chunks (structure-of-arrays, systems spread
+// over the job system) against an array-of-objects baseline. The baseline keeps one
+// struct per entity in a single vector and runs the same wander, separation, physics
+// and lifetime rules on one thread, with its own SpatialGrid for neighbor queries, so
+// the difference is layout and parallelism rather than algorithms. The full tick is
+// mostly grid queries and voxel lookups, so a second measurement runs only the motion
+// and lifetime loops, on one thread with no grid and no world, to show what the
+// layout itself buys. A third world full of dropped items that have come to rest
+// measures what sleeping items cost per tick.
+//
+// See the "build entity bench" task. Run from the workspace folder so
+// assets/data/blocks.json is found.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const float GRAVITY = -20.0f;
+    const float MOB_SPEED = 1.5f;
+    const float MOB_SEPARATION_RADIUS = 0.5f;
+
+    struct Options {
+        int entities = 20000;
+        int ticks = 300;
+        int world = 16;
+        float projectileShare = 0.25f;
+        int sleepingItems = 9500;
+    };
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --entities N      entities to spawn (20000)\n"
+                  << "  --ticks N         ticks per measurement (300)\n"
+                  << "  --world N         world size in chunks, N x N (16)\n"
+                  << "  --projectiles F   share of entities that are projectiles (0.25)\n"
+                  << "  --items N         dropped items left to fall asleep (9500)" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (name == "--entities") options.entities = atoi(value.c_str());
+            else if (name == "--ticks") options.ticks = atoi(value.c_str());
+            else if (name == "--world") options.world = atoi(value.c_str());
+            else if (name == "--projectiles") options.projectileShare = (float)atof(value.c_str());
+            else if (name == "--items") options.sleepingItems = atoi(value.c_str());
+            else return false;
+        }
+        return options.entities > 0 && options.ticks > 0 && options.world > 0 &&
+               options.projectileShare >= 0.0f && options.projectileShare <= 1.0f && options.sleepingItems >= 0;
+    }
+
+    uint32_t NextRandom(uint32_t& state) {
+        uint32_t x = state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state = x;
+        return x;
+    }
+
+    float RandomFloat(uint32_t& state) {
+        return (NextRandom(state) & 0xFFFFFF) / (float)0x1000000;
+    }
+
+    int VoxelCoord(float v) {
+        return (int)floorf(v + 0.5f);
+    }
+
+    bool IsSolidAt(const VoxelWorld& world, float x, float y, float z) {
+        return world.IsSolid(VoxelCoord(x), VoxelCoord(y), VoxelCoord(z));
+    }
+
+    // What both sides spawn, in order
+    struct SpawnPlan {
+        bool projectile;
+        Vector3 position;
+        Vector3 velocity;
+    };
+
+    std::vector<SpawnPlan> PlanSpawns(const Options& options) {
+        std::vector<SpawnPlan> plan;
+        uint32_t state = 12345;
+        float span = (float)(options.world * VoxelChunk::CHUNK_SIZE - 2);
+        for (int i = 0; i < options.entities; i++) {
+            SpawnPlan entry;
+            entry.projectile = RandomFloat(state) < options.projectileShare;
+            entry.position = {1.0f + RandomFloat(state) * span, 12.0f, 1.0f + RandomFloat(state) * span};
+            float angle = RandomFloat(state) * 2.0f * PI;
+            entry.velocity = entry.projectile ? (Vector3){cosf(angle) * 8.0f, 6.0f, sinf(angle) * 8.0f}
+                                              : (Vector3){0.0f, 0.0f, 0.0f};
+            plan.push_back(entry);
+        }
+        return plan;
+    }
+
+    // The array-of-objects side: every entity carries every field
+    struct BaselineEntity {
+        bool alive;
+        bool projectile;
+        bool onGround;
+        Vector3 position;
+        Vector3 velocity;
+        float lifetime;
+        float damage;
+        float wanderTimer;
+        float heading;
+        uint32_t rngState;
+    };
+
+    class BaselineWorld {
+        std::vector<BaselineEntity> entities;
+        SpatialGrid grid;
+        std::vector<EntityId> neighbors;
+
+    public:
+        void Spawn(const SpawnPlan& plan) {
+            BaselineEntity entity = {};
+            entity.alive = true;
+            entity.projectile = plan.projectile;
+            entity.position = plan.position;
+            entity.velocity = plan.velocity;
+            entity.lifetime = 10.0f;
+            entity.damage = 1.0f;
+            entity.rngState = ((uint32_t)entities.size() * 2654435761u) ^ 0x9E3779B9u;
+            entities.push_back(entity);
+        }
+
+        // Gravity, integration and lifetimes only: the layout-only loop
+        void Move(float deltaTime) {
+            for (BaselineEntity& entity : entities) {
+                if (!entity.alive) continue;
+                entity.velocity.y += (entity.projectile ? GRAVITY * 0.25f : GRAVITY) * deltaTime;
+                entity.position.x += entity.velocity.x * deltaTime;
+                entity.position.y += entity.velocity.y * deltaTime;
+                entity.position.z += entity.velocity.z * deltaTime;
+                if (entity.projectile) entity.lifetime -= deltaTime;
+            }
+        }
+
+        double SumHeights() const {
+            double sum = 0.0;
+            for (const BaselineEntity& entity : entities) sum += entity.alive ? entity.position.y : 0.0f;
+            return sum;
+        }
+
+        int GetAliveCount() const {
+            int alive = 0;
+            for (const BaselineEntity& entity : entities) alive += entity.alive ? 1 : 0;
+            return alive;
+        }
+
+        void Update(float deltaTime, const VoxelWorld& world) {
+            grid.Clear();
+            for (size_t i = 0; i < entities.size(); i++) {
+                const BaselineEntity& entity = entities[i];
+                if (entity.alive) grid.Insert(EntityId((uint32_t)i, 0), entity.position, entity.projectile ? 0.05f : 0.3f);
+            }
+            grid.Build();
+
+            for (size_t i = 0; i < entities.size(); i++) {
+                BaselineEntity& entity = entities[i];
+                if (!entity.alive) continue;
+                if (!entity.projectile) UpdateMob(entity, (uint32_t)i, deltaTime);
+                UpdatePhysics(entity, deltaTime, world);
+                if (entity.projectile) {
+                    entity.lifetime -= deltaTime;
+                    if (entity.lifetime <= 0.0f) entity.alive = false;
+                }
+            }
+        }
+
+    private:
+        void UpdateMob(BaselineEntity& mob, uint32_t index, float deltaTime) {
+            mob.wanderTimer -= deltaTime;
+            if (mob.wanderTimer <= 0.0f) {
+                mob.heading = RandomFloat(mob.rngState) * 2.0f * PI;
+                mob.wanderTimer = 2.0f + RandomFloat(mob.rngState) * 4.0f;
+            }
+
+            float desiredX = cosf(mob.heading) * MOB_SPEED;
+            float desiredZ = sinf(mob.heading) * MOB_SPEED;
+
+            grid.QueryRadius(mob.position, MOB_SEPARATION_RADIUS, neighbors);
+            for (const EntityId& other : neighbors) {
+                if (other.index == index) continue;
+                Vector3 away = Vector3Subtract(mob.position, entities[other.index].position);
+                float distance = Vector3Length(away);
+                if (distance > 0.0001f && distance < MOB_SEPARATION_RADIUS) {
+                    float push = (MOB_SEPARATION_RADIUS - distance) / MOB_SEPARATION_RADIUS * MOB_SPEED * 2.0f;
+                    desiredX += away.x / distance * push;
+                    desiredZ += away.z / distance * push;
+                }
+            }
+
+            mob.velocity.x = desiredX;
+            mob.velocity.z = desiredZ;
+        }
+
+        static void UpdatePhysics(BaselineEntity& entity, float deltaTime, const VoxelWorld& world) {
+            entity.velocity.y += (entity.projectile ? GRAVITY * 0.25f : GRAVITY) * deltaTime;
+
+            float newX = entity.position.x + entity.velocity.x * deltaTime;
+            float newY = entity.position.y + entity.velocity.y * deltaTime;
+            float newZ = entity.position.z + entity.velocity.z * deltaTime;
+
+            if (entity.projectile) {
+                if (IsSolidAt(world, newX, newY, newZ)) {
+                    entity.alive = false;
+                    return;
+                }
+            } else if (IsSolidAt(world, newX, newY - 0.01f, newZ) && entity.velocity.y <= 0.0f) {
+                newY = VoxelCoord(newY - 0.01f) + 0.5f;
+                entity.velocity.y = 0.0f;
+                entity.onGround = true;
+            } else {
+                entity.onGround = false;
+            }
+
+            if (!entity.projectile && IsSolidAt(world, newX, newY + 0.5f, newZ)) {
+                if (entity.onGround && !IsSolidAt(world, newX, newY + 1.5f, newZ) &&
+                    !IsSolidAt(world, newX, newY + 2.5f, newZ)) {
+                    newY += 1.0f;
+                } else {
+                    newX = entity.position.x;
+                    newZ = entity.position.z;
+                }
+            }
+
+            entity.position = {newX, newY, newZ};
+        }
+    };
+
+    double Milliseconds(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // EntityWorld's chunks, gathered once so the layout-only loop can walk them on
+    // this thread instead of through the job system
+    std::vector<EntityChunk*> GatherChunks(EntityWorld& entities) {
+        std::vector<EntityChunk*> chunks;
+        std::mutex mutex;
+        entities.ForEachChunk(COMPONENT_POSITION | COMPONENT_VELOCITY, [&](EntityChunk& chunk) {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunks.push_back(&chunk);
+        });
+        return chunks;
+    }
+
+    // The same loop as BaselineWorld::Move over the archetype arrays
+    void MoveChunks(const std::vector<EntityChunk*>& chunks, float deltaTime) {
+        for (EntityChunk* chunk : chunks) {
+            bool projectile = chunk->Has(COMPONENT_PROJECTILE);
+            float fall = (projectile ? GRAVITY * 0.25f : GRAVITY) * deltaTime;
+            float* posX = chunk->posX.data();
+            float* posY = chunk->posY.data();
+            float* posZ = chunk->posZ.data();
+            float* velX = chunk->velX.data();
+            float* velY = chunk->velY.data();
+            float* velZ = chunk->velZ.data();
+            for (int row = 0; row < chunk->count; row++) {
+                velY[row] += fall;
+                posX[row] += velX[row] * deltaTime;
+                posY[row] += velY[row] * deltaTime;
+                posZ[row] += velZ[row] * deltaTime;
+            }
+            if (chunk->Has(COMPONENT_LIFETIME)) {
+                float* lifetime = chunk->lifetime.data();
+                for (int row = 0; row < chunk->count; row++) {
+                    lifetime[row] -= deltaTime;
+                }
+            }
+        }
+    }
+
+    double SumHeights(const std::vector<EntityChunk*>& chunks) {
+        double sum = 0.0;
+        for (const EntityChunk* chunk : chunks) {
+            for (int row = 0; row < chunk->count; row++) sum += chunk->posY[row];
+        }
+        return sum;
+    }
+
+    struct LayoutTimes {
+        double archetype;
+        double baseline;
+        bool heightsAgree;
+    };
+
+    // Fresh spawns on both sides, then only the motion and lifetime loops, so the
+    // difference is down to memory layout
+    LayoutTimes MeasureLayout(const Options& options, const std::vector<SpawnPlan>& plan) {
+        const float deltaTime = 1.0f / 60.0f;
+        EntityWorld entities;
+        BaselineWorld baseline;
+        for (const SpawnPlan& entry : plan) {
+            if (entry.projectile) entities.SpawnProjectile(entry.position, entry.velocity, 1.0f);
+            else entities.SpawnMob(entry.position);
+            baseline.Spawn(entry);
+        }
+        std::vector<EntityChunk*> chunks = GatherChunks(entities);
+
+        LayoutTimes times;
+        Clock::time_point start = Clock::now();
+        for (int tick = 0; tick < options.ticks; tick++) {
+            MoveChunks(chunks, deltaTime);
+        }
+        times.archetype = Milliseconds(start) / options.ticks;
+
+        start = Clock::now();
+        for (int tick = 0; tick < options.ticks; tick++) {
+            baseline.Move(deltaTime);
+        }
+        times.baseline = Milliseconds(start) / options.ticks;
+
+        double archetypeSum = SumHeights(chunks);
+        double baselineSum = baseline.SumHeights();
+        times.heightsAgree = fabs(archetypeSum - baselineSum) <= 1e-6 * fabs(baselineSum) + 1e-3;
+        return times;
+    }
+
+    // Items dropped across the terrain, each its own type so none merge, given a few
+    // seconds to land and fall asleep before ticks are timed
+    double MeasureSleepingItems(const Options& options, const VoxelWorld& world) {
+        const float deltaTime = 1.0f / 60.0f;
+        EntityWorld entities;
+        uint32_t state = 777;
+        float span = (float)(options.world * VoxelChunk::CHUNK_SIZE - 2);
+        for (int i = 0; i < options.sleepingItems; i++) {
+            Vector3 position = {1.0f + RandomFloat(state) * span, 12.0f, 1.0f + RandomFloat(state) * span};
+            Vector3 velocity = {RandomFloat(state) - 0.5f, 2.0f, RandomFloat(state) - 0.5f};
+            entities.SpawnItem(position, velocity, i + 1, 1);
+        }
+        for (int tick = 0; tick < 300; tick++) {
+            entities.Update(deltaTime, &world);
+        }
+
+        Clock::time_point start = Clock::now();
+        for (int tick = 0; tick < options.ticks; tick++) {
+            entities.Update(deltaTime, &world);
+        }
+        return Milliseconds(start) / options.ticks;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    BlockRegistry::Get().LoadModels();
+    BlockRegistry::Get().LoadFromJson();
+    VoxelWorld world(options.world, options.world);
+    world.GenerateTestTerrain();
+
+    std::vector<SpawnPlan> plan = PlanSpawns(options);
+    const float deltaTime = 1.0f / 60.0f;
+
+    EntityWorld entities;
+    for (const SpawnPlan& entry : plan) {
+        if (entry.projectile) entities.SpawnProjectile(entry.position, entry.velocity, 1.0f);
+        else entities.SpawnMob(entry.position);
+    }
+    Clock::time_point start = Clock::now();
+    for (int tick = 0; tick < options.ticks; tick++) {
+        entities.Update(deltaTime, &world);
+    }
+    double archetypeTime = Milliseconds(start) / options.ticks;
+
+    BaselineWorld baseline;
+    for (const SpawnPlan& entry : plan) {
+        baseline.Spawn(entry);
+    }
+    start = Clock::now();
+    for (int tick = 0; tick < options.ticks; tick++) {
+        baseline.Update(deltaTime, world);
+    }
+    double baselineTime = Milliseconds(start) / options.ticks;
+
+    printf("%d entities (%.0f%% projectiles), %d ticks, %d job workers\n", options.entities,
+           options.projectileShare * 100.0f, options.ticks, JobSystem::Get().GetWorkerCount());
+    printf("  archetype SoA:     %7.3f ms/tick, %d alive at the end\n", archetypeTime, entities.GetEntityCount());
+    printf("  array of objects:  %7.3f ms/tick, %d alive at the end\n", baselineTime, baseline.GetAliveCount());
+    printf("  speedup:           %.2fx\n", baselineTime / archetypeTime);
+
+    if (options.sleepingItems > 0) {
+        double sleepingTime = MeasureSleepingItems(options, world);
+        printf("  %d sleeping items: %7.3f ms/tick\n", options.sleepingItems, sleepingTime);
+    }
+
+    LayoutTimes layout = MeasureLayout(options, plan);
+    printf("layout only (motion and lifetimes, one thread, no grid or world)%s\n",
+           layout.heightsAgree ? "" : " - RESULTS DIFFER");
+    printf("  archetype SoA:     %7.3f ms/tick\n", layout.archetype);
+    printf("  array of objects:  %7.3f ms/tick\n", layout.baseline);
+    printf("  speedup:           %.2fx\n", layout.baseline / layout.archetype);
+    return 0;
+}
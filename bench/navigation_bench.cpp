@@ -0,0 +1,169 @@
+#include "../include/navigation.h"
+#include "../include/block_registry.h"
+#include "../include/job_system.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Pathfinding benchmark: paths per second over the test terrain, synchronous on one
+// thread, from the path cache, and queued on the job system the way the game asks
+// for them; plus how long Update takes to rebuild after a single-chunk edit.
+//
+// Headless; see the "build navigation bench" task. Run from the workspace folder so
+// assets/data/blocks.json is found.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        int width = 16;
+        int depth = 16;
+        int queries = 5000;
+        int edits = 50;
+        uint32_t seed = 1;
+    };
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --world WxD     world size in chunks (16x16)\n"
+                  << "  --queries N     paths per measurement (5000)\n"
+                  << "  --edits N       single-chunk edits to time rebuilds with (50)\n"
+                  << "  --seed S        query randomness (1)" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (name == "--world") {
+                if (sscanf(value.c_str(), "%dx%d", &options.width, &options.depth) != 2) return false;
+            }
+            else if (name == "--queries") options.queries = atoi(value.c_str());
+            else if (name == "--edits") options.edits = atoi(value.c_str());
+            else if (name == "--seed") options.seed = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+            else return false;
+        }
+        return options.width > 0 && options.depth > 0 && options.queries > 0 && options.edits >= 0;
+    }
+
+    uint32_t NextRandom(uint32_t& state) {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    // Feet position on the highest ground of a random column
+    Vector3 RandomSurface(const VoxelWorld& world, uint32_t& state) {
+        int x = (int)(NextRandom(state) % (uint32_t)(world.GetWidth() * VoxelChunk::CHUNK_SIZE));
+        int z = (int)(NextRandom(state) % (uint32_t)(world.GetDepth() * VoxelChunk::CHUNK_SIZE));
+        int y = VoxelChunk::CHUNK_HEIGHT - 1;
+        while (y > 0 && !(world.IsSolid(x, y - 1, z) && !world.IsSolid(x, y, z))) y--;
+        return {(float)x, y - 0.5f, (float)z};
+    }
+
+    double Seconds(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    BlockRegistry::Get().LoadModels();
+    BlockRegistry::Get().LoadFromJson();
+
+    VoxelWorld world(options.width, options.depth);
+    world.GenerateTestTerrain();
+
+    Clock::time_point start = Clock::now();
+    NavigationSystem navigation(&world);
+    double buildMs = Seconds(start) * 1000.0;
+
+    uint32_t state = options.seed;
+    std::vector<std::pair<Vector3, Vector3>> queries;
+    for (int i = 0; i < options.queries; i++) {
+        Vector3 from = RandomSurface(world, state);
+        Vector3 to = RandomSurface(world, state);
+        queries.push_back({from, to});
+    }
+
+    // Every pair is new, so each one is a full search
+    std::vector<Vector3> waypoints;
+    int found = 0;
+    size_t waypointTotal = 0;
+    start = Clock::now();
+    for (const auto& query : queries) {
+        if (navigation.FindPath(query.first, query.second, waypoints)) {
+            found++;
+            waypointTotal += waypoints.size();
+        }
+    }
+    double syncSeconds = Seconds(start);
+
+    // Same pairs again, up to the cache's size
+    int cachedCount = std::min(options.queries, (int)NavigationSystem::MAX_CACHED_PATHS - 1);
+    for (int i = 0; i < cachedCount; i++) {
+        navigation.FindPath(queries[i].first, queries[i].second, waypoints);
+    }
+    start = Clock::now();
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < cachedCount; i++) {
+            navigation.FindPath(queries[i].first, queries[i].second, waypoints);
+        }
+    }
+    double cachedSeconds = Seconds(start);
+
+    // New pairs on the job system, polled like the main loop does
+    for (auto& query : queries) {
+        query.first = RandomSurface(world, state);
+        query.second = RandomSurface(world, state);
+    }
+    std::vector<NavigationSystem::PathResult> results;
+    start = Clock::now();
+    for (const auto& query : queries) {
+        navigation.RequestPath(query.first, query.second);
+        navigation.PollResults(results);
+    }
+    while ((int)results.size() < options.queries) {
+        navigation.PollResults(results);
+    }
+    double asyncSeconds = Seconds(start);
+
+    // Dig a pit into one random chunk at a time; Update rebuilds it and its ring
+    double rebuildSeconds = 0.0;
+    for (int i = 0; i < options.edits; i++) {
+        Vector3 center = RandomSurface(world, state);
+        std::vector<BlockEdit> edits;
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dz = -1; dz <= 1; dz++) {
+                edits.emplace_back((int)center.x + dx, (int)(center.y - 0.5f), (int)center.z + dz, VOXEL_AIR);
+            }
+        }
+        world.ApplyEdits(edits);
+        start = Clock::now();
+        navigation.Update();
+        rebuildSeconds += Seconds(start);
+    }
+
+    std::cout << "world: " << options.width << "x" << options.depth << "\n"
+              << "workers: " << JobSystem::Get().GetWorkerCount() << "\n"
+              << "nodes: " << navigation.GetNodeCount() << "\n"
+              << "graph_build_ms: " << buildMs << "\n"
+              << "queries: " << options.queries << "\n"
+              << "found: " << found << "\n"
+              << "waypoints_mean: " << (found ? (double)waypointTotal / found : 0.0) << "\n"
+              << "sync_paths_per_second: " << options.queries / syncSeconds << "\n"
+              << "cached_paths_per_second: " << cachedCount * 10 / cachedSeconds << "\n"
+              << "async_paths_per_second: " << options.queries / asyncSeconds << "\n"
+              << "rebuild_ms_mean: " << (options.edits ? rebuildSeconds * 1000.0 / options.edits : 0.0) << std::endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/block_registry.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Bandwidth replay: players building heavily against an in-process server over
+// loopback, ticked as fast as possible with a fixed script so runs are repeatable.
+// Each player raises a wall a few blocks per tick and tears it down again every
+// 50 ticks, and an explosion goes off every 100 ticks. Reports what a player
+// downloads on join and during the replay, next to what one 14-byte record per
+// changed cell (i32 x, y, z, u8 type, metadata) would have cost, and checks every
+// client world against the server's at the end.
+//
+// Headless; see the "build network replay bench" task. Run from the workspace
+// folder so assets/data/blocks.json is found.
+
+namespace {
+    const int EDIT_RECORD_BYTES = 14;
+    const int RAW_CELL_BYTES = 2;  // Type and metadata
+
+    struct Options {
+        int players = 8;
+        int ticks = 400;
+        int width = 4, depth = 4;
+        int blocksPerTick = 4;  // Per player
+    };
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --players N    building players (8)\n"
+                  << "  --ticks N      server ticks to replay (400)\n"
+                  << "  --world WxD    world size in chunks (4x4)\n"
+                  << "  --rate N       blocks each player edits per tick (4)" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (name == "--players") options.players = atoi(value.c_str());
+            else if (name == "--ticks") options.ticks = atoi(value.c_str());
+            else if (name == "--world") {
+                if (sscanf(value.c_str(), "%dx%d", &options.width, &options.depth) != 2) return false;
+            }
+            else if (name == "--rate") options.blocksPerTick = atoi(value.c_str());
+            else return false;
+        }
+        return options.players > 0 && options.ticks > 0 && options.width > 0 && options.depth > 0 &&
+               options.blocksPerTick > 0;
+    }
+
+    // Player p's wall runs along X from its own origin, one layer per 16 placements
+    void BuildStep(GameClient& client, int player, int tick, const Options& options) {
+        int spanX = options.width * VoxelChunk::CHUNK_SIZE;
+        int spanZ = options.depth * VoxelChunk::CHUNK_SIZE;
+        VoxelType type = (tick / 50) % 2 ? VOXEL_AIR : VOXEL_COBBLESTONE;
+
+        for (int k = 0; k < options.blocksPerTick; k++) {
+            int placed = tick * options.blocksPerTick + k;
+            int x = (player * 8 + placed % 16) % spanX;
+            int y = 6 + (placed / 16) % 10;
+            int z = (player * 7 + tick / 40) % spanZ;
+            client.RequestSetBlock(x, y, z, type);
+        }
+    }
+
+    int CountMismatches(GameServer& server, std::vector<std::unique_ptr<GameClient>>& clients) {
+        VoxelWorld& world = server.GetWorld();
+        int mismatches = 0;
+        for (int x = 0; x < world.GetWidth() * VoxelChunk::CHUNK_SIZE; x++) {
+            for (int y = 0; y < VoxelChunk::CHUNK_HEIGHT; y++) {
+                for (int z = 0; z < world.GetDepth() * VoxelChunk::CHUNK_SIZE; z++) {
+                    Voxel expected = world.GetVoxel(x, y, z);
+                    for (auto& client : clients) {
+                        Voxel seen = client->GetWorld()->GetVoxel(x, y, z);
+                        if (seen.type != expected.type || seen.metadata != expected.metadata) mismatches++;
+                    }
+                }
+            }
+        }
+        return mismatches;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    BlockRegistry::Get().LoadModels();
+    BlockRegistry::Get().LoadFromJson();
+    GameServer server(options.width, options.depth);
+
+    // Every changed cell, as the per-edit protocol would have sent it
+    long long changedCells = 0;
+    server.GetWorld().AddEditListener([&changedCells](int, int, const std::vector<BlockEdit>& edits) {
+        changedCells += (long long)edits.size();
+    });
+
+    // Players stand in the middle and see the whole world
+    Vector3 center = {options.width * VoxelChunk::CHUNK_SIZE * 0.5f, 8.0f, options.depth * VoxelChunk::CHUNK_SIZE * 0.5f};
+    int viewDistance = std::min(GameServer::MAX_VIEW_DISTANCE, std::max(options.width, options.depth));
+    std::vector<std::unique_ptr<GameClient>> clients;
+    for (int i = 0; i < options.players; i++) {
+        clients.emplace_back(new GameClient());
+        clients.back()->Connect(server.ConnectLoopback(), "builder" + std::to_string(i), center, viewDistance);
+    }
+
+    // Until every client holds the world
+    for (int tick = 0; tick < 100 && server.GetChunksSent() < (uint64_t)options.players * options.width * options.depth; tick++) {
+        server.Tick();
+        for (auto& client : clients) client->Poll();
+    }
+    server.Tick();
+    for (auto& client : clients) client->Poll();
+
+    uint64_t joinBytes = clients[0]->GetConnection()->GetBytesReceived();
+    uint64_t deltasBefore = server.GetDeltaUpdatesSent();
+    uint64_t fullBefore = server.GetFullUpdatesSent();
+    changedCells = 0;
+
+    for (int tick = 0; tick < options.ticks; tick++) {
+        for (int i = 0; i < options.players; i++) {
+            BuildStep(*clients[i], i, tick, options);
+        }
+        if (tick % 100 == 50) clients[0]->RequestExplosion(center, 5.0f);
+        server.Tick();
+        for (auto& client : clients) client->Poll();
+    }
+    server.Tick();
+    for (auto& client : clients) client->Poll();
+
+    double replayBytes = 0.0;
+    for (auto& client : clients) replayBytes += (double)client->GetConnection()->GetBytesReceived();
+    replayBytes = replayBytes / options.players - (double)joinBytes;
+
+    double seconds = options.ticks * GameServer::TICK_INTERVAL;
+    double rawWorld = (double)options.width * options.depth * VoxelChunk::CHUNK_VOLUME * RAW_CELL_BYTES;
+    double perEdit = (double)changedCells * EDIT_RECORD_BYTES;
+    int mismatches = CountMismatches(server, clients);
+
+    printf("%d players, %d ticks (%.0f s of play), %dx%d chunks\n", options.players, options.ticks, seconds,
+           options.width, options.depth);
+    printf("  join:              %7.1f KB per player (%.1f KB raw)\n", joinBytes / 1024.0, rawWorld / 1024.0);
+    printf("  replay:            %7.1f KB per player, %.2f KB/s\n", replayBytes / 1024.0, replayBytes / 1024.0 / seconds);
+    printf("  per-edit records:  %7.1f KB per player for %lld changed cells\n", perEdit / 1024.0, changedCells);
+    printf("  chunk updates:     %llu deltas, %llu full resends\n",
+           (unsigned long long)(server.GetDeltaUpdatesSent() - deltasBefore),
+           (unsigned long long)(server.GetFullUpdatesSent() - fullBefore));
+    printf("  client worlds:     %s\n", mismatches == 0 ? "match the server" : "DIFFER from the server");
+    return mismatches == 0 ? 0 : 1;
+}
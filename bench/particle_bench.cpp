@@ -0,0 +1,111 @@
+#include "../include/particles.h"
+#include "../include/block_registry.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Particle benchmark: average ParticleSystem::Update time with the pool held at a
+// fixed population of block-break debris over the test terrain, with and without
+// the world collision pass, and the time to spawn the whole population and update
+// it once.
+//
+// See the "build particle bench" task. Run from the workspace folder so
+// assets/data/blocks.json is found.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        int particles = 50000;
+        int frames = 600;
+        int world = 16;
+    };
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --particles N   live particles each frame (50000)\n"
+                  << "  --frames N      updates per measurement (600)\n"
+                  << "  --world N       world size in chunks, N x N (16)" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (name == "--particles") options.particles = atoi(value.c_str());
+            else if (name == "--frames") options.frames = atoi(value.c_str());
+            else if (name == "--world") options.world = atoi(value.c_str());
+            else return false;
+        }
+        return options.particles > 0 && options.frames > 0 && options.world > 0;
+    }
+
+    // Tops the pool back up with debris from blocks just above the terrain
+    void Refill(ParticleSystem& particles, int target, int span, uint32_t& state) {
+        while (particles.GetCount() + ParticleSystem::BLOCK_BREAK_PARTICLES <= target) {
+            state = state * 1664525u + 1013904223u;
+            int x = (int)((state >> 8) % (uint32_t)span);
+            int z = (int)((state >> 20) % (uint32_t)span);
+            particles.SpawnBlockBreak(x, 8 + (int)(state & 7), z, VOXEL_STONE, nullptr);
+        }
+    }
+
+    double MeasureUpdate(ParticleSystem& particles, const VoxelWorld* world, const Options& options) {
+        const float deltaTime = 1.0f / 60.0f;
+        int span = options.world * VoxelChunk::CHUNK_SIZE;
+        uint32_t state = 1;
+        double total = 0.0;
+
+        for (int frame = 0; frame < options.frames; frame++) {
+            Refill(particles, options.particles, span, state);
+            Clock::time_point start = Clock::now();
+            particles.Update(deltaTime, world);
+            total += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        return total / options.frames;
+    }
+
+    // A whole pool's worth of debris spawned and integrated in one frame
+    double MeasureBurst(ParticleSystem& particles, const VoxelWorld* world, const Options& options) {
+        int span = options.world * VoxelChunk::CHUNK_SIZE;
+        uint32_t state = 2;
+        double total = 0.0;
+
+        for (int frame = 0; frame < options.frames; frame++) {
+            particles.Update(1000.0f, nullptr);  // Expires everything
+            Clock::time_point start = Clock::now();
+            Refill(particles, options.particles, span, state);
+            particles.Update(1.0f / 60.0f, world);
+            total += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+        return total / options.frames;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    BlockRegistry::Get().LoadModels();
+    BlockRegistry::Get().LoadFromJson();
+    VoxelWorld world(options.world, options.world);
+    world.GenerateTestTerrain();
+
+    ParticleSystem particles(options.particles);
+    double freeFall = MeasureUpdate(particles, nullptr, options);
+    double colliding = MeasureUpdate(particles, &world, options);
+    double burst = MeasureBurst(particles, &world, options);
+
+    printf("%d particles, %d frames\n", particles.GetCount(), options.frames);
+    printf("  update, no world:   %.3f ms\n", freeFall);
+    printf("  update, with world: %.3f ms\n", colliding);
+    printf("  spawn all + update: %.3f ms\n", burst);
+    return 0;
+}
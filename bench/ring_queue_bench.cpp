@@ -0,0 +1,116 @@
+#include "../include/ring_queue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Throughput of the ring queues against the mutex-guarded deque they replaced,
+// in millions of items per second from producer start to the last pop. The
+// consumer drains in batches, the way the main thread does. See the "build queue
+// bench" task; usage: queueBench [items per run]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const size_t CAPACITY = 1024;
+    const size_t BATCH = 256;
+
+    // The baseline: a mutex-guarded vector the consumer swaps out whole, which is what
+    // the job system's main-thread queue and the navigation results used before
+    template <typename T>
+    class MutexQueue {
+    private:
+        std::mutex mutex;
+        std::vector<T> items;
+        std::vector<T> drained;
+
+    public:
+        explicit MutexQueue(size_t) {}
+        bool TryPush(T& value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            items.push_back(value);
+            return true;
+        }
+        size_t PopBatch(std::vector<T>& out, size_t) {
+            drained.clear();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                drained.swap(items);
+            }
+            out.insert(out.end(), drained.begin(), drained.end());
+            return drained.size();
+        }
+    };
+
+    // Returns millions of items per second; the checksum keeps the work from being optimized out
+    template <typename Queue>
+    double Measure(int producers, int items) {
+        Queue queue(CAPACITY);
+        std::atomic<bool> start(false);
+        int perProducer = items / producers;
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&queue, &start, perProducer]() {
+                while (!start.load(std::memory_order_acquire)) {}
+                for (int i = 0; i < perProducer; i++) {
+                    uint64_t value = (uint64_t)i;
+                    while (!queue.TryPush(value)) std::this_thread::yield();
+                }
+            });
+        }
+
+        std::vector<uint64_t> batch;
+        batch.reserve(BATCH);
+        uint64_t checksum = 0;
+        long long received = 0;
+        long long total = (long long)perProducer * producers;
+
+        Clock::time_point begin = Clock::now();
+        start.store(true, std::memory_order_release);
+        while (received < total) {
+            batch.clear();
+            if (queue.PopBatch(batch, BATCH) == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (uint64_t value : batch) checksum += value;
+            received += (long long)batch.size();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        for (std::thread& thread : threads) thread.join();
+
+        uint64_t expected = (uint64_t)producers * ((uint64_t)perProducer * (perProducer - 1) / 2);
+        if (checksum != expected) {
+            std::cout << "checksum mismatch" << std::endl;
+            exit(1);
+        }
+        return total / seconds / 1e6;
+    }
+}
+
+int main(int argc, char** argv) {
+    int items = argc > 1 ? atoi(argv[1]) : 4000000;
+    if (items <= 0) {
+        std::cout << "Usage: " << argv[0] << " [items per run]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "items: " << items << "\n"
+              << "hardware_threads: " << std::thread::hardware_concurrency() << "\n"
+              << "spsc_mitems_per_second: " << Measure<SpscRingQueue<uint64_t>>(1, items) << "\n"
+              << "mpsc_1_producer_mitems_per_second: " << Measure<MpscRingQueue<uint64_t>>(1, items) << "\n"
+              << "mutex_1_producer_mitems_per_second: " << Measure<MutexQueue<uint64_t>>(1, items) << "\n";
+    for (int producers : {2, 4, 8}) {
+        std::cout << "mpsc_" << producers << "_producers_mitems_per_second: "
+                  << Measure<MpscRingQueue<uint64_t>>(producers, items) << "\n"
+                  << "mutex_" << producers << "_producers_mitems_per_second: "
+                  << Measure<MutexQueue<uint64_t>>(producers, items) << "\n";
+    }
+    std::cout << std::flush;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "../include/spatial_grid.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Spatial grid benchmark: rebuild and query cost per entity as the population grows
+// from 1k to 100k at a constant density, the way a bigger loaded world fills up.
+// O(n) rebuilds and constant-time queries show up as flat per-entity columns.
+//
+// Headless; see the "build spatial grid bench" task.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    const int SIZES[] = {1000, 2000, 5000, 10000, 20000, 50000, 100000};
+
+    struct Options {
+        float density = 0.25f;      // Entities per column of blocks
+        float radius = 1.0f;
+        long long work = 2000000;   // Entity operations per measurement
+    };
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --density D   entities per block column (0.25)\n"
+                  << "  --radius R    query radius in blocks (1.0)\n"
+                  << "  --work N      entities processed per measurement (2000000)" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (name == "--density") options.density = (float)atof(value.c_str());
+            else if (name == "--radius") options.radius = (float)atof(value.c_str());
+            else if (name == "--work") options.work = atoll(value.c_str());
+            else return false;
+        }
+        return options.density > 0.0f && options.radius > 0.0f && options.work > 0;
+    }
+
+    float RandomFloat(uint32_t& state) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / (float)0x1000000;
+    }
+
+    double Nanoseconds(Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    printf("%10s %10s %14s %14s %12s\n", "entities", "side", "rebuild ns/e", "query ns/e", "hits/query");
+
+    double firstRebuild = 0.0, firstQuery = 0.0;
+    double lastRebuild = 0.0, lastQuery = 0.0;
+    for (int count : SIZES) {
+        float side = sqrtf(count / options.density);
+        uint32_t state = 1;
+        std::vector<Vector3> positions(count);
+        for (Vector3& position : positions) {
+            position = {RandomFloat(state) * side, RandomFloat(state) * 16.0f, RandomFloat(state) * side};
+        }
+
+        SpatialGrid grid;
+        int rounds = (int)std::max(1LL, options.work / count);
+
+        Clock::time_point start = Clock::now();
+        for (int round = 0; round < rounds; round++) {
+            grid.Clear();
+            for (int i = 0; i < count; i++) {
+                grid.Insert(EntityId((uint32_t)i, 0), positions[i], 0.3f);
+            }
+            grid.Build();
+        }
+        double rebuild = Nanoseconds(start) / ((double)rounds * count);
+
+        std::vector<EntityId> results;
+        long long hits = 0;
+        start = Clock::now();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < count; i++) {
+                grid.QueryRadius(positions[i], options.radius, results);
+                hits += (long long)results.size();
+            }
+        }
+        double query = Nanoseconds(start) / ((double)rounds * count);
+
+        printf("%10d %10.0f %14.1f %14.1f %12.2f\n", count, side, rebuild, query,
+               hits / ((double)rounds * count));
+
+        if (firstRebuild == 0.0) {
+            firstRebuild = rebuild;
+            firstQuery = query;
+        }
+        lastRebuild = rebuild;
+        lastQuery = query;
+    }
+
+    printf("per-entity cost, %dk vs %dk: rebuild %.2fx, query %.2fx (1.00x is linear overall)\n",
+           SIZES[sizeof(SIZES) / sizeof(SIZES[0]) - 1] / 1000, SIZES[0] / 1000,
+           lastRebuild / firstRebuild, lastQuery / firstQuery);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef BLOCK_MODEL_H
+#define BLOCK_MODEL_H
+
+#include "raylib.h"
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// How much of a block face a model covers, as seen by the neighbor on that side
+enum FaceOcclusion : uint8_t {
+    OCCLUSION_NONE = 0,
+    OCCLUSION_PARTIAL,
+    OCCLUSION_FULL
+};
+
+// Reserved face shape ids; every other shape is a distinct partial coverage
+const int SHAPE_NONE = 0;
+const int SHAPE_FULL = 1;
+
+// Model 0 is the full cube, meshed by the greedy mesher
+const int MODEL_CUBE = 0;
+
+// One precompiled quad in block-local space (voxel centered, [-0.5, 0.5])
+struct ModelQuad {
+    Vector3 corners[4];  // Same winding as VoxelChunk::AddFaceToMesh
+    Vector2 uvs[4];
+    Vector3 normal;
+    int8_t cullFace;     // Hidden when the neighbor on that side covers it; -1 if always drawn
+    uint8_t textureFace; // Which of the block's per-face textures it samples
+};
+
+struct BlockModel {
+    std::string name;
+    std::vector<ModelQuad> quads;
+    uint8_t occlusion[6];    // FaceOcclusion per FaceDirection
+    uint16_t faceShape[6];   // Interned coverage of each face
+};
+
+// Block models loaded from models.json. Models are made of axis-aligned boxes in
+// 1/16 block units (or a crossed pair of planes for plants) and are compiled once into
+// quad lists. Each face's coverage is interned as a shape id, and a shape x shape table
+// answers "does this neighbor face hide that one", so culling a model face is one lookup.
+class BlockModelLibrary {
+public:
+    using FaceMask = std::bitset<256>;  // 16x16 coverage in world-axis face coordinates
+
+private:
+    std::vector<BlockModel> models;
+    std::unordered_map<std::string, int> idsByName;
+    std::vector<FaceMask> shapes;
+    std::vector<uint8_t> coverTable;  // [coverer * shapeCount + covered]
+
+    int InternShape(const FaceMask& mask);
+    void RebuildCoverTable();
+    void AddBox(BlockModel& model, const float from[3], const float to[3], FaceMask masks[6]);
+    void AddCross(BlockModel& model);
+    int Finish(BlockModel& model, FaceMask masks[6]);
+    bool ParseModel(const std::string& modelJson);
+
+public:
+    BlockModelLibrary();
+
+    bool LoadFromJson(const std::string& jsonFilePath = "assets/data/models.json");
+
+    // Boxes in 1/16 units, e.g. a bottom slab is {0,0,0}-{16,8,16}
+    int AddBoxModel(const std::string& name, const std::vector<std::pair<Vector3, Vector3>>& boxes);
+    int AddCrossModel(const std::string& name);
+
+    int Find(const std::string& name) const;  // -1 if unknown
+    const BlockModel& GetModel(int modelId) const { return models[modelId]; }
+    int GetModelCount() const { return (int)models.size(); }
+
+    // True if a neighbor face with shape `coverer` hides a face with shape `covered`
+    bool Covers(int coverer, int covered) const { return coverTable[coverer * shapes.size() + covered] != 0; }
+};
+
+#endif // BLOCK_MODEL_H
@@ -0,0 +1,120 @@
+#ifndef BLOCK_REGISTRY_H
+#define BLOCK_REGISTRY_H
+
+#include "raylib.h"
+#include "block_model.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Upper bound on block ids, for per-type tables
+const int BLOCK_ID_LIMIT = 256;
+
+// Block data structure for JSON parsing
+struct BlockData {
+    int id;
+    std::string name;
+    std::string displayName;
+    bool transparent;
+    bool liquid;
+    bool solid;         // Blocks movement; defaults to !liquid when not given
+    std::string model;  // Name in models.json; empty for a full cube
+    bool cutout;        // Rendered in the alpha-tested foliage pass
+    bool flammable;
+    bool breakable;
+    bool emitsLight;
+    float hardness;
+    int lightLevel;
+    std::string soundGroup;
+    std::string toolRequired;
+
+    // Texture mappings
+    std::string topTexture;
+    std::string bottomTexture;
+    std::string sideTexture;
+    std::string allTexture;
+
+    // Tint color (RGBA)
+    Color tintColor;
+};
+
+// Packed per-block flags
+enum BlockFlag : uint8_t {
+    BLOCK_DEFINED = 1 << 0,
+    BLOCK_SOLID = 1 << 1,       // Blocks movement and hides neighboring faces
+    BLOCK_OPAQUE = 1 << 2,      // Nothing behind it can be seen
+    BLOCK_LIQUID = 1 << 3,
+    BLOCK_SEE_THROUGH = 1 << 4, // Drawn, but neither solid nor air (liquids, fire)
+    BLOCK_BREAKABLE = 1 << 5,
+    BLOCK_FLAMMABLE = 1 << 6,
+    BLOCK_CUTOUT = 1 << 7       // Alpha-tested foliage pass (leaves, plants)
+};
+
+// All block types, defined in blocks.json. Entries for the engine's built-in VoxelType values
+// carry those ids; blocks that only exist in data get the lowest free id, so ids stay dense.
+// The properties the mesher, physics and simulation query per voxel are kept in flat
+// tables indexed by id, so each lookup is one array load instead of a hash map probe.
+class BlockRegistry {
+public:
+    static const int FACES = 6;  // Matches FACE_COUNT
+
+    // Hot tables, indexed by block id
+    uint8_t flags[BLOCK_ID_LIMIT];
+    uint8_t lightLevel[BLOCK_ID_LIMIT];
+    float hardness[BLOCK_ID_LIMIT];
+    Color tint[BLOCK_ID_LIMIT];
+    uint16_t faceTexture[FACES][BLOCK_ID_LIMIT];  // Index into the texture name table
+    uint8_t model[BLOCK_ID_LIMIT];                // MODEL_CUBE for the greedy-meshed blocks
+    uint16_t faceShape[FACES][BLOCK_ID_LIMIT];    // Model face coverage, for neighbor culling
+
+private:
+    static BlockRegistry instance;
+
+    std::vector<BlockData> blocks;  // Cold data, indexed by id
+    BlockModelLibrary models;
+    std::unordered_map<std::string, int> idsByName;
+    std::vector<std::string> textureNames;
+    std::unordered_map<std::string, int> textureIds;
+    int idLimit;  // Highest defined id + 1
+
+    BlockRegistry();
+    int InternTexture(const std::string& name);
+    void RegisterFallback();
+    static BlockData ParseBlockJson(const std::string& blockJson);
+    void UpdateTables(int id);
+
+public:
+    static BlockRegistry& Get() { return instance; }
+
+    // Registers every block in blocks.json; needs no window, so a headless server can use it.
+    // Until then (or if the file is missing) only air and stone are defined.
+    bool LoadFromJson(const std::string& jsonFilePath = "assets/data/blocks.json");
+    
+    // Loads models.json and re-resolves the model of every registered block
+    bool LoadModels(const std::string& jsonFilePath = "assets/data/models.json");
+    const BlockModelLibrary& GetModels() const { return models; }
+
+    // Matches an existing block by name, then by the requested id (if >= 0),
+    // otherwise assigns the lowest free id. Returns the id, or -1 if the table is full.
+    int Register(const BlockData& block);
+
+    bool IsDefined(int id) const { return id >= 0 && id < BLOCK_ID_LIMIT && (flags[id] & BLOCK_DEFINED); }
+    const BlockData* GetBlockData(int id) const { return IsDefined(id) ? &blocks[id] : nullptr; }
+    int FindBlock(const std::string& name) const;  // -1 if unknown
+    int GetIdLimit() const { return idLimit; }
+
+    int FindTexture(const std::string& name) const;  // -1 if no block uses it
+    const std::string& GetTextureName(int textureId) const { return textureNames[textureId]; }
+    int GetTextureCount() const { return (int)textureNames.size(); }
+    const std::string& GetFaceTextureName(int id, int face) const { return textureNames[faceTexture[face][id]]; }
+
+    bool HasFlag(int id, BlockFlag flag) const { return (flags[id] & flag) != 0; }
+    
+    // True if block `neighbor` hides `face` of block `self` (a pair-table lookup)
+    bool NeighborHidesFace(int self, int face, int neighbor) const {
+        return models.Covers(faceShape[face ^ 1][neighbor], faceShape[face][self]);
+    }
+};
+
+#endif // BLOCK_REGISTRY_H
@@ -0,0 +1,69 @@
+#ifndef BLOCK_TICKS_H
+#define BLOCK_TICKS_H
+
+#include "voxel.h"
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+// Scheduled block updates ("update this cell at tick T") for gravity blocks, fluids and growth.
+// Every chunk owns a bucketed timing wheel: scheduling and popping are O(1), and a chunk with
+// nothing due costs one empty-bucket check per tick. Delays past the wheel horizon wait in a
+// per-chunk overflow list until they come into range.
+class BlockTickScheduler {
+public:
+    static const int WHEEL_SIZE = 64;  // Ticks covered by the wheel
+
+    // Default delays in ticks
+    static const int SAND_FALL_DELAY = 2;
+
+private:
+    struct OverflowEntry {
+        uint64_t tick;
+        uint16_t cell;
+    };
+
+    struct ChunkTicks {
+        std::vector<uint16_t> buckets[WHEEL_SIZE];
+        std::vector<OverflowEntry> overflow;
+        std::bitset<VoxelChunk::CHUNK_VOLUME> scheduled;  // Dedup: a cell is queued at most once
+        int pendingCount;
+
+        ChunkTicks() : pendingCount(0) {}
+    };
+
+    VoxelWorld* world;
+    std::vector<ChunkTicks> chunkTicks;  // Indexed chunkX * depth + chunkZ
+    uint64_t currentTick;
+    int listenerId;
+    int processedLastTick;
+
+    ChunkTicks* GetChunkTicks(int chunkX, int chunkZ);
+    void PromoteOverflow(ChunkTicks& ticks);
+    void ProcessCell(int chunkX, int chunkZ, int cell, std::vector<BlockEdit>& edits) const;
+    void OnChunkEdited(const std::vector<BlockEdit>& edits);
+
+public:
+    explicit BlockTickScheduler(VoxelWorld* world);
+    ~BlockTickScheduler();
+
+    BlockTickScheduler(const BlockTickScheduler&) = delete;
+    BlockTickScheduler& operator=(const BlockTickScheduler&) = delete;
+
+    // Queue a cell to be updated delay ticks from now. Repeated schedules for a
+    // cell that is already queued are dropped.
+    void Schedule(int worldX, int worldY, int worldZ, int delay);
+
+    // Whether a block type reacts to scheduled updates
+    static bool IsScheduledType(VoxelType type);
+    static int GetDelayForType(VoxelType type);
+
+    // Runs every update due this tick. Chunks are processed in parallel and all
+    // resulting edits go through VoxelWorld::ApplyEdits as one batch.
+    void Tick();
+
+    uint64_t GetCurrentTick() const { return currentTick; }
+    int GetProcessedLastTick() const { return processedLastTick; }
+};
+
+#endif // BLOCK_TICKS_H
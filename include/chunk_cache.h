@@ -0,0 +1,56 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include "voxel.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A client's on-disk store of chunks it has received, so a server can answer
+// "your copy is current" instead of resending unchanged chunks.
+//
+// Chunk contents are stored content-addressed, one ChunkCodec encoding per file
+// named after its ChunkCodec::Hash; identical chunks (all air, all stone) share a
+// file. An index records which hash the client last had at each chunk position;
+// those are the hashes it advertises when joining. One directory per server,
+// since positions mean nothing across worlds.
+class ChunkCache {
+public:
+    static const uint32_t INDEX_MAGIC = 0x49434352;  // "RCCI"
+    static const uint32_t INDEX_VERSION = 1;
+
+private:
+    std::string directory;
+    std::map<std::pair<int, int>, uint64_t> entries;  // (chunkX, chunkZ) -> hash
+    std::map<uint64_t, int> references;                // hash -> index entries using it
+    bool indexDirty;
+
+    std::string GetChunkPath(uint64_t hash) const;
+    void Release(uint64_t hash);  // Deletes the file once nothing refers to it
+
+public:
+    ChunkCache() : indexDirty(false) {}
+    ~ChunkCache() { SaveIndex(); }
+
+    ChunkCache(const ChunkCache&) = delete;
+    ChunkCache& operator=(const ChunkCache&) = delete;
+
+    // Creates the directory if needed and reads its index. False if it can't be used.
+    bool Open(const std::string& directory);
+    bool IsOpen() const { return !directory.empty(); }
+
+    // Records cells as the contents of (chunkX, chunkZ), writing them if no file
+    // with their hash exists yet. Returns the hash.
+    uint64_t Store(int chunkX, int chunkZ, const Voxel* cells);
+
+    // The cached contents of (chunkX, chunkZ). False (and the entry is forgotten)
+    // if there is none or the file is missing or doesn't match its hash.
+    bool Load(int chunkX, int chunkZ, Voxel* cells);
+
+    void SaveIndex();
+    const std::map<std::pair<int, int>, uint64_t>& GetEntries() const { return entries; }
+};
+
+#endif // CHUNK_CACHE_H
@@ -0,0 +1,49 @@
+#ifndef CHUNK_CODEC_H
+#define CHUNK_CODEC_H
+
+#include "voxel.h"
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact byte encodings of chunk contents, shared by the network protocol and
+// anything else that stores chunks as bytes.
+//
+// Full chunks are palette encoded: the distinct (type, metadata) pairs are listed
+// once and every cell refers to one of them. The indices are then stored
+// whichever way is smaller: as runs (terrain is mostly long horizontal layers),
+// or bit-packed at the palette's index width (noisy chunks). A chunk made of a
+// single block is just its palette.
+//
+// Deltas list only the changed cells. A two-level bitmask is used: one bit per
+// 64-cell group, then a 64-bit mask for each group that has changes. After the
+// masks come the new values in cell order, so a lone edit costs 18 bytes.
+class ChunkCodec {
+public:
+    using CellMask = std::bitset<VoxelChunk::CHUNK_VOLUME>;
+
+    static const int GROUP_SIZE = 64;
+    static const int GROUP_COUNT = VoxelChunk::CHUNK_VOLUME / GROUP_SIZE;
+
+    // Full chunk, cells in VoxelChunk::CellIndex order. Appends to out.
+    static void Encode(const Voxel* cells, std::vector<uint8_t>& out);
+    static void Encode(const VoxelChunk& chunk, std::vector<uint8_t>& out);
+
+    // Fills CHUNK_VOLUME cells; false if the data is malformed
+    static bool Decode(const uint8_t* data, size_t size, Voxel* cells);
+
+    // 64-bit FNV-1a of the cells' (type, metadata), never 0. Identifies chunk
+    // contents independent of how they were encoded.
+    static uint64_t Hash(const Voxel* cells);
+    static uint64_t Hash(const VoxelChunk& chunk);
+
+    // Changed cells with their current values in chunk. Appends to out.
+    static void EncodeDelta(const VoxelChunk& chunk, const CellMask& changed, std::vector<uint8_t>& out);
+    static size_t GetDeltaSize(const CellMask& changed);
+
+    // Appends (cell index, new value) pairs. Returns the bytes consumed, or 0 if malformed.
+    static size_t DecodeDelta(const uint8_t* data, size_t size, std::vector<std::pair<int, Voxel>>& changes);
+};
+
+#endif // CHUNK_CODEC_H
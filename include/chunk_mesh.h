@@ -0,0 +1,42 @@
+#ifndef CHUNK_MESH_H
+#define CHUNK_MESH_H
+
+#include "raylib.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+class TextureManager;
+
+// Material mesh data for multi-material chunks
+struct MaterialMesh {
+    Mesh mesh;
+    Material material;
+    std::string textureName;
+    bool isGenerated;  // Uploaded to the GPU
+
+    MaterialMesh() : mesh({0}), material({0}), isGenerated(false) {}
+};
+
+// A chunk's meshes, one per texture for the solid pass and one per texture for the
+// cutout foliage pass. Built on the CPU, possibly on a worker thread, then uploaded
+// on the main thread; the destructor frees them from whichever side they are on.
+//
+// Everything that touches the GPU lives in chunk_mesh.cpp. Chunks hold these through
+// a shared_ptr, whose deleter is bound where the meshes are created, so voxel.cpp -
+// and with it a headless server - can drop them without linking any of it.
+struct ChunkMeshes {
+    std::unordered_map<std::string, MaterialMesh> solid;
+    std::unordered_map<std::string, MaterialMesh> foliage;  // Cutout pass (leaves, plants)
+
+    ChunkMeshes() {}
+    ~ChunkMeshes();
+    ChunkMeshes(const ChunkMeshes&) = delete;
+    ChunkMeshes& operator=(const ChunkMeshes&) = delete;
+
+    // Main thread only
+    void Upload(const TextureManager* textureManager);
+    size_t GetVertexCount() const;
+};
+
+#endif // CHUNK_MESH_H
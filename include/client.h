@@ -0,0 +1,88 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include "voxel.h"
+#include "network.h"
+#include "chunk_cache.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The player's side of a GameServer connection. Keeps a copy of the world built
+// from the chunks the server sends and applies its per-tick chunk updates;
+// everything the player does goes to the server as a request. The world copy is
+// what the game renders, collides entities against and navigates on.
+//
+// With a chunk cache, chunks leaving view and everything held at disconnect are
+// saved to disk, and their hashes are listed when joining so the server can skip
+// resending the ones that haven't changed.
+//
+// Under memory pressure chunks can be swapped out while the server still sends
+// them: they go to the cache (if any) and come back from it, or are requested
+// again from the server. Updates for a swapped-out chunk bring it back first.
+class GameClient {
+public:
+    // Effects only; the destroyed blocks arrive as ordinary block updates.
+    // destroyed holds the blocks' former types.
+    using ExplosionListener = std::function<void(Vector3 center, const std::vector<BlockEdit>& destroyed)>;
+
+private:
+    std::unique_ptr<Connection> connection;
+    std::unique_ptr<VoxelWorld> world;  // Created on WELCOME, once the size is known
+    TextureManager* textureManager;
+    ExplosionListener explosionListener;
+    int clientId;
+    std::string disconnectReason;
+
+    std::unique_ptr<ChunkCache> chunkCache;
+    std::vector<uint8_t> receivedChunks;  // Per chunk: holds server contents worth caching
+    std::vector<uint8_t> swappedChunks;   // Per chunk: unloaded to save memory, still subscribed
+    uint64_t cachedChunksLoaded;
+
+    void HandlePacket(const std::vector<uint8_t>& packet);
+    void HandleChunkData(PacketReader& reader);
+    void HandleChunkUpdates(PacketReader& reader);
+    void HandleExplosion(PacketReader& reader);
+    void HandleChunkUnload(PacketReader& reader);
+    void HandleChunkCached(PacketReader& reader);
+    void ReplaceChunk(int chunkX, int chunkZ, const Voxel* cells);
+    void StoreChunk(int chunkX, int chunkZ);
+    void SaveChunkCache();
+
+public:
+    // textureManager may be null for clients that never render (bots)
+    explicit GameClient(TextureManager* textureManager = nullptr);
+    ~GameClient();
+
+    // Before Connect; one directory per server. False if the directory can't be used.
+    bool EnableChunkCache(const std::string& directory);
+
+    // The server sends the chunks within viewDistance of position (0 = its default)
+    void Connect(std::unique_ptr<Connection> connection, const std::string& playerName,
+                 Vector3 position = {0.0f, 0.0f, 0.0f}, int viewDistance = 0);
+    void Disconnect();
+
+    // Applies everything the server has sent since the last call
+    void Poll();
+
+    // Memory pressure; see MemoryBudget. False if the chunk wasn't swapped.
+    bool SwapOutChunk(int chunkX, int chunkZ);
+    bool SwapInChunk(int chunkX, int chunkZ);
+
+    // Requests to the server
+    void SendPosition(Vector3 position);
+    void RequestSetBlock(int x, int y, int z, VoxelType type);
+    void RequestExplosion(Vector3 center, float power);
+
+    void SetExplosionListener(ExplosionListener listener) { explosionListener = std::move(listener); }
+
+    VoxelWorld* GetWorld() { return world.get(); }
+    const Connection* GetConnection() const { return connection.get(); }
+    bool IsConnected() const { return connection && connection->IsOpen(); }
+    int GetClientId() const { return clientId; }
+    const std::string& GetDisconnectReason() const { return disconnectReason; }
+    uint64_t GetCachedChunksLoaded() const { return cachedChunksLoaded; }
+};
+
+#endif // CLIENT_H
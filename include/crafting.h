@@ -0,0 +1,95 @@
+#ifndef CRAFTING_H
+#define CRAFTING_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Item 0 is the empty slot (matches VOXEL_AIR)
+const int ITEM_NONE = 0;
+
+struct Recipe {
+    std::string name;
+    bool shaped;
+    int width, height;            // Trimmed pattern size; shapeless recipes are 1 row
+    std::vector<int> ingredients; // Row-major pattern, or the sorted ingredient list if shapeless
+    int resultItem;
+    int resultCount;
+};
+
+// Contents of a crafting grid (2x2 or 3x3), row-major
+struct CraftingGrid {
+    int width, height;
+    std::vector<int> items;
+
+    CraftingGrid(int w, int h) : width(w), height(h), items(w * h, ITEM_NONE) {}
+    int Get(int x, int y) const { return items[y * width + x]; }
+    void Set(int x, int y, int item) { items[y * width + x] = item; }
+};
+
+// All crafting recipes, indexed by canonical key.
+// Shaped patterns are trimmed to their bounding box and stored together with their
+// mirror image; shapeless recipes are keyed by their sorted ingredient list. Matching
+// a grid builds the same keys from the grid, so it's a hash lookup, not a scan.
+class RecipeBook {
+public:
+    // Maps an item name from recipes.json to an item id, or -1 if unknown
+    using ItemResolver = std::function<int(const std::string& name)>;
+
+private:
+    std::vector<Recipe> recipes;
+    std::unordered_map<std::string, int> index;  // Canonical key -> recipe
+
+    static std::string ShapedKey(int width, int height, const int* items, bool mirrored);
+    static std::string ShapelessKey(std::vector<int> items);
+    static bool TrimPattern(int width, int height, const std::vector<int>& items,
+                            int& outWidth, int& outHeight, std::vector<int>& outItems);
+
+    bool ParseRecipe(const std::string& recipeJson, const ItemResolver& resolve);
+
+public:
+    bool LoadFromJson(const ItemResolver& resolve, const std::string& jsonFilePath = "assets/data/recipes.json");
+
+    // Takes a pattern as laid out by the author; empty slots are ITEM_NONE.
+    // Returns the recipe index, or -1 if an identical pattern is already registered.
+    int AddShaped(const std::string& name, int width, int height, const std::vector<int>& pattern,
+                  int resultItem, int resultCount);
+    int AddShapeless(const std::string& name, const std::vector<int>& ingredients, int resultItem, int resultCount);
+
+    // Returns the matching recipe index or -1
+    int Match(const CraftingGrid& grid) const;
+
+    const Recipe& GetRecipe(int recipeIndex) const { return recipes[recipeIndex]; }
+    int GetRecipeCount() const { return (int)recipes.size(); }
+};
+
+// Which recipes can be crafted from the current item counts (for the recipe book UI).
+// An inverted index from ingredient to recipes means a count change only re-evaluates
+// the recipes that use that item, instead of rescanning the whole book.
+class CraftableSet {
+private:
+    const RecipeBook* book;
+    std::vector<std::vector<std::pair<int, int>>> requirements;  // Recipe -> (item, count needed)
+    std::unordered_map<int, std::vector<int>> recipesByItem;
+    std::unordered_map<int, int> itemCounts;
+
+    std::vector<int> craftableList;
+    std::vector<int> listPosition;  // Recipe -> slot in craftableList, -1 if not craftable
+    int evaluationsLastChange;
+
+    bool Evaluate(int recipeIndex) const;
+    void SetCraftable(int recipeIndex, bool craftable);
+
+public:
+    explicit CraftableSet(const RecipeBook* book);
+
+    void SetItemCount(int item, int count);
+    int GetItemCount(int item) const;
+
+    bool IsCraftable(int recipeIndex) const { return listPosition[recipeIndex] >= 0; }
+    const std::vector<int>& GetCraftable() const { return craftableList; }  // Unordered
+    int GetEvaluationsLastChange() const { return evaluationsLastChange; }
+};
+
+#endif // CRAFTING_H
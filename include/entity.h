@@ -0,0 +1,181 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include "raylib.h"
+#include "raymath.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Forward declarations
+class VoxelWorld;
+struct BlockEdit;
+class SpatialGrid;
+
+// Item to spawn through EntityWorld::SpawnItems
+struct ItemDrop {
+    Vector3 position;
+    Vector3 velocity;
+    int itemType;
+    int itemCount;
+};
+
+// Component bits - an archetype is the set of components an entity carries
+enum EntityComponent : uint32_t {
+    COMPONENT_POSITION   = 1u << 0,
+    COMPONENT_VELOCITY   = 1u << 1,
+    COMPONENT_LIFETIME   = 1u << 2,
+    COMPONENT_ITEM       = 1u << 3,
+    COMPONENT_MOB        = 1u << 4,
+    COMPONENT_PROJECTILE = 1u << 5
+};
+
+// Common archetypes
+const uint32_t ARCHETYPE_MOB = COMPONENT_POSITION | COMPONENT_VELOCITY | COMPONENT_MOB;
+const uint32_t ARCHETYPE_ITEM = COMPONENT_POSITION | COMPONENT_VELOCITY | COMPONENT_LIFETIME | COMPONENT_ITEM;
+const uint32_t ARCHETYPE_PROJECTILE = COMPONENT_POSITION | COMPONENT_VELOCITY | COMPONENT_LIFETIME | COMPONENT_PROJECTILE;
+
+// Generational handle - stale handles are detected instead of aliasing new entities
+struct EntityId {
+    uint32_t index;
+    uint32_t generation;
+
+    EntityId() : index(0xFFFFFFFFu), generation(0) {}
+    EntityId(uint32_t i, uint32_t g) : index(i), generation(g) {}
+
+    bool IsValid() const { return index != 0xFFFFFFFFu; }
+    bool operator==(const EntityId& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityId& other) const { return !(*this == other); }
+};
+
+// Fixed-capacity block of entities sharing one archetype.
+// Components are stored as structure-of-arrays so systems walk contiguous memory.
+// Arrays for components the archetype doesn't have are left empty.
+struct EntityChunk {
+    static const int CAPACITY = 1024;
+
+    uint32_t componentMask;
+    int count;
+
+    std::vector<uint32_t> entityIndex;  // Row -> entity table slot
+
+    // COMPONENT_POSITION
+    std::vector<float> posX, posY, posZ;
+    // COMPONENT_VELOCITY
+    std::vector<float> velX, velY, velZ;
+    std::vector<uint8_t> onGround;
+    // COMPONENT_LIFETIME
+    std::vector<float> lifetime;
+    // COMPONENT_ITEM
+    std::vector<int> itemType, itemCount;
+    std::vector<uint8_t> sleeping;      // Resting items skip physics until a nearby block changes
+    std::vector<uint8_t> filed;         // Sleeping and held by EntityWorld's sleeper grid
+    std::vector<float> restTime;
+    // COMPONENT_MOB
+    std::vector<float> wanderTimer, heading;
+    std::vector<uint32_t> rngState;
+    // COMPONENT_PROJECTILE
+    std::vector<float> damage;
+
+    // Rows flagged for removal by systems running in parallel; applied serially afterwards
+    std::vector<int> pendingDestroy;
+    // Item rows that went to sleep this update, checked for stack merging afterwards
+    std::vector<int> fellAsleep;
+
+    explicit EntityChunk(uint32_t mask);
+
+    bool Has(uint32_t components) const { return (componentMask & components) == components; }
+    bool IsFull() const { return count >= CAPACITY; }
+};
+
+struct Archetype {
+    uint32_t componentMask;
+    std::vector<std::unique_ptr<EntityChunk>> chunks;
+    int entityCount;
+
+    explicit Archetype(uint32_t mask) : componentMask(mask), entityCount(0) {}
+};
+
+// Archetype-based entity storage for mobs, dropped items and projectiles
+class EntityWorld {
+private:
+    struct EntityRecord {
+        uint32_t generation;
+        int archetype;
+        int chunk;
+        int row;
+        bool alive;
+
+        EntityRecord() : generation(0), archetype(-1), chunk(-1), row(-1), alive(false) {}
+    };
+
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> freeIndices;
+    int aliveCount;
+
+    // Broadphase, rebuilt once per update. Sleeping items are filed in a second grid
+    // that is only refiled once keeping it as it is gets more expensive, so resting
+    // items don't cost a reinsert every tick.
+    std::unique_ptr<SpatialGrid> grid;
+    std::unique_ptr<SpatialGrid> sleeperGrid;
+    int staleSleepers;      // Sleeper grid entries that have since woken or been destroyed
+    int unfiledSleepers;    // Sleeping items still going through the per-update grid
+    int unfiledInserts;     // Their per-update inserts since the last refile
+
+    int FindOrCreateArchetype(uint32_t mask);
+    EntityId CreateEntity(uint32_t mask, int& outArchetype, EntityChunk*& outChunk, int& outRow);
+    void CopyRow(EntityChunk& dst, int dstRow, const EntityChunk& src, int srcRow);
+    void FlushPendingDestroys();
+    EntityChunk* GetChunkForEntity(EntityId id, int& row) const;
+    void DropStaleSleepers(std::vector<EntityId>& results, size_t first) const;
+
+    // Systems
+    void RebuildSpatialGrid();
+    void RebuildSleeperGrid();
+    void UpdateMobs(float deltaTime);
+    void UpdatePhysics(float deltaTime, const VoxelWorld* world);
+    void UpdateItem(EntityChunk& chunk, int row, float deltaTime, const VoxelWorld* world);
+    void MergeItemStacks();
+    void UpdateLifetimes(float deltaTime);
+
+public:
+    EntityWorld();
+    ~EntityWorld();
+
+    // Spawning
+    EntityId SpawnMob(Vector3 position);
+    EntityId SpawnItem(Vector3 position, Vector3 velocity, int itemType, int itemCount, float lifetime = 300.0f);
+    EntityId SpawnProjectile(Vector3 position, Vector3 velocity, float damage, float lifetime = 10.0f);
+    void SpawnItems(const std::vector<ItemDrop>& drops, float lifetime = 300.0f);
+    
+    // Wakes sleeping items around edited cells; hook up to VoxelWorld::AddEditListener
+    void WakeItemsNear(const std::vector<BlockEdit>& edits);
+    void Destroy(EntityId id);
+
+    // Points a mob along heading (radians, from +X towards +Z) for the next holdSeconds,
+    // after which it goes back to wandering
+    void SteerMob(EntityId id, float heading, float holdSeconds);
+
+    // Access
+    bool IsAlive(EntityId id) const;
+    Vector3 GetPosition(EntityId id) const;
+    int GetEntityCount() const { return aliveCount; }
+
+    // Runs fn on every chunk whose archetype contains the required components.
+    // Chunks are distributed across the job system, so fn must only touch its own chunk.
+    void ForEachChunk(uint32_t requiredComponents, const std::function<void(EntityChunk&)>& fn);
+
+    // Neighbor queries against the last rebuilt spatial grids, sleeping items included
+    void QueryRadius(Vector3 center, float radius, std::vector<EntityId>& results) const;
+    void QueryAABB(BoundingBox box, std::vector<EntityId>& results) const;
+    const SpatialGrid& GetSpatialGrid() const { return *grid; }  // Entities not filed as sleepers
+    static float GetRadiusForArchetype(uint32_t componentMask);
+
+    // Simulation and rendering
+    void Update(float deltaTime, const VoxelWorld* world);
+    void Draw() const;
+};
+
+#endif // ENTITY_H
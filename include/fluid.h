@@ -0,0 +1,59 @@
+#ifndef FLUID_H
+#define FLUID_H
+
+#include "voxel.h"
+#include <bitset>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Cellular water simulation.
+// Water level lives in Voxel::metadata: 0 is a source block, 1..WATER_MAX_LEVEL is flowing
+// water that gets weaker with distance. Only cells in a chunk's active set are simulated,
+// so settled water costs nothing until an edit next to it wakes it up again.
+class FluidSimulator {
+public:
+    static const uint8_t WATER_SOURCE_LEVEL = 0;
+    static const uint8_t WATER_MAX_LEVEL = 7;
+    static const int FLOW_INTERVAL = 5;          // World ticks between fluid steps
+    static const int DEFAULT_BUDGET = 4096;      // Cell updates per fluid step
+
+private:
+    struct ChunkFluid {
+        std::deque<uint16_t> active;  // FIFO, so spilled-over cells run first next step
+        std::bitset<VoxelChunk::CHUNK_VOLUME> queued;
+    };
+
+    VoxelWorld* world;
+    std::vector<ChunkFluid> chunkFluids;  // Indexed chunkX * depth + chunkZ
+    int listenerId;
+    int budgetPerStep;
+    uint64_t tickCount;
+    int processedLastStep;
+    int nextChunk;  // Where the round-robin share of the budget's remainder starts
+
+    ChunkFluid* GetChunkFluid(int chunkX, int chunkZ);
+    void Activate(int worldX, int worldY, int worldZ);
+    void OnChunkEdited(const std::vector<BlockEdit>& edits);
+    void UpdateCell(int x, int y, int z, std::vector<BlockEdit>& edits) const;
+    void SplitBudget(std::vector<int>& quotas);
+    int RunPhase(int phase, const std::vector<int>& quotas);
+
+public:
+    explicit FluidSimulator(VoxelWorld* world, int budgetPerStep = DEFAULT_BUDGET);
+    ~FluidSimulator();
+
+    FluidSimulator(const FluidSimulator&) = delete;
+    FluidSimulator& operator=(const FluidSimulator&) = delete;
+
+    // Call once per world tick; steps the simulation every FLOW_INTERVAL ticks.
+    // Chunks run in two checkerboard phases, each phase in parallel, and at most
+    // budgetPerStep cells are updated - the rest stay active for later steps.
+    void Tick();
+
+    void SetBudget(int cellsPerStep) { budgetPerStep = cellsPerStep > 0 ? cellsPerStep : 1; }
+    int GetActiveCellCount() const;
+    int GetProcessedLastStep() const { return processedLastStep; }
+};
+
+#endif // FLUID_H
@@ -0,0 +1,61 @@
+#ifndef ICON_ATLAS_H
+#define ICON_ATLAS_H
+
+#include "raylib.h"
+#include <string>
+#include <vector>
+
+class TextureManager;
+class Inventory;
+
+// Item icons pre-rendered as isometric cubes, plus the hotbar frame and count digits,
+// packed into one texture. The atlas is rendered once from the block textures and
+// cached as a PNG; it's only rebuilt when blocks.json or a source texture is newer.
+// Because everything the hotbar draws comes from this one texture, raylib batches the
+// whole hotbar into a single draw call regardless of how many slots are filled.
+class IconAtlas {
+public:
+    static const int ICON_SIZE = 32;
+    static const int ICON_COLUMNS = 16;
+    static const int MAX_ICONS = 256;    // One per block id
+    static const int ATLAS_WIDTH = ICON_SIZE * ICON_COLUMNS;
+
+    // UI strip below the icons
+    static const int HOTBAR_WIDTH = 182;
+    static const int HOTBAR_HEIGHT = 22;
+    static const int SELECTION_SIZE = 24;
+    static const int DIGIT_WIDTH = 6;
+    static const int DIGIT_HEIGHT = 10;
+
+private:
+    Texture2D texture;
+    std::vector<bool> hasIcon;  // Block id -> icon was rendered
+    int uiRow;                  // Y of the UI strip
+
+    Rectangle IconRect(int itemId) const;
+    Rectangle HotbarRect() const { return {0, (float)uiRow, HOTBAR_WIDTH, HOTBAR_HEIGHT}; }
+    Rectangle SelectionRect() const { return {HOTBAR_WIDTH, (float)uiRow, SELECTION_SIZE, SELECTION_SIZE}; }
+    Rectangle DigitRect(int digit) const;
+
+    void Generate(const TextureManager* textureManager, std::vector<Color>& pixels);
+    void DrawCount(int count, float right, float bottom, float scale) const;
+
+public:
+    IconAtlas();
+    ~IconAtlas();
+
+    // Loads the cached atlas, regenerating it first if it's missing or stale.
+    // Needs a GL context (call after InitWindow).
+    bool Load(const TextureManager* textureManager,
+              const std::string& cachePath = "cache/item_icons.png",
+              const std::string& blockDataPath = "assets/data/blocks.json");
+    void Unload();
+
+    bool IsLoaded() const { return texture.id != 0; }
+    bool HasIcon(int itemId) const;
+
+    void DrawIcon(int itemId, Rectangle dest, Color tint = WHITE) const;
+    void DrawHotbar(const Inventory& inventory, int centerX, int y, int selectedSlot) const;
+};
+
+#endif // ICON_ATLAS_H
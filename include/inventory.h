@@ -0,0 +1,59 @@
+#ifndef INVENTORY_H
+#define INVENTORY_H
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+struct ItemStack {
+    int itemId;       // Block ids double as item ids; 0 is empty
+    int count;
+    uint8_t metadata;
+
+    ItemStack() : itemId(0), count(0), metadata(0) {}
+    ItemStack(int id, int n, uint8_t meta = 0) : itemId(id), count(n), metadata(meta) {}
+
+    bool IsEmpty() const { return itemId == 0 || count <= 0; }
+};
+
+// Player inventory. The first HOTBAR_SLOTS slots are the hotbar.
+// Per-item totals are kept up to date so consumers (the craftable set) can be
+// notified of just the items that changed.
+class Inventory {
+public:
+    static const int HOTBAR_SLOTS = 9;
+    static const int SLOT_COUNT = 36;
+    static const int MAX_STACK = 64;
+
+    // Called with the item and its new total whenever a total changes
+    using ChangeListener = std::function<void(int itemId, int total)>;
+
+private:
+    std::vector<ItemStack> slots;
+    std::unordered_map<int, int> totals;
+    ChangeListener changeListener;
+    int selectedSlot;
+
+    void AdjustTotal(int itemId, int delta);
+
+public:
+    Inventory();
+
+    // Returns how many items didn't fit
+    int Add(int itemId, int count, uint8_t metadata = 0);
+    // Returns how many items were actually removed
+    int Remove(int itemId, int count);
+
+    const ItemStack& GetSlot(int slot) const { return slots[slot]; }
+    void SetSlot(int slot, const ItemStack& stack);
+    int GetTotal(int itemId) const;
+
+    int GetSelectedSlot() const { return selectedSlot; }
+    void SetSelectedSlot(int slot) { selectedSlot = slot; }
+    const ItemStack& GetSelectedStack() const { return slots[selectedSlot]; }
+
+    void SetChangeListener(ChangeListener listener) { changeListener = std::move(listener); }
+};
+
+#endif // INVENTORY_H
@@ -0,0 +1,136 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ring_queue.h"
+
+// Higher runs first. Jobs someone is blocked on (ParallelFor, Wait) should be HIGH;
+// background work that may take frames (pathfinding, I/O) LOW.
+enum JobPriority {
+    JOB_HIGH = 0,
+    JOB_NORMAL,
+    JOB_LOW,
+    JOB_PRIORITY_COUNT
+};
+
+class JobSystem;
+
+// Counts unfinished jobs. Pipelines use it as a dependency: main-thread jobs
+// submitted with SubmitMainThreadAfter start once it reaches zero, and Wait blocks
+// on it (helping out meanwhile). Must outlive the jobs counted on it and any
+// SubmitMainThreadAfter on it.
+class JobCounter {
+private:
+    friend class JobSystem;
+
+    struct Continuation {
+        std::function<void()> job;
+        JobCounter* counter;
+    };
+
+    std::atomic<int> pending;
+    mutable std::mutex mutex;                 // Guards continuations and the final decrement
+    std::vector<Continuation> continuations;  // Queued for the main thread when pending reaches zero
+
+public:
+    JobCounter() : pending(0) {}
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const;
+};
+
+// Shared worker pool for engine subsystems that want to go parallel.
+// Subsystems should use JobSystem::Get() instead of spawning their own threads.
+//
+// Each worker has its own deque per priority. Jobs submitted from a worker go on
+// its own deque and it takes them newest first, which keeps a job's children in
+// cache; idle workers steal the oldest jobs from the others. Jobs from other
+// threads are dealt round-robin to the workers. Deques have their own small lock,
+// so workers only contend when stealing.
+//
+// Main-thread jobs (GPU uploads and anything else that must run on the thread
+// that owns the window) go through a lock-free queue and are run by
+// RunMainThreadJobs, which the game calls once per frame.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+private:
+    struct Task {
+        Job job;
+        JobCounter* counter = nullptr;  // Released when the job finishes, may be null
+    };
+
+    static const size_t MAIN_THREAD_QUEUE_CAPACITY = 4096;
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks[JOB_PRIORITY_COUNT];  // Owner takes the back, thieves the front
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;  // One per worker
+    std::atomic<int> queuedTasks;                      // Across all worker queues
+    std::atomic<unsigned> nextQueue;                   // Round-robin target for outside submissions
+
+    std::mutex sleepMutex;
+    std::condition_variable workAvailable;
+    std::atomic<int> sleepingWorkers;
+    bool shuttingDown;
+
+    std::thread::id mainThreadId;
+    MpscRingQueue<Task> mainThreadTasks;
+
+    void WorkerLoop(int workerIndex);
+    void Enqueue(Task task, JobPriority priority);
+    void EnqueueMainThread(Task task);
+    bool TryTakeTask(Task& task, JobPriority lowestPriority = JOB_LOW);
+    void Run(Task& task);
+    void Release(JobCounter* counter);
+
+public:
+    // workerCount <= 0 uses hardware concurrency - 1 (the calling thread also helps).
+    // The constructing thread is the main thread.
+    explicit JobSystem(int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Engine-wide instance; call it first from the main thread
+    static JobSystem& Get();
+
+    // Fire-and-forget job, counted on counter if given
+    void Submit(Job job, JobPriority priority = JOB_NORMAL, JobCounter* counter = nullptr);
+
+    // Queues job for the main thread once dependency reaches zero (at once if it
+    // already has); the next RunMainThreadJobs, or a Wait on the main thread, runs it.
+    // counter counts it from now, so waiting on counter covers the whole chain.
+    void SubmitMainThreadAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+
+    // Runs the main-thread jobs queued so far (not ones they queue); returns how many.
+    // Main thread only.
+    int RunMainThreadJobs();
+
+    // Runs other jobs of at least helpWith priority until counter reaches zero. On the
+    // main thread this includes main-thread jobs, so waiting on them there can't deadlock.
+    void Wait(JobCounter& counter, JobPriority helpWith = JOB_LOW);
+
+    // Splits [0, count) into batches and runs fn(begin, end) on the workers.
+    // The calling thread participates and returns once every batch is done.
+    void ParallelFor(int count, int batchSize, const std::function<void(int begin, int end)>& fn);
+
+    int GetWorkerCount() const { return (int)workers.size(); }
+    bool IsMainThread() const { return std::this_thread::get_id() == mainThreadId; }
+};
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,87 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include "voxel.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Keeps a world's chunk storage and meshes within RAM and VRAM budgets. Each
+// update totals what the chunks hold and, while over budget, sheds in steps,
+// coldest chunks first (least recently drawn, then farthest away):
+//   1. meshes not drawn in the last RECENTLY_VISIBLE_FRAMES: the chunk stops
+//      drawing but keeps its voxels
+//   2. voxel data: compressed in memory, decompressed again by the next read
+//   3. meshes drawn recently, except those drawn in the latest frame
+//   4. whole chunks not drawn in the latest frame: saved and unloaded through
+//      the swap handlers, if set
+// "Drawn" relies on VoxelWorld::Draw(viewPosition) culling to the camera, so
+// chunks behind the player go first.
+// Once usage is below RESTORE_FRACTION of both budgets, the nearest shed chunks
+// come back a few per update, so a world right at its budget doesn't flip back
+// and forth.
+//
+// Main thread only, after VoxelWorld::Update. Chunks held by a ChunkHandle are
+// left alone.
+class MemoryBudget {
+public:
+    static const size_t DEFAULT_RAM_BUDGET = (size_t)256 << 20;
+    static const size_t DEFAULT_VRAM_BUDGET = (size_t)128 << 20;
+    static constexpr float RESTORE_FRACTION = 0.8f;
+    static const int MAX_RESTORES_PER_UPDATE = 4;
+    static const uint32_t RECENTLY_VISIBLE_FRAMES = 120;
+
+    // Swap out saves and unloads a chunk, swap in brings it back. Both return
+    // false if they didn't act on the chunk.
+    using SwapHandler = std::function<bool(int chunkX, int chunkZ)>;
+
+    struct Stats {
+        size_t voxelBytes = 0;  // Resident and compressed voxel storage
+        size_t meshBytes = 0;   // Counted against both budgets
+        uint64_t meshesEvicted = 0;
+        uint64_t chunksCompressed = 0;
+        uint64_t chunksSwappedOut = 0;
+        uint64_t chunksRestored = 0;
+    };
+
+private:
+    struct Candidate {
+        int chunkX, chunkZ;
+        uint32_t lastVisible;
+        float distance;
+    };
+
+    VoxelWorld* world;
+    size_t ramBudget;
+    size_t vramBudget;
+    SwapHandler swapOut;
+    SwapHandler swapIn;
+    std::vector<uint8_t> swappedOut;  // Per chunk: unloaded by us, swapIn brings it back
+    Stats stats;
+
+    void Measure();
+    bool IsOverBudget() const { return GetRamUsage() > ramBudget || GetVramUsage() > vramBudget; }
+    float DistanceTo(int chunkX, int chunkZ, Vector3 viewPosition) const;
+    bool DrawnWithin(const Candidate& candidate, uint32_t frames) const;
+    void EvictMeshes(const std::vector<Candidate>& candidates, uint32_t keepFrames);
+    void Shed(Vector3 viewPosition);
+    void Restore(Vector3 viewPosition);
+
+public:
+    explicit MemoryBudget(VoxelWorld* world);
+
+    void SetBudgets(size_t ramBytes, size_t vramBytes);
+    void SetSwapHandlers(SwapHandler out, SwapHandler in);
+
+    // Once per frame
+    void Update(Vector3 viewPosition);
+
+    size_t GetRamUsage() const { return stats.voxelBytes + stats.meshBytes; }
+    size_t GetVramUsage() const { return stats.meshBytes; }
+    size_t GetRamBudget() const { return ramBudget; }
+    size_t GetVramBudget() const { return vramBudget; }
+    const Stats& GetStats() const { return stats; }
+};
+
+#endif // MEMORY_BUDGET_H
@@ -0,0 +1,131 @@
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include "raylib.h"
+#include "voxel.h"
+#include "ring_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+// Hierarchical pathfinding (HPA*) over the voxel world.
+// Each chunk is a cluster: its walkable surface is derived from the solid bitmasks, and
+// the places where it connects to a neighboring chunk become portals. Portals are joined
+// by precomputed in-chunk distances, so long queries search the small portal graph and
+// only refine the chosen route back into cells. Edited chunks are rebuilt on the next
+// Update; everything else keeps its graph.
+class NavigationSystem {
+public:
+    struct PathResult {
+        int requestId;
+        bool found;
+        std::vector<Vector3> waypoints;  // Feet positions, one per cell
+    };
+
+    static const int MAX_CACHED_PATHS = 256;
+    static const int RESULT_QUEUE_CAPACITY = 256;
+
+private:
+    struct Edge {
+        int target;
+        int cost;
+    };
+
+    struct Cluster {
+        uint16_t walkable[VoxelChunk::CHUNK_HEIGHT][VoxelChunk::CHUNK_SIZE];  // Bit per cell along X
+        std::vector<uint16_t> portals;                // Local cell index of each portal
+        std::vector<int16_t> portalOfCell;            // Cell -> portal index, -1 if none
+        std::vector<std::vector<Edge>> intraEdges;    // Portal -> portals in the same cluster
+    };
+
+    // Crossing between a chunk and its +X / +Z neighbor; A is the chunk's side
+    struct BorderLink {
+        uint16_t cellA;
+        uint16_t cellB;
+    };
+
+    // Everything a query reads. Published graphs are never modified: Update builds the
+    // next one on the side, sharing the clusters that didn't change, and swaps it in.
+    struct Graph {
+        std::vector<std::shared_ptr<const Cluster>> clusters;  // Indexed chunkX * depth + chunkZ
+        std::vector<std::vector<BorderLink>> bordersX;
+        std::vector<std::vector<BorderLink>> bordersZ;
+
+        // Abstract portal graph, reassembled from the clusters after rebuilds
+        std::vector<int> nodeOffset;                   // Cluster -> first node index
+        std::vector<int> nodeCluster;
+        std::vector<uint16_t> nodeCell;
+        std::vector<std::vector<Edge>> abstractEdges;
+        uint64_t version;
+
+        Graph() : version(0) {}
+    };
+
+    VoxelWorld* world;
+    int width, depth;
+    int listenerId;
+    std::vector<uint8_t> dirtyClusters;  // Main thread only
+    std::vector<uint8_t> builtLoaded;    // Whether each cluster was last built from a loaded chunk
+
+    // Only guards swapping the pointer; queries search their own reference to the graph
+    mutable std::shared_mutex graphMutex;
+    std::shared_ptr<const Graph> graph;
+
+    // Paths keyed by (start cell, goal cell), dropped whenever the graph changes
+    mutable std::mutex cacheMutex;
+    mutable std::map<std::pair<uint64_t, uint64_t>, std::vector<Vector3>> pathCache;
+    mutable uint64_t cacheVersion;
+
+    // Asynchronous queries; workers hand results to the main thread lock-free, and
+    // results that don't fit while nobody polls wait in the overflow list instead of
+    // holding up a worker
+    MpscRingQueue<PathResult> completedResults;
+    std::mutex overflowMutex;
+    std::vector<PathResult> overflowResults;
+    std::atomic<int> nextRequestId;
+    std::atomic<int> pendingRequests;
+
+    static bool IsWalkable(const Cluster& cluster, int x, int y, int z);
+    static void BfsInCluster(const Cluster& cluster, int startCell, std::vector<uint16_t>& distance,
+                             std::vector<int>* parent);
+
+    static void RebuildWalkable(Cluster& cluster, const VoxelChunk* chunk);
+    void RebuildBorderX(Graph& next, int clusterIndex) const;
+    void RebuildBorderZ(Graph& next, int clusterIndex) const;
+    void RebuildPortals(const Graph& next, Cluster& cluster, int clusterIndex) const;
+    void RebuildAbstractGraph(Graph& next) const;
+
+    std::shared_ptr<const Graph> GetGraph() const;
+    bool CellPathInCluster(const Graph& g, int clusterIndex, int fromCell, int toCell, std::vector<Vector3>& out) const;
+    Vector3 CellToWaypoint(int clusterIndex, int cell) const;
+    bool LocateCell(const Graph& g, int x, int y, int z, int& clusterIndex, int& cell) const;
+    bool FindPathInGraph(const Graph& g, int sx, int sy, int sz, int gx, int gy, int gz, std::vector<Vector3>& out) const;
+
+public:
+    explicit NavigationSystem(VoxelWorld* world);
+    ~NavigationSystem();
+
+    NavigationSystem(const NavigationSystem&) = delete;
+    NavigationSystem& operator=(const NavigationSystem&) = delete;
+
+    // Rebuilds clusters whose chunks were edited, loaded or unloaded. Main thread only;
+    // queries running meanwhile keep searching the previous graph.
+    void Update();
+
+    // Synchronous query between feet positions; safe to call from any thread
+    bool FindPath(Vector3 from, Vector3 to, std::vector<Vector3>& waypoints) const;
+
+    // Queues a query on the job system; poll for the result on the main thread.
+    // PollResults appends whatever finished since the last call.
+    int RequestPath(Vector3 from, Vector3 to);
+    void PollResults(std::vector<PathResult>& results);
+
+    int GetNodeCount() const { return (int)GetGraph()->nodeCell.size(); }
+};
+
+#endif // NAVIGATION_H
@@ -0,0 +1,198 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include "voxel.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const uint32_t PROTOCOL_VERSION = 4;
+const int DEFAULT_SERVER_PORT = 25580;
+
+// Every packet starts with one of these. Block ids go over the wire as one byte
+// (BLOCK_ID_LIMIT is 256); both ends load the same blocks.json, so ids agree.
+enum PacketType : uint8_t {
+    // Client -> server
+    PACKET_HELLO = 1,        // u32 protocol version, string player name, f32 x, y, z, u8 view distance (0 = default),
+                             // u8 has chunk cache, u32 count, then count x (i32 chunkX, chunkZ, u64 cached ChunkCodec::Hash)
+    PACKET_PLAYER_MOVE,      // f32 x, y, z
+    PACKET_SET_BLOCK,        // i32 x, y, z, u8 type
+    PACKET_EXPLODE,          // f32 x, y, z, power
+    PACKET_REQUEST_CHUNK,    // i32 chunkX, chunkZ; the cached copy was missing or damaged, send it in full
+
+    // Server -> client
+    PACKET_WELCOME = 64,     // u32 client id, u16 world width, u16 world depth (in chunks)
+    PACKET_CHUNK_DATA,       // i32 chunkX, chunkZ, u32 length, ChunkCodec full encoding
+    PACKET_CHUNK_UPDATES,    // One per tick: u16 count, then count x (i32 chunkX, chunkZ, u8 ChunkUpdateKind, body)
+    PACKET_EXPLOSION,        // f32 x, y, z, u32 count, then count x (i32 x, y, z, u8 former type)
+    PACKET_CHUNK_UNLOAD,     // i32 chunkX, chunkZ; left the view distance, no more updates until resent
+    PACKET_CHUNK_CACHED,     // i32 chunkX, chunkZ; the client's cached copy is current, use it instead of CHUNK_DATA
+
+    PACKET_DISCONNECT = 255  // string reason
+};
+
+// Body of one PACKET_CHUNK_UPDATES entry
+enum ChunkUpdateKind : uint8_t {
+    CHUNK_UPDATE_DELTA = 0,  // ChunkCodec delta
+    CHUNK_UPDATE_FULL        // u32 length, ChunkCodec full encoding; sent when smaller than the delta
+};
+
+// Little-endian packet builder
+class PacketWriter {
+private:
+    std::vector<uint8_t> data;
+
+public:
+    explicit PacketWriter(PacketType type) { data.push_back(type); }
+
+    void WriteU8(uint8_t value) { data.push_back(value); }
+    void WriteU16(uint16_t value);
+    void WriteU32(uint32_t value);
+    void WriteI32(int32_t value) { WriteU32((uint32_t)value); }
+    void WriteU64(uint64_t value);
+    void WriteF32(float value);
+    void WriteString(const std::string& value);  // u16 length, then the bytes
+    void WriteBytes(const uint8_t* bytes, size_t count) { data.insert(data.end(), bytes, bytes + count); }
+
+    std::vector<uint8_t>& GetData() { return data; }
+    size_t GetSize() const { return data.size(); }
+};
+
+// Reads a packet written by PacketWriter. Reading past the end returns zeros and
+// clears IsValid, so handlers can read everything and check once at the end.
+class PacketReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+    bool valid;
+
+    bool Require(size_t count);
+
+public:
+    explicit PacketReader(const std::vector<uint8_t>& packet);
+
+    PacketType GetType() const { return size > 0 ? (PacketType)data[0] : PACKET_DISCONNECT; }
+
+    uint8_t ReadU8();
+    uint16_t ReadU16();
+    uint32_t ReadU32();
+    int32_t ReadI32() { return (int32_t)ReadU32(); }
+    uint64_t ReadU64();
+    float ReadF32();
+    std::string ReadString();
+    const uint8_t* ReadBytes(size_t count);  // nullptr if the packet is too short
+    const uint8_t* Peek() const { return data + position; }  // For decoders that report their own length
+
+    bool IsValid() const { return valid; }
+    size_t GetRemaining() const { return size - position; }
+};
+
+// Full chunk contents as u32 length + ChunkCodec encoding
+void WriteChunkData(PacketWriter& writer, const VoxelChunk& chunk);
+void WriteChunkData(PacketWriter& writer, const std::vector<uint8_t>& encoded);
+bool ReadChunkData(PacketReader& reader, Voxel cells[VoxelChunk::CHUNK_VOLUME]);
+
+// A reliable, ordered, message-based link to the other side. Send never blocks;
+// Poll hands over every packet that has arrived since the last call.
+class Connection {
+protected:
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+
+public:
+    Connection() : bytesSent(0), bytesReceived(0) {}
+    virtual ~Connection() = default;
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    virtual void Send(std::vector<uint8_t> packet) = 0;
+    virtual void Poll(std::vector<std::vector<uint8_t>>& packets) = 0;
+    virtual bool IsOpen() const = 0;
+    virtual void Close() = 0;
+    virtual std::string GetDescription() const = 0;
+
+    void Send(PacketWriter& writer) { Send(std::move(writer.GetData())); }
+    uint64_t GetBytesSent() const { return bytesSent; }
+    uint64_t GetBytesReceived() const { return bytesReceived; }
+};
+
+// In-process transport for singleplayer: two ends sharing a pair of queues.
+// Either end may be used from its own thread.
+struct LoopbackChannel {
+    std::mutex mutex;
+    std::deque<std::vector<uint8_t>> queues[2];  // Packets waiting for end 0 and end 1
+    bool closed = false;
+};
+
+class LoopbackConnection : public Connection {
+private:
+    std::shared_ptr<LoopbackChannel> channel;
+    int side;
+
+public:
+    LoopbackConnection(std::shared_ptr<LoopbackChannel> channel, int side) : channel(std::move(channel)), side(side) {}
+    ~LoopbackConnection() override { Close(); }
+
+    // Both ends of a new channel
+    static void CreatePair(std::unique_ptr<Connection>& first, std::unique_ptr<Connection>& second);
+
+    void Send(std::vector<uint8_t> packet) override;
+    void Poll(std::vector<std::vector<uint8_t>>& packets) override;
+    bool IsOpen() const override;
+    void Close() override;
+    std::string GetDescription() const override { return "loopback"; }
+};
+
+// Non-blocking TCP stream carrying u32 length-prefixed packets. TCP rather than
+// UDP because chunk and block traffic must arrive complete and in order.
+class TcpConnection : public Connection {
+public:
+    static const uint32_t MAX_PACKET_SIZE = 16 * 1024 * 1024;
+
+private:
+    int socketFd;
+    std::string peer;
+    std::vector<uint8_t> sendBuffer;
+    size_t sendOffset;  // Bytes of sendBuffer already written
+    std::vector<uint8_t> receiveBuffer;
+
+    void Flush();
+
+public:
+    TcpConnection(int socketFd, const std::string& peer);
+    ~TcpConnection() override { Close(); }
+
+    // Blocking connect; nullptr on failure
+    static std::unique_ptr<Connection> Connect(const std::string& host, int port);
+
+    void Send(std::vector<uint8_t> packet) override;
+    void Poll(std::vector<std::vector<uint8_t>>& packets) override;
+    bool IsOpen() const override { return socketFd >= 0; }
+    void Close() override;
+    std::string GetDescription() const override { return peer; }
+    size_t GetQueuedBytes() const { return sendBuffer.size() - sendOffset; }
+};
+
+class TcpListener {
+private:
+    int socketFd;
+
+public:
+    TcpListener() : socketFd(-1) {}
+    ~TcpListener() { Close(); }
+
+    TcpListener(const TcpListener&) = delete;
+    TcpListener& operator=(const TcpListener&) = delete;
+
+    bool Listen(int port);
+    std::unique_ptr<Connection> Accept();  // Non-blocking; nullptr if nobody is waiting
+    void Close();
+    bool IsListening() const { return socketFd >= 0; }
+};
+
+#endif // NETWORK_H
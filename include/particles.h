@@ -0,0 +1,62 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "raylib.h"
+#include "voxel.h"
+#include <cstdint>
+#include <vector>
+
+class TextureManager;
+
+// Fixed-capacity particle pool for block-break and footstep effects.
+// Particles are stored as structure-of-arrays and kept dense by swap-removal, so
+// integration runs four particles at a time over contiguous floats and nothing is
+// allocated after construction. Spawns beyond capacity are dropped.
+class ParticleSystem {
+public:
+    static const int DEFAULT_CAPACITY = 65536;
+    static const int BLOCK_BREAK_PARTICLES = 8;
+    static const int FOOTSTEP_PARTICLES = 3;
+
+private:
+    // Independent xorshift streams; bursts draw from all of them at once
+    static const int RANDOM_LANES = 4;
+
+    int capacity;
+    int count;
+    uint32_t rngState[RANDOM_LANES];
+
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> life;
+    std::vector<float> size;
+    std::vector<Color> color;
+
+    std::vector<const VoxelChunk*> chunkTable;  // Collision scratch, indexed chunkX * depth + chunkZ
+
+    uint32_t NextRandom(int lane);
+    void RandomFloats(int lane, float& a, float& b, float& c);
+    Color GetBlockColor(VoxelType type, const TextureManager* textureManager) const;
+
+    void Integrate(float deltaTime);
+    void Collide(const VoxelWorld* world);
+
+public:
+    explicit ParticleSystem(int capacity = DEFAULT_CAPACITY);
+
+    // Spawning
+    void Spawn(Vector3 position, Vector3 velocity, float lifetime, float particleSize, Color tint);
+    void SpawnBlockBreak(int x, int y, int z, VoxelType type, const TextureManager* textureManager);
+    void SpawnFootstep(Vector3 feet, VoxelType groundType, const TextureManager* textureManager);
+
+    // Integrates, settles particles that enter solid voxels and removes expired ones
+    void Update(float deltaTime, const VoxelWorld* world);
+
+    // All particles go out as camera-facing quads in a single rlgl batch
+    void Draw(const Camera3D& camera) const;
+
+    int GetCount() const { return count; }
+    int GetCapacity() const { return capacity; }
+};
+
+#endif // PARTICLES_H
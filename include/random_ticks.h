@@ -0,0 +1,43 @@
+#ifndef RANDOM_TICKS_H
+#define RANDOM_TICKS_H
+
+#include "voxel.h"
+#include <cstdint>
+#include <vector>
+
+// Random ticks for slow ambient changes: grass spread, leaf decay and fire.
+// Every tick, cellsPerSection random cells are picked in each loaded section (a whole
+// chunk, since chunks are one section tall). Sections whose block histogram has no
+// tickable types are skipped without touching their voxels.
+class RandomTickScheduler {
+public:
+    static const int DEFAULT_CELLS_PER_SECTION = 3;
+    static const int LEAF_DECAY_RADIUS = 4;
+
+private:
+    VoxelWorld* world;
+    int cellsPerSection;
+    int sectionsTickedLastTick;
+    int cellsTickedLastTick;
+
+    static uint32_t ThreadRandom();
+
+    bool HasTickableBlocks(const VoxelChunk* chunk) const;
+    bool IsFlammable(VoxelType type) const;
+    void TickCell(int x, int y, int z, std::vector<BlockEdit>& edits) const;
+    void TickGrass(int x, int y, int z, std::vector<BlockEdit>& edits) const;
+    void TickLeaves(int x, int y, int z, std::vector<BlockEdit>& edits) const;
+    void TickFire(int x, int y, int z, std::vector<BlockEdit>& edits) const;
+
+public:
+    explicit RandomTickScheduler(VoxelWorld* world, int cellsPerSection = DEFAULT_CELLS_PER_SECTION);
+
+    // Chunks are processed in parallel and the combined edits are applied as one batch
+    void Tick();
+
+    void SetCellsPerSection(int count) { cellsPerSection = count; }
+    int GetSectionsTickedLastTick() const { return sectionsTickedLastTick; }
+    int GetCellsTickedLastTick() const { return cellsTickedLastTick; }
+};
+
+#endif // RANDOM_TICKS_H
@@ -0,0 +1,171 @@
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queues for handing results between threads, mostly from
+// workers back to the main thread, which drains them at a fixed point in the
+// frame. Capacity is rounded up to a power of two. Both are full when TryPush
+// returns false; the value is left untouched then, so the caller can retry,
+// back off or run something else.
+//
+// Head and tail live on their own cache lines so the producer and consumer
+// don't invalidate each other's line on every operation.
+
+const size_t RING_CACHE_LINE = 64;
+
+inline size_t RingCapacityFor(size_t requested) {
+    size_t capacity = 2;
+    while (capacity < requested) capacity <<= 1;
+    return capacity;
+}
+
+// One producer thread, one consumer thread. Each side caches the other's index
+// and only reloads it when the queue looks full (or empty), so most operations
+// touch no shared line at all.
+template <typename T>
+class SpscRingQueue {
+private:
+    std::unique_ptr<T[]> slots;
+    size_t mask;
+
+    alignas(RING_CACHE_LINE) std::atomic<size_t> head;  // Next to pop; written by the consumer
+    size_t cachedTail;                                  // Consumer's copy of tail
+
+    alignas(RING_CACHE_LINE) std::atomic<size_t> tail;  // Next to push; written by the producer
+    size_t cachedHead;                                  // Producer's copy of head
+
+public:
+    explicit SpscRingQueue(size_t capacity)
+        : slots(new T[RingCapacityFor(capacity)]), mask(RingCapacityFor(capacity) - 1),
+          head(0), cachedTail(0), tail(0), cachedHead(0) {}
+
+    SpscRingQueue(const SpscRingQueue&) = delete;
+    SpscRingQueue& operator=(const SpscRingQueue&) = delete;
+
+    // Producer only
+    bool TryPush(T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead > mask) return false;
+        }
+        slots[position & mask] = std::move(value);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    bool TryPush(T&& value) { return TryPush(value); }
+
+    // Consumer only. Appends up to maxCount values to out; returns how many.
+    size_t PopBatch(std::vector<T>& out, size_t maxCount) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (cachedTail - position < maxCount) cachedTail = tail.load(std::memory_order_acquire);
+        size_t count = std::min(cachedTail - position, maxCount);
+        for (size_t i = 0; i < count; i++) {
+            out.push_back(std::move(slots[(position + i) & mask]));
+        }
+        // One release for the whole batch hands every slot back to the producer
+        if (count > 0) head.store(position + count, std::memory_order_release);
+        return count;
+    }
+
+    bool TryPop(T& value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail) return false;
+        }
+        value = std::move(slots[position & mask]);
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t GetCapacity() const { return mask + 1; }
+};
+
+// Any number of producer threads, one consumer thread. Producers claim a slot by
+// advancing tail; each slot carries a sequence number that says whether it is
+// free for the lap being claimed or holds a value ready to pop, so a producer
+// that is slow to fill its slot never exposes a half-written value.
+template <typename T>
+class MpscRingQueue {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    alignas(RING_CACHE_LINE) std::atomic<size_t> tail;  // Next to claim; shared by producers
+    alignas(RING_CACHE_LINE) size_t head;               // Next to pop; consumer only
+
+public:
+    explicit MpscRingQueue(size_t capacity)
+        : slots(new Slot[RingCapacityFor(capacity)]), mask(RingCapacityFor(capacity) - 1), tail(0), head(0) {
+        for (size_t i = 0; i <= mask; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingQueue(const MpscRingQueue&) = delete;
+    MpscRingQueue& operator=(const MpscRingQueue&) = delete;
+
+    // Any thread
+    bool TryPush(T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (difference < 0) {
+                return false;  // The consumer hasn't freed this slot from the previous lap
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    bool TryPush(T&& value) { return TryPush(value); }
+
+    // Consumer only
+    bool TryPop(T& value) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        value = std::move(slot.value);
+        slot.sequence.store(head + mask + 1, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+    // Consumer only. Appends up to maxCount values to out; returns how many.
+    // Stops at the first slot a producer hasn't finished, keeping FIFO order.
+    size_t PopBatch(std::vector<T>& out, size_t maxCount) {
+        size_t count = 0;
+        while (count < maxCount) {
+            Slot& slot = slots[head & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;
+            out.push_back(std::move(slot.value));
+            slot.sequence.store(head + mask + 1, std::memory_order_release);
+            head++;
+            count++;
+        }
+        return count;
+    }
+
+    size_t GetCapacity() const { return mask + 1; }
+};
+
+#endif // RING_QUEUE_H
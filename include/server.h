@@ -0,0 +1,155 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "voxel.h"
+#include "network.h"
+#include "chunk_codec.h"
+#include "block_ticks.h"
+#include "fluid.h"
+#include "random_ticks.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// What a client has of one chunk
+enum ChunkInterest : uint8_t {
+    INTEREST_NONE = 0,
+    INTEREST_QUEUED,      // In view, waiting in the send queue
+    INTEREST_SUBSCRIBED   // Sent; gets this chunk's updates until it leaves view
+};
+
+// One connected player
+struct ClientSession {
+    int id;
+    std::string name;
+    std::unique_ptr<Connection> connection;
+    bool joined;        // Got HELLO
+    Vector3 position;   // Last reported
+    Vector3 travel;     // Normalized XZ direction of recent movement, or zero
+
+    // View set. chunkInterest is indexed like the world's chunks; the queue holds
+    // the QUEUED ones, highest priority last.
+    int viewDistance;   // In chunks
+    int viewChunkX, viewChunkZ;
+    std::vector<uint8_t> chunkInterest;
+    std::vector<int> sendQueue;
+    bool queueNeedsSort;
+
+    // Bandwidth. The budget refills by bytesPerTick every tick (0 = unlimited);
+    // updates to subscribed chunks always go out, new chunks only while it's positive.
+    int bytesPerTick;
+    float sendBudget;
+
+    // ChunkCodec::Hash of each chunk as the client has it cached (0 = not cached),
+    // from HELLO and from chunks unsubscribed since; empty if the client has no cache
+    std::vector<uint64_t> cachedHashes;
+
+    // This tick's PACKET_CHUNK_UPDATES entries
+    std::vector<uint8_t> pendingUpdates;
+    int pendingUpdateCount;
+
+    ClientSession() : id(0), joined(false), position({0.0f, 0.0f, 0.0f}), travel({0.0f, 0.0f, 0.0f}),
+                      viewDistance(0), viewChunkX(0), viewChunkZ(0), queueNeedsSort(false),
+                      bytesPerTick(0), sendBudget(0.0f), pendingUpdateCount(0) {}
+};
+
+// The authoritative world and its simulation (scheduled ticks, fluids, random
+// ticks), with no window or GPU resources, so it runs the same in a dedicated
+// headless process and inside the game for singleplayer. Clients join over TCP
+// or through a loopback connection.
+//
+// Each client only gets the chunks within its view distance. Chunks entering view
+// are queued and sent nearest first, favoring the direction the player is moving,
+// as far as the client's bandwidth budget allows; chunks leaving view are
+// unsubscribed. Subscribed chunks get the changes of each tick as one batch: a
+// delta of the changed cells, or the whole compressed chunk where that is smaller.
+// Each changed chunk is encoded once and handed to its subscribers, so the cost
+// follows the players' combined view area, not players x loaded chunks.
+// Clients with a chunk cache list what they hold when joining; chunks whose
+// cached copy is still current are answered with a PACKET_CHUNK_CACHED marker.
+// Player actions arrive as requests and are applied at the start of the next tick.
+class GameServer {
+public:
+    static constexpr float TICK_INTERVAL = 1.0f / 20.0f;
+    static const size_t FULL_RESEND_CHECK_BYTES = 256;  // Smaller deltas are sent without encoding the chunk
+    static const int DEFAULT_VIEW_DISTANCE = 8;         // Chunks
+    static const int MAX_VIEW_DISTANCE = 32;
+    static const int UNSUBSCRIBE_MARGIN = 1;            // Chunks past the view distance before a chunk is dropped
+    static const int DEFAULT_BANDWIDTH_LIMIT = 256 * 1024;  // Bytes per second per TCP client
+    static constexpr float TRAVEL_PRIORITY_WEIGHT = 0.5f;   // Chunks straight ahead count as this much closer
+
+private:
+    VoxelWorld world;
+    std::unique_ptr<BlockTickScheduler> blockTicks;  // Created once the terrain exists
+    std::unique_ptr<FluidSimulator> fluids;
+    std::unique_ptr<RandomTickScheduler> randomTicks;
+
+    TcpListener listener;
+    std::vector<std::unique_ptr<ClientSession>> clients;
+    int nextClientId;
+    int bandwidthLimit;
+
+    std::vector<BlockEdit> requestedEdits;  // From clients, applied at the start of the tick
+    std::vector<ChunkCodec::CellMask> changedCells;  // Per chunk (chunkX * depth + chunkZ), edited this tick
+    std::vector<int> changedChunks;                  // Chunks with a non-empty mask
+    std::vector<uint64_t> chunkHashes;               // Per chunk ChunkCodec::Hash, 0 until needed after an edit
+    std::vector<std::vector<ClientSession*>> subscribers;  // Per chunk
+    std::vector<std::pair<int, std::vector<uint8_t>>> pendingEffects;  // (chunk, packet) for its subscribers
+    int editListenerId;
+
+    uint64_t tickCount;
+    float lastTickMs;
+    uint64_t deltaUpdatesSent;
+    uint64_t fullUpdatesSent;
+    uint64_t chunksSent;
+    uint64_t cachedChunksUsed;
+
+    int AddClient(std::unique_ptr<Connection> connection, int bytesPerSecond);
+    void AcceptClients();
+    void HandlePacket(ClientSession& client, const std::vector<uint8_t>& packet);
+    void Join(ClientSession& client, const std::string& name, Vector3 position, int viewDistance);
+    void MoveClient(ClientSession& client, Vector3 position);
+    void HandleExplode(const Vector3& center, float power);
+    void ResendChunk(ClientSession& client, int chunkX, int chunkZ);
+    uint64_t GetChunkHash(int chunkIndex);
+
+    // Interest management
+    int ChunkIndexAt(Vector3 position, int& chunkX, int& chunkZ) const;
+    void UpdateView(ClientSession& client);
+    void Unsubscribe(ClientSession& client, int chunkIndex, bool notify);
+    void SortSendQueue(ClientSession& client);
+    void SendQueuedChunks(ClientSession& client);
+
+    void BroadcastChunkUpdates();
+    void FlushClientUpdates(ClientSession& client);
+    void DropClosedClients();
+
+public:
+    GameServer(int widthInChunks, int depthInChunks);
+    ~GameServer();
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    // TCP clients get the bandwidth limit; loopback clients are unlimited
+    bool Listen(int port = DEFAULT_SERVER_PORT);
+    int AddClient(std::unique_ptr<Connection> connection) { return AddClient(std::move(connection), bandwidthLimit); }
+    void SetBandwidthLimit(int bytesPerSecond) { bandwidthLimit = bytesPerSecond; }  // For clients that join later
+
+    // Singleplayer: a new in-process client; returns the client's end
+    std::unique_ptr<Connection> ConnectLoopback();
+
+    // One simulation step: client requests, world ticks, then the sends
+    void Tick();
+
+    VoxelWorld& GetWorld() { return world; }
+    int GetClientCount() const { return (int)clients.size(); }
+    uint64_t GetTickCount() const { return tickCount; }
+    float GetLastTickMs() const { return lastTickMs; }
+    uint64_t GetDeltaUpdatesSent() const { return deltaUpdatesSent; }
+    uint64_t GetFullUpdatesSent() const { return fullUpdatesSent; }  // Chunks resent whole instead of a delta
+    uint64_t GetChunksSent() const { return chunksSent; }            // Initial sends of chunks entering view
+    uint64_t GetCachedChunksUsed() const { return cachedChunksUsed; }  // Of those, answered from the client's cache
+};
+
+#endif // SERVER_H
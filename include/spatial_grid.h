@@ -0,0 +1,67 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "raylib.h"
+#include "entity.h"
+#include <cstdint>
+#include <vector>
+
+// Forward declarations
+class VoxelWorld;
+
+// Uniform-grid broadphase for entity-entity queries.
+// Cells are aligned to chunk boundaries (a chunk is exactly CELLS_PER_CHUNK cells wide),
+// and the grid is rebuilt every tick with a counting sort into flat arrays -
+// no per-cell containers, so rebuilding costs O(n) with no allocations once warmed up.
+class SpatialGrid {
+public:
+    static const int CELL_SIZE = 4;
+    static const int CELLS_PER_CHUNK = 4;  // VoxelChunk::CHUNK_SIZE / CELL_SIZE
+
+private:
+    // Entries in insertion order
+    std::vector<EntityId> stagedIds;
+    std::vector<float> stagedX, stagedY, stagedZ, stagedRadius;
+    std::vector<uint64_t> stagedCell;
+    std::vector<uint32_t> stagedBucket;
+
+    // Entries sorted by bucket; bucket b owns [bucketStart[b], bucketStart[b + 1])
+    std::vector<uint32_t> bucketStart;
+    std::vector<EntityId> sortedIds;
+    std::vector<float> sortedX, sortedY, sortedZ, sortedRadius;
+    std::vector<uint64_t> sortedCell;
+
+    uint32_t bucketMask;
+    float maxRadius;
+
+    static int CellCoord(float v);
+    static uint64_t PackCell(int cx, int cy, int cz);
+    uint32_t BucketForCell(int cx, int cy, int cz) const;
+
+    // Visits every entry whose cell overlaps the cell range
+    template <typename Fn>
+    void VisitCells(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, Fn fn) const;
+
+public:
+    SpatialGrid();
+
+    // Rebuild: Clear, Insert every entity, then Build
+    void Clear();
+    void Insert(EntityId id, Vector3 position, float radius);
+    void Build();
+
+    // Entities whose bounds (center +- radius) overlap the box / sphere. Query replaces
+    // the results, Append adds to them.
+    void QueryAABB(BoundingBox box, std::vector<EntityId>& results) const;
+    void QueryRadius(Vector3 center, float radius, std::vector<EntityId>& results) const;
+    void AppendAABB(BoundingBox box, std::vector<EntityId>& results) const;
+    void AppendRadius(Vector3 center, float radius, std::vector<EntityId>& results) const;
+
+    int GetEntryCount() const { return (int)sortedIds.size(); }
+
+    // Voxel collision through the same chunk-aligned cells
+    static bool BoxHitsVoxels(const VoxelWorld* world, BoundingBox box);
+    static void QueryVoxelBoxes(const VoxelWorld* world, BoundingBox box, std::vector<BoundingBox>& results);
+};
+
+#endif // SPATIAL_GRID_H
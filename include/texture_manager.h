@@ -2,51 +2,25 @@
 #define TEXTURE_MANAGER_H
 
 #include "raylib.h"
+#include "block_registry.h"
 #include <unordered_map>
 #include <string>
 #include <vector>
 
-// Block data structure for JSON parsing
-struct BlockData {
-    int id;
-    std::string name;
-    std::string displayName;
-    bool transparent;
-    bool liquid;
-    bool flammable;
-    bool breakable;
-    bool emitsLight;
-    float hardness;
-    int lightLevel;
-    std::string soundGroup;
-    std::string toolRequired;
-    
-    // Texture mappings
-    std::string topTexture;
-    std::string bottomTexture;
-    std::string sideTexture;
-    std::string allTexture;
-    
-    // Tint color (RGBA)
-    Color tintColor;
-};
-
 // Texture atlas system for efficient texture management
 class TextureManager {
 private:
     std::unordered_map<std::string, Texture2D> textures;
-    std::unordered_map<int, BlockData> blockData; // Block ID to block data mapping
+    std::unordered_map<std::string, Color> averageColors; // Mean opaque texel color, for particles
+    std::unordered_map<std::string, std::string> texturePaths; // Source file of each loaded texture
     Material defaultMaterial;
     std::string textureBasePath;
     
-    // Helper function for JSON parsing
-    BlockData ParseBlockFromJson(const std::string& blockJson);
-    
 public:
     TextureManager(const std::string& basePath = "assets/textures/blocks/");
     ~TextureManager();
     
-    // Block data loading
+    // Block data loading; blocks are registered with the BlockRegistry
     bool LoadBlockData(const std::string& jsonFilePath = "assets/data/blocks.json");
     
     // Texture loading
@@ -59,9 +33,12 @@ public:
     Texture2D GetTexture(const std::string& name) const;
     Material CreateMaterial(const std::string& textureName);
     bool HasTexture(const std::string& name) const;
+    Color GetAverageColor(const std::string& name) const;
+    std::string GetTexturePath(const std::string& name) const; // Empty if not loaded
     
     // Block data access
     const BlockData* GetBlockData(int voxelType) const;
+    int FindBlockId(const std::string& name) const; // -1 if no block has that name
     std::string GetTextureNameForVoxel(int voxelType, int face = -1) const;
     
     // GUI texture helpers
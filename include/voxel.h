@@ -6,10 +6,19 @@
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "block_registry.h"
 
 // Forward declarations
 class VoxelWorld;
 class TextureManager;
+struct ChunkMeshes;
+struct MaterialMesh;
 
 // Voxel types
 enum VoxelType {
@@ -22,9 +31,13 @@ enum VoxelType {
     VOXEL_LEAVES = 6,
     VOXEL_SAND = 7,
     VOXEL_WATER = 8,
+    VOXEL_FIRE = 9,
     VOXEL_BEDROCK = 13
 };
 
+// Upper bound on VoxelType values, for per-type tables
+const int VOXEL_TYPE_LIMIT = BLOCK_ID_LIMIT;
+
 // Face directions for culling
 enum FaceDirection {
     FACE_TOP = 0,
@@ -36,70 +49,174 @@ enum FaceDirection {
     FACE_COUNT
 };
 
+// Liquids and fire are drawn but don't block movement or hide neighboring faces.
+// These are single loads from the block registry's flag table.
+inline bool IsLiquidType(VoxelType type) { return BlockRegistry::Get().flags[type] & BLOCK_LIQUID; }
+inline bool IsSeeThroughType(VoxelType type) { return BlockRegistry::Get().flags[type] & BLOCK_SEE_THROUGH; }
+inline bool IsSolidType(VoxelType type) { return BlockRegistry::Get().flags[type] & BLOCK_SOLID; }
+inline bool IsOpaqueType(VoxelType type) { return BlockRegistry::Get().flags[type] & BLOCK_OPAQUE; }
+
 // Single voxel structure
 struct Voxel {
     VoxelType type;
     bool isActive;
+    uint8_t metadata;  // Per-type state, e.g. fluid level
+    
+    Voxel() : type(VOXEL_AIR), isActive(false), metadata(0) {}
+    Voxel(VoxelType t, uint8_t meta = 0) : type(t), isActive(t != VOXEL_AIR), metadata(meta) {}
+};
+
+// Single block change, applied in batches through VoxelWorld::ApplyEdits
+struct BlockEdit {
+    int x, y, z;
+    VoxelType type;
+    uint8_t metadata;
     
-    Voxel() : type(VOXEL_AIR), isActive(false) {}
-    Voxel(VoxelType t) : type(t), isActive(t != VOXEL_AIR) {}
+    BlockEdit() : x(0), y(0), z(0), type(VOXEL_AIR), metadata(0) {}
+    BlockEdit(int ex, int ey, int ez, VoxelType t, uint8_t meta = 0) : x(ex), y(ey), z(ez), type(t), metadata(meta) {}
 };
 
-// Material mesh data for multi-material chunks
-struct MaterialMesh {
-    Mesh mesh;
-    Material material;
-    std::string textureName;
-    bool isGenerated;
-    
-    MaterialMesh() : mesh({0}), material({0}), isGenerated(false) {}
+// Chunk lifecycle. States only move forward, except that an unloaded chunk is
+// cleared back to UNLOADED once nothing holds a reference to it any more.
+enum ChunkState {
+    CHUNK_UNLOADED = 0,  // No data; reads see air
+    CHUNK_GENERATING,    // Being filled by the generator or from the network
+    CHUNK_GENERATED,     // Voxels complete
+    CHUNK_LIT,           // Lighting done; there is no lighting pass yet, so this follows GENERATED
+    CHUNK_MESHED,        // First mesh built, waiting for upload
+    CHUNK_VISIBLE,       // Mesh uploaded and drawn; remeshes keep this state
+    CHUNK_UNLOADING      // Not drawn; cleared once the last reference is released
 };
 
+// Cheap, well-mixed hash of a voxel position for per-block variation
+inline uint32_t PositionHash(int x, int y, int z) {
+    uint32_t hash = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u;
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+    return hash;
+}
+
 // Voxel chunk for efficient rendering
 class VoxelChunk {
 public:
     static const int CHUNK_SIZE = 16;
     static const int CHUNK_HEIGHT = 16;
+    static const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_HEIGHT * CHUNK_SIZE;
+    static constexpr float FOLIAGE_MAX_OFFSET = 0.2f;  // Sideways jitter of plants, in blocks
+    static const size_t MESH_VERTEX_BYTES = 36;        // Position, normal, texcoord, color
+    
+    // Packed local cell index, used by per-chunk queues and bitsets
+    static int CellIndex(int x, int y, int z) { return x + z * CHUNK_SIZE + y * CHUNK_SIZE * CHUNK_SIZE; }
+    static void CellCoords(int index, int& x, int& y, int& z) {
+        x = index % CHUNK_SIZE;
+        z = (index / CHUNK_SIZE) % CHUNK_SIZE;
+        y = index / (CHUNK_SIZE * CHUNK_SIZE);
+    }
     
 private:
-    Voxel voxels[CHUNK_SIZE][CHUNK_HEIGHT][CHUNK_SIZE];
-    std::unordered_map<std::string, MaterialMesh> materialMeshes;
+    // Voxels are resident, compressed with ChunkCodec, or absent for a chunk of pure
+    // air. Reads decompress on demand, hence mutable.
+    mutable std::unique_ptr<Voxel[][CHUNK_HEIGHT][CHUNK_SIZE]> voxels;
+    mutable std::vector<uint8_t> compressedVoxels;
+    mutable std::atomic<bool> voxelsCompressed;
+    mutable std::mutex storageMutex;               // Serializes readers racing to decompress
+    mutable std::atomic<bool> accessed;            // Set by voxel reads and writes, see TakeAccessed
+    std::atomic<uint32_t> compressionCount;
+    mutable std::atomic<uint32_t> decompressionCount;
+    uint16_t solidMask[CHUNK_HEIGHT][CHUNK_SIZE];  // One bit per voxel along X, kept in sync by SetVoxel
+    uint16_t blockCounts[VOXEL_TYPE_LIMIT];        // Histogram of voxel types, kept in sync by SetVoxel
+    std::shared_ptr<ChunkMeshes> meshes;           // Uploaded and drawn, see chunk_mesh.h
+    std::shared_ptr<ChunkMeshes> pendingMeshes;    // Built but not yet uploaded
     bool meshNeedsUpdate;
     Vector3 chunkPosition;
-    bool meshGenerated;
+    bool meshEvicted;
+    size_t meshBytes;             // Vertex data of the live meshes
+    size_t lastMeshBytes;         // Kept after eviction, as an estimate for bringing it back
+    uint32_t lastVisibleFrame;
+    std::atomic<int> state;       // ChunkState
+    std::atomic<int> references;  // Held by ChunkHandles
     
 public:
     VoxelChunk(Vector3 position);
     ~VoxelChunk();
     
     // Voxel management
-    void SetVoxel(int x, int y, int z, VoxelType type);
+    void SetVoxel(int x, int y, int z, VoxelType type, uint8_t metadata = 0);
     Voxel GetVoxel(int x, int y, int z) const;
     bool IsValidPosition(int x, int y, int z) const;
+    bool IsSolid(int x, int y, int z) const;
+    uint16_t GetSolidRow(int y, int z) const { return solidMask[y][z]; }
+    int GetBlockCount(VoxelType type) const { return blockCounts[type]; }
     
-    // Mesh generation
+    // Mesh generation, in chunk_mesh.cpp
     void GenerateMesh(VoxelWorld* world = nullptr, TextureManager* textureManager = nullptr);
     void Draw();
+    void DrawFoliage(Shader cutoutShader);
     void MarkForUpdate() { meshNeedsUpdate = true; }
+    bool NeedsMeshUpdate() const { return meshNeedsUpdate; }
+    bool HasPendingMesh() const { return pendingMeshes != nullptr; }
+    
+    // GenerateMesh in two halves: BuildMesh only touches CPU memory and may run on a
+    // worker thread, UploadPendingMesh talks to the GPU and must run on the main thread
+    void BuildMesh(const VoxelWorld* world);
+    void UploadPendingMesh(const TextureManager* textureManager);
+    
+    // Lifecycle. TransitionState only succeeds from the expected state, so a chunk
+    // unloaded meanwhile isn't pushed back into the pipeline.
+    ChunkState GetState() const { return (ChunkState)state.load(); }
+    bool TransitionState(ChunkState from, ChunkState to);
+    void AddReference() { references.fetch_add(1); }
+    void ReleaseReference() { references.fetch_sub(1); }
+    int GetReferenceCount() const { return references.load(); }
+    
+    // Resets every voxel to air and frees the meshes. Main thread only (GPU).
+    void Clear();
+    
+    // Memory. Mesh bytes count against RAM as well as VRAM, since raylib keeps a CPU
+    // copy of every uploaded mesh.
+    size_t GetVoxelMemory() const;
+    size_t GetMeshMemory() const { return meshBytes; }
+    size_t GetLastMeshMemory() const { return lastMeshBytes; }
+    bool IsCompressed() const { return voxelsCompressed.load(); }
+    uint32_t GetCompressionCount() const { return compressionCount.load(std::memory_order_relaxed); }
+    uint32_t GetDecompressionCount() const { return decompressionCount.load(std::memory_order_relaxed); }
+    
+    // Whether the voxels were read or written since the last call; clears the flag
+    bool TakeAccessed() { return accessed.exchange(false, std::memory_order_relaxed); }
+    void MarkVisible(uint32_t frame) { lastVisibleFrame = frame; }
+    uint32_t GetLastVisibleFrame() const { return lastVisibleFrame; }
+    
+    // Compresses the voxels in memory; the next read decompresses them. False if
+    // that wouldn't save anything. Main thread, with no job reading the chunk.
+    bool CompressVoxels();
+    
+    // Frees the meshes but keeps the voxels. The chunk drops back to LIT and isn't
+    // remeshed until something calls MarkForUpdate. Main thread only.
+    void EvictMesh();
+    bool IsMeshEvicted() const { return meshEvicted; }
     
     // Utility
     Vector3 GetWorldPosition(int x, int y, int z) const;
     Vector3 GetChunkPosition() const { return chunkPosition; }
     
 private:
-    bool IsFaceVisible(int x, int y, int z, FaceDirection face, VoxelWorld* world = nullptr) const;
+    void FreeMeshes();
+    bool LoadVoxels() const;  // False for a chunk of pure air with no storage
+    void DecompressVoxels() const;
+    bool IsFaceVisible(int x, int y, int z, FaceDirection face, const VoxelWorld* world = nullptr) const;
     
     // Greedy meshing structures
     struct FaceMask {
         bool visible;
         VoxelType voxelType;
-        std::string textureName;
+        int textureId;  // BlockRegistry texture table index
         
-        FaceMask() : visible(false), voxelType(VOXEL_AIR), textureName("") {}
-        FaceMask(bool v, VoxelType t, const std::string& tex) : visible(v), voxelType(t), textureName(tex) {}
+        FaceMask() : visible(false), voxelType(VOXEL_AIR), textureId(0) {}
+        FaceMask(bool v, VoxelType t, int tex) : visible(v), voxelType(t), textureId(tex) {}
         
         bool operator==(const FaceMask& other) const {
-            return visible == other.visible && voxelType == other.voxelType && textureName == other.textureName;
+            return visible == other.visible && voxelType == other.voxelType && textureId == other.textureId;
         }
     };
     
@@ -107,15 +224,25 @@ private:
         Vector3 startPosition;  // Position of the first voxel in the quad
         int width, height;      // Size in voxel units
         FaceDirection face;
-        std::string textureName;
+        int textureId;
         
-        QuadMesh(Vector3 pos, int w, int h, FaceDirection f, const std::string& tex) 
-            : startPosition(pos), width(w), height(h), face(f), textureName(tex) {}
+        QuadMesh(Vector3 pos, int w, int h, FaceDirection f, int tex) 
+            : startPosition(pos), width(w), height(h), face(f), textureId(tex) {}
     };
     
-    void GenerateGreedyMesh(VoxelWorld* world, TextureManager* textureManager);
+    struct VertexBuffers {
+        std::vector<Vector3> vertices;
+        std::vector<Vector3> normals;
+        std::vector<Vector2> texcoords;
+        std::vector<Color> colors;
+    };
+    
+    void GenerateGreedyMesh(const VoxelWorld* world);
+    void AddModelQuads(const VoxelWorld* world, std::vector<VertexBuffers>& geometry) const;
+    void AddFoliageQuads(const VoxelWorld* world, std::vector<VertexBuffers>& geometry) const;
+    static void FillMaterialMesh(MaterialMesh& matMesh, const std::string& textureName, const VertexBuffers& buffers);
     int GetMaxLayerForFace(FaceDirection face) const;
-    void ExtractFaceMask(FaceDirection face, int layer, VoxelWorld* world, TextureManager* textureManager, 
+    void ExtractFaceMask(FaceDirection face, int layer, const VoxelWorld* world,
                         FaceMask mask[CHUNK_SIZE][CHUNK_SIZE]);
     void GreedyMeshFace(FaceDirection face, int layer, FaceMask mask[CHUNK_SIZE][CHUNK_SIZE], 
                        std::vector<QuadMesh>& quads);
@@ -129,12 +256,81 @@ private:
                        Vector3 position, FaceDirection face) const;
 };
 
+// Counted reference to a chunk. Jobs that use a chunk beyond the call that
+// started them hold one, and an unloaded chunk is only cleared once all of its
+// handles are gone. Get them from VoxelWorld::AcquireChunk.
+class ChunkHandle {
+private:
+    friend class VoxelWorld;
+    VoxelChunk* chunk;
+    
+    explicit ChunkHandle(VoxelChunk* referenced) : chunk(referenced) {}  // Adopts a reference
+    
+public:
+    ChunkHandle() : chunk(nullptr) {}
+    ChunkHandle(const ChunkHandle& other) : chunk(other.chunk) { if (chunk) chunk->AddReference(); }
+    ChunkHandle(ChunkHandle&& other) noexcept : chunk(other.chunk) { other.chunk = nullptr; }
+    ~ChunkHandle() { Reset(); }
+    
+    ChunkHandle& operator=(ChunkHandle other) {
+        std::swap(chunk, other.chunk);
+        return *this;
+    }
+    
+    void Reset() {
+        if (chunk) chunk->ReleaseReference();
+        chunk = nullptr;
+    }
+    
+    VoxelChunk* Get() const { return chunk; }
+    VoxelChunk* operator->() const { return chunk; }
+    explicit operator bool() const { return chunk != nullptr; }
+};
+
 // Voxel world manager
 class VoxelWorld {
+public:
+    static const int DEFAULT_MESH_UPLOAD_BUDGET = 4;
+    static constexpr float DEFAULT_FOLIAGE_DISTANCE = 48.0f;
+    static constexpr float DEFAULT_COLD_CHUNK_SECONDS = 30.0f;
+    
+    // Compressed-at-rest chunks. Totals include compressions MemoryBudget asked for.
+    struct CompressionStats {
+        int compressedChunks = 0;
+        size_t bytesSaved = 0;        // Resident size minus compressed size, over compressedChunks
+        uint64_t compressions = 0;
+        uint64_t decompressions = 0;
+        uint64_t accesses = 0;        // Chunks read or written, once per CompressColdChunks call
+        
+        // Share of accesses that found the voxels resident
+        float GetHitRate() const {
+            if (accesses == 0) return 1.0f;
+            if (decompressions >= accesses) return 0.0f;
+            return 1.0f - (float)decompressions / (float)accesses;
+        }
+    };
+    
+    // Called once per touched chunk with the edits that landed in it
+    using EditListener = std::function<void(int chunkX, int chunkZ, const std::vector<BlockEdit>& edits)>;
+    
 private:
     std::vector<std::vector<VoxelChunk*>> chunks;
     int worldWidth, worldDepth;
     TextureManager* textureManager;
+    std::vector<std::pair<int, EditListener>> editListeners;
+    int nextListenerId;
+    int meshUploadBudget;
+    int uploadCursor;
+    uint32_t drawFrame;
+    float foliageDistance;
+    float coldChunkSeconds;
+    std::vector<float> idleSeconds;  // Per chunk, since its voxels were last accessed
+    CompressionStats compressionStats;
+    std::shared_ptr<Shader> cutoutShader;  // Loaded on first draw, needs a GL context; unloaded like ChunkMeshes
+    
+    float GetBlastResistance(VoxelType type, bool& breakable) const;
+    void MarkNeighborsForUpdate(int chunkX, int chunkZ);
+    void DrawChunks(Vector3 viewPosition, bool cullToView);
     
 public:
     VoxelWorld(int width, int depth);
@@ -142,18 +338,70 @@ public:
     
     // Texture management
     void SetTextureManager(TextureManager* tm) { textureManager = tm; }
+    const TextureManager* GetTextureManager() const { return textureManager; }
     
     // World management
-    void SetVoxel(int worldX, int worldY, int worldZ, VoxelType type);
+    void SetVoxel(int worldX, int worldY, int worldZ, VoxelType type, uint8_t metadata = 0);
     Voxel GetVoxel(int worldX, int worldY, int worldZ) const;
+    bool IsSolid(int worldX, int worldY, int worldZ) const;
+    
+    // Batched edits - gameplay changes should go through here instead of SetVoxel.
+    // Edits are grouped per chunk, every touched chunk (and border neighbor) is
+    // marked for a single remesh, and listeners are notified once per chunk.
+    void ApplyEdits(const std::vector<BlockEdit>& edits);
+    int AddEditListener(EditListener listener);
+    void RemoveEditListener(int listenerId);
     
-    // Rendering
+    // Casts rays out from center; each ray weakens with distance and with the hardness
+    // of every block it crosses, and indestructible blocks (negative hardness) stop it.
+    // Everything destroyed is removed in one ApplyEdits batch. Returns the number of
+    // blocks destroyed; their positions and former types go to destroyed if given.
+    int Explode(Vector3 center, float power, std::vector<BlockEdit>* destroyed = nullptr);
+    
+    // Rendering, in chunk_mesh.cpp. Update clears chunks whose unload is no longer held up, rebuilds
+    // dirty chunk meshes in parallel and uploads at most meshUploadBudget of them
+    // per call; the rest are uploaded on later frames. Only VISIBLE chunks are drawn,
+    // and Draw(viewPosition) also skips chunks outside the camera frustum (call it inside
+    // BeginMode3D). Cutout foliage is drawn after the solid pass, and only for chunks within
+    // foliageDistance of viewPosition; Draw() without a position draws all of it.
     void Draw();
+    void Draw(Vector3 viewPosition);
     void Update();
+    void SetMeshUploadBudget(int chunksPerFrame) { meshUploadBudget = chunksPerFrame; }
+    void SetFoliageDistance(float distance) { foliageDistance = distance; }
+    float GetFoliageDistance() const { return foliageDistance; }
+    uint32_t GetDrawFrame() const { return drawFrame; }  // Drawn chunks remember it in MarkVisible; 0 before any draw
+    
+    // Streaming. BeginChunkLoad claims an unloaded (or still unloading) chunk for
+    // filling and FinishChunkLoad publishes it; UnloadChunk stops drawing it at once
+    // but defers clearing it to a later Update, after every handle is released.
+    // AcquireChunk returns an empty handle unless the chunk's voxels are complete.
+    // AcquireChunkArea adds handles on the chunk and its loaded neighbors, for jobs
+    // that read across its borders; without the chunk itself it adds nothing.
+    bool BeginChunkLoad(int chunkX, int chunkZ);
+    void FinishChunkLoad(int chunkX, int chunkZ);
+    bool UnloadChunk(int chunkX, int chunkZ);
+    ChunkHandle AcquireChunk(int chunkX, int chunkZ);
+    bool AcquireChunkArea(int chunkX, int chunkZ, std::vector<ChunkHandle>& handles);
+    ChunkState GetChunkState(int chunkX, int chunkZ) const;
+    
+    // Compresses the voxels of loaded chunks nothing has read or written for
+    // coldChunkSeconds (0 turns it off); the next access decompresses them. Call it
+    // regularly from the thread that owns the world, outside any ParallelFor.
+    void CompressColdChunks(float deltaSeconds);
+    void SetColdChunkSeconds(float seconds) { coldChunkSeconds = seconds; }
+    const CompressionStats& GetCompressionStats() const { return compressionStats; }
+    
+    // Clears unloading chunks nothing references any more. Update calls it; worlds
+    // that are never drawn call it directly. Main thread only.
+    void CollectUnloadedChunks();
     
     // Utility
     VoxelChunk* GetChunk(int chunkX, int chunkZ);
+    const VoxelChunk* GetChunk(int chunkX, int chunkZ) const;
     void WorldToChunkCoords(int worldX, int worldZ, int& chunkX, int& chunkZ, int& localX, int& localZ) const;
+    int GetWidth() const { return worldWidth; }
+    int GetDepth() const { return worldDepth; }
     
     // Terrain generation
     void GenerateTestTerrain();
@@ -0,0 +1,273 @@
+#include "../include/block_model.h"
+#include "../include/voxel.h"
+#include "raymath.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // Unit cube face corners, in the winding AddFaceToMesh uses
+    const Vector3 CUBE_FACE_CORNERS[FACE_COUNT][4] = {
+        {{-0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, -0.5f}},      // Top
+        {{-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, 0.5f}, {-0.5f, -0.5f, 0.5f}},  // Bottom
+        {{-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}},      // Front
+        {{0.5f, -0.5f, -0.5f}, {-0.5f, -0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}},  // Back
+        {{0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}},      // Right
+        {{-0.5f, -0.5f, -0.5f}, {-0.5f, -0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, -0.5f}},  // Left
+    };
+
+    const Vector3 FACE_NORMALS[FACE_COUNT] = {
+        {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {-1, 0, 0}
+    };
+
+    // Texture coordinates matching AddFaceToMesh's full-face mapping, so a partial
+    // face shows the matching part of the texture instead of a squashed copy
+    Vector2 FaceUV(int face, Vector3 p) {
+        switch (face) {
+            case FACE_TOP: return {p.z + 0.5f, 0.5f - p.x};
+            case FACE_BOTTOM: return {p.x + 0.5f, 0.5f - p.z};
+            case FACE_FRONT: return {p.x + 0.5f, 0.5f - p.y};
+            case FACE_BACK: return {0.5f - p.x, 0.5f - p.y};
+            case FACE_RIGHT: return {0.5f - p.z, 0.5f - p.y};
+            default: return {p.z + 0.5f, 0.5f - p.y};
+        }
+    }
+
+    // Reads "[a, b, c]" starting at or after pos
+    bool ParseVector(const std::string& json, size_t pos, float out[3]) {
+        size_t open = json.find('[', pos);
+        if (open == std::string::npos) return false;
+        const char* cursor = json.c_str() + open + 1;
+        for (int i = 0; i < 3; i++) {
+            char* end;
+            out[i] = std::strtof(cursor, &end);
+            if (end == cursor) return false;
+            cursor = end;
+            while (*cursor == ',' || *cursor == ' ') cursor++;
+        }
+        return true;
+    }
+}
+
+BlockModelLibrary::BlockModelLibrary() {
+    shapes.push_back(FaceMask());         // SHAPE_NONE
+    shapes.push_back(FaceMask().set());   // SHAPE_FULL
+    RebuildCoverTable();
+
+    AddBoxModel("cube", {{{0, 0, 0}, {16, 16, 16}}});
+}
+
+int BlockModelLibrary::InternShape(const FaceMask& mask) {
+    for (size_t i = 0; i < shapes.size(); i++) {
+        if (shapes[i] == mask) return (int)i;
+    }
+    shapes.push_back(mask);
+    RebuildCoverTable();
+    return (int)shapes.size() - 1;
+}
+
+void BlockModelLibrary::RebuildCoverTable() {
+    size_t count = shapes.size();
+    coverTable.assign(count * count, 0);
+    for (size_t coverer = 0; coverer < count; coverer++) {
+        for (size_t covered = 0; covered < count; covered++) {
+            // An empty face has nothing to hide
+            coverTable[coverer * count + covered] =
+                shapes[covered].any() && (shapes[covered] & ~shapes[coverer]).none();
+        }
+    }
+}
+
+void BlockModelLibrary::AddBox(BlockModel& model, const float from[3], const float to[3], FaceMask masks[6]) {
+    for (int face = 0; face < FACE_COUNT; face++) {
+        ModelQuad quad;
+        for (int i = 0; i < 4; i++) {
+            const Vector3& unit = CUBE_FACE_CORNERS[face][i];
+            Vector3 p = {(unit.x < 0 ? from[0] : to[0]) / 16.0f - 0.5f,
+                         (unit.y < 0 ? from[1] : to[1]) / 16.0f - 0.5f,
+                         (unit.z < 0 ? from[2] : to[2]) / 16.0f - 0.5f};
+            quad.corners[i] = p;
+            quad.uvs[i] = FaceUV(face, p);
+        }
+        quad.normal = FACE_NORMALS[face];
+        quad.textureFace = (uint8_t)face;
+
+        // Faces lying on the block boundary can be hidden by the neighbor there and
+        // contribute to what this model hides of its neighbor
+        bool onBoundary = false;
+        float a0 = 0, a1 = 0, b0 = 0, b1 = 0;  // Coverage in world-axis face coordinates
+        switch (face) {
+            case FACE_TOP: onBoundary = to[1] >= 16; break;
+            case FACE_BOTTOM: onBoundary = from[1] <= 0; break;
+            case FACE_FRONT: onBoundary = to[2] >= 16; break;
+            case FACE_BACK: onBoundary = from[2] <= 0; break;
+            case FACE_RIGHT: onBoundary = to[0] >= 16; break;
+            case FACE_LEFT: onBoundary = from[0] <= 0; break;
+        }
+        if (face == FACE_TOP || face == FACE_BOTTOM) {
+            a0 = from[0]; a1 = to[0]; b0 = from[2]; b1 = to[2];
+        } else if (face == FACE_FRONT || face == FACE_BACK) {
+            a0 = from[0]; a1 = to[0]; b0 = from[1]; b1 = to[1];
+        } else {
+            a0 = from[2]; a1 = to[2]; b0 = from[1]; b1 = to[1];
+        }
+        if (a1 <= a0 || b1 <= b0) continue;  // Flat box, no face on this side
+
+        quad.cullFace = onBoundary ? (int8_t)face : -1;
+        model.quads.push_back(quad);
+
+        if (onBoundary) {
+            for (int b = (int)b0; b < (int)b1 && b < 16; b++) {
+                for (int a = (int)a0; a < (int)a1 && a < 16; a++) {
+                    masks[face].set(b * 16 + a);
+                }
+            }
+        }
+    }
+}
+
+void BlockModelLibrary::AddCross(BlockModel& model) {
+    // Two diagonal planes, each drawn from both sides
+    const Vector3 planes[2][4] = {
+        {{-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, -0.5f}},
+        {{-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, 0.5f}},
+    };
+    const Vector2 uvs[4] = {{0, 1}, {1, 1}, {1, 0}, {0, 0}};
+
+    for (const auto& plane : planes) {
+        for (int side = 0; side < 2; side++) {
+            ModelQuad quad;
+            for (int i = 0; i < 4; i++) {
+                // The back side swaps the bottom and top pairs to flip the winding
+                int source = side == 0 ? i : (i ^ 1);
+                quad.corners[i] = plane[source];
+                quad.uvs[i] = uvs[source];
+            }
+            quad.normal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(quad.corners[1], quad.corners[0]),
+                                                               Vector3Subtract(quad.corners[2], quad.corners[0])));
+            quad.cullFace = -1;
+            quad.textureFace = FACE_FRONT;
+            model.quads.push_back(quad);
+        }
+    }
+}
+
+int BlockModelLibrary::Finish(BlockModel& model, FaceMask masks[6]) {
+    for (int face = 0; face < FACE_COUNT; face++) {
+        int shape = InternShape(masks[face]);
+        model.faceShape[face] = (uint16_t)shape;
+        model.occlusion[face] = shape == SHAPE_NONE ? OCCLUSION_NONE :
+                                shape == SHAPE_FULL ? OCCLUSION_FULL : OCCLUSION_PARTIAL;
+    }
+
+    auto it = idsByName.find(model.name);
+    if (it != idsByName.end()) {
+        models[it->second] = model;  // Redefinition replaces the old model
+        return it->second;
+    }
+    int modelId = (int)models.size();
+    idsByName[model.name] = modelId;
+    models.push_back(model);
+    return modelId;
+}
+
+int BlockModelLibrary::AddBoxModel(const std::string& name, const std::vector<std::pair<Vector3, Vector3>>& boxes) {
+    BlockModel model;
+    model.name = name;
+    FaceMask masks[FACE_COUNT];
+    for (const auto& box : boxes) {
+        float from[3] = {box.first.x, box.first.y, box.first.z};
+        float to[3] = {box.second.x, box.second.y, box.second.z};
+        AddBox(model, from, to, masks);
+    }
+    return Finish(model, masks);
+}
+
+int BlockModelLibrary::AddCrossModel(const std::string& name) {
+    BlockModel model;
+    model.name = name;
+    AddCross(model);
+    FaceMask masks[FACE_COUNT];
+    return Finish(model, masks);
+}
+
+int BlockModelLibrary::Find(const std::string& name) const {
+    auto it = idsByName.find(name);
+    return it != idsByName.end() ? it->second : -1;
+}
+
+bool BlockModelLibrary::ParseModel(const std::string& modelJson) {
+    size_t namePos = modelJson.find("\"name\":");
+    if (namePos == std::string::npos) return false;
+    size_t nameStart = modelJson.find('"', namePos + 7) + 1;
+    std::string name = modelJson.substr(nameStart, modelJson.find('"', nameStart) - nameStart);
+
+    size_t crossPos = modelJson.find("\"cross\":");
+    if (crossPos != std::string::npos && modelJson.find("true", crossPos) < modelJson.find_first_of(",}", crossPos)) {
+        return AddCrossModel(name) >= 0;
+    }
+
+    // "elements": [{ "from": [x, y, z], "to": [x, y, z] }, ...]
+    std::vector<std::pair<Vector3, Vector3>> boxes;
+    size_t pos = modelJson.find("\"elements\":");
+    while (pos != std::string::npos) {
+        size_t fromPos = modelJson.find("\"from\":", pos);
+        size_t toPos = modelJson.find("\"to\":", pos);
+        if (fromPos == std::string::npos || toPos == std::string::npos) break;
+
+        float from[3], to[3];
+        if (!ParseVector(modelJson, fromPos, from) || !ParseVector(modelJson, toPos, to)) {
+            std::cout << "Model " << name << " has a malformed element" << std::endl;
+            return false;
+        }
+        boxes.push_back({{from[0], from[1], from[2]}, {to[0], to[1], to[2]}});
+        pos = std::max(fromPos, toPos) + 1;
+    }
+    if (boxes.empty()) {
+        std::cout << "Model " << name << " has no elements" << std::endl;
+        return false;
+    }
+    return AddBoxModel(name, boxes) >= 0;
+}
+
+bool BlockModelLibrary::LoadFromJson(const std::string& jsonFilePath) {
+    std::ifstream file(jsonFilePath);
+    if (!file.is_open()) {
+        std::cout << "Failed to open models file: " << jsonFilePath << std::endl;
+        return false;
+    }
+
+    std::string jsonContent((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+    file.close();
+
+    size_t modelsStart = jsonContent.find("\"models\":");
+    if (modelsStart == std::string::npos) {
+        std::cout << "Could not find 'models' array in JSON" << std::endl;
+        return false;
+    }
+
+    // Walk the top-level objects of the models array
+    size_t pos = jsonContent.find('[', modelsStart);
+    int loaded = 0;
+    while (pos != std::string::npos && pos < jsonContent.length()) {
+        size_t modelStart = jsonContent.find_first_of("{]", pos);
+        if (modelStart == std::string::npos || jsonContent[modelStart] == ']') break;
+
+        int braceCount = 1;
+        pos = modelStart + 1;
+        while (pos < jsonContent.length() && braceCount > 0) {
+            if (jsonContent[pos] == '{') braceCount++;
+            else if (jsonContent[pos] == '}') braceCount--;
+            pos++;
+        }
+
+        if (ParseModel(jsonContent.substr(modelStart, pos - modelStart))) {
+            loaded++;
+        }
+    }
+
+    std::cout << "Loaded " << loaded << " block models" << std::endl;
+    return loaded > 0;
+}
@@ -0,0 +1,374 @@
+#include "../include/block_registry.h"
+#include "../include/voxel.h"
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+BlockRegistry BlockRegistry::instance;
+
+BlockRegistry::BlockRegistry() : blocks(BLOCK_ID_LIMIT), idLimit(0) {
+    memset(flags, 0, sizeof(flags));
+    memset(lightLevel, 0, sizeof(lightLevel));
+    memset(hardness, 0, sizeof(hardness));
+    memset(tint, 0, sizeof(tint));
+    memset(faceTexture, 0, sizeof(faceTexture));
+    memset(model, 0, sizeof(model));
+    memset(faceShape, 0, sizeof(faceShape));
+
+    // Texture 0 is the fallback for faces without one
+    InternTexture("stone");
+    RegisterFallback();
+}
+
+void BlockRegistry::RegisterFallback() {
+    // Just enough for a world to exist without blocks.json; everything else is data
+    auto makeBlock = [](int id, const char* name, bool solid) {
+        BlockData block;
+        block.id = id;
+        block.name = name;
+        block.displayName = name;
+        block.transparent = !solid;
+        block.liquid = false;
+        block.solid = solid;
+        block.cutout = false;
+        block.flammable = false;
+        block.breakable = solid;
+        block.emitsLight = false;
+        block.hardness = solid ? 1.5f : 0.0f;
+        block.lightLevel = 0;
+        block.allTexture = "stone";
+        block.tintColor = WHITE;
+        return block;
+    };
+    Register(makeBlock(VOXEL_AIR, "air", false));
+    Register(makeBlock(VOXEL_STONE, "stone", true));
+}
+
+bool BlockRegistry::LoadModels(const std::string& jsonFilePath) {
+    bool loaded = models.LoadFromJson(jsonFilePath);
+    for (int id = 0; id < idLimit; id++) {
+        if (IsDefined(id)) UpdateTables(id);
+    }
+    return loaded;
+}
+
+bool BlockRegistry::LoadFromJson(const std::string& jsonFilePath) {
+    std::cout << "Attempting to load block data from: " << jsonFilePath << std::endl;
+    
+    std::ifstream file(jsonFilePath);
+    if (!file.is_open()) {
+        std::cout << "Failed to open blocks.json file: " << jsonFilePath << " (only air and stone are defined)" << std::endl;
+        return false;
+    }
+    
+    // Read the entire file
+    std::string jsonContent((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+    file.close();
+    
+    std::cout << "JSON file size: " << jsonContent.size() << " bytes" << std::endl;
+    
+    // Simple JSON parsing for our specific structure
+    try {
+        // Find the blocks array
+        size_t blocksStart = jsonContent.find("\"blocks\":");
+        if (blocksStart == std::string::npos) {
+            std::cout << "Could not find 'blocks' array in JSON" << std::endl;
+            return false;
+        }
+        
+        // Find the opening bracket of the blocks array
+        size_t arrayStart = jsonContent.find('[', blocksStart);
+        if (arrayStart == std::string::npos) {
+            std::cout << "Could not find opening bracket for blocks array" << std::endl;
+            return false;
+        }
+        
+        // Parse each block object
+        size_t pos = arrayStart + 1;
+        int blockCount = 0;
+        
+        while (pos < jsonContent.length()) {
+            // Skip whitespace
+            while (pos < jsonContent.length() && (jsonContent[pos] == ' ' || jsonContent[pos] == '\n' || jsonContent[pos] == '\t' || jsonContent[pos] == '\r')) {
+                pos++;
+            }
+            
+            // Check if we've reached the end of the array
+            if (pos >= jsonContent.length() || jsonContent[pos] == ']') {
+                break;
+            }
+            
+            // Find the start of the next block object
+            if (jsonContent[pos] == '{') {
+                // Find the end of this block object
+                size_t blockStart = pos;
+                int braceCount = 1;
+                pos++;
+                
+                while (pos < jsonContent.length() && braceCount > 0) {
+                    if (jsonContent[pos] == '{') braceCount++;
+                    else if (jsonContent[pos] == '}') braceCount--;
+                    pos++;
+                }
+                
+                // Extract the block JSON string
+                std::string blockJson = jsonContent.substr(blockStart, pos - blockStart);
+                
+                // Parse this block
+                BlockData block = ParseBlockJson(blockJson);
+                if (!block.name.empty()) { // Valid block
+                    int id = Register(block);
+                    if (id >= 0) {
+                        blockCount++;
+                        std::cout << "Loaded block: " << block.name << " (ID: " << id << ")" << std::endl;
+                    }
+                }
+            }
+            
+            // Skip comma and whitespace
+            while (pos < jsonContent.length() && (jsonContent[pos] == ',' || jsonContent[pos] == ' ' || jsonContent[pos] == '\n' || jsonContent[pos] == '\t' || jsonContent[pos] == '\r')) {
+                pos++;
+            }
+        }
+        
+        std::cout << "Successfully loaded " << blockCount << " blocks from JSON" << std::endl;
+        return blockCount > 0;
+        
+    } catch (const std::exception& e) {
+        std::cout << "JSON parsing error: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+BlockData BlockRegistry::ParseBlockJson(const std::string& blockJson) {
+    BlockData block;
+    block.id = -1; // Invalid by default
+    
+    try {
+        // Helper function to extract string value
+        auto extractString = [&](const std::string& key) -> std::string {
+            std::string search = "\"" + key + "\":";
+            size_t keyPos = blockJson.find(search);
+            if (keyPos == std::string::npos) return "";
+            
+            size_t valueStart = blockJson.find("\"", keyPos + search.length());
+            if (valueStart == std::string::npos) return "";
+            valueStart++;
+            
+            size_t valueEnd = blockJson.find("\"", valueStart);
+            if (valueEnd == std::string::npos) return "";
+            
+            return blockJson.substr(valueStart, valueEnd - valueStart);
+        };
+        
+        // Helper function to extract integer value
+        auto extractInt = [&](const std::string& key) -> int {
+            std::string search = "\"" + key + "\":";
+            size_t keyPos = blockJson.find(search);
+            if (keyPos == std::string::npos) return 0;
+            
+            size_t valueStart = keyPos + search.length();
+            while (valueStart < blockJson.length() && (blockJson[valueStart] == ' ' || blockJson[valueStart] == '\t')) {
+                valueStart++;
+            }
+            
+            size_t valueEnd = valueStart;
+            while (valueEnd < blockJson.length() && (std::isdigit(blockJson[valueEnd]) || blockJson[valueEnd] == '-' || blockJson[valueEnd] == '.')) {
+                valueEnd++;
+            }
+            
+            if (valueEnd > valueStart) {
+                return std::stoi(blockJson.substr(valueStart, valueEnd - valueStart));
+            }
+            return 0;
+        };
+        
+        // Helper function to extract boolean value
+        auto extractBool = [&](const std::string& key) -> bool {
+            std::string search = "\"" + key + "\":";
+            size_t keyPos = blockJson.find(search);
+            if (keyPos == std::string::npos) return false;
+            
+            size_t valueStart = keyPos + search.length();
+            while (valueStart < blockJson.length() && (blockJson[valueStart] == ' ' || blockJson[valueStart] == '\t')) {
+                valueStart++;
+            }
+            
+            return blockJson.substr(valueStart, 4) == "true";
+        };
+        
+        // Helper function to extract float value
+        auto extractFloat = [&](const std::string& key) -> float {
+            std::string search = "\"" + key + "\":";
+            size_t keyPos = blockJson.find(search);
+            if (keyPos == std::string::npos) return 0.0f;
+            
+            size_t valueStart = keyPos + search.length();
+            while (valueStart < blockJson.length() && (blockJson[valueStart] == ' ' || blockJson[valueStart] == '\t')) {
+                valueStart++;
+            }
+            
+            size_t valueEnd = valueStart;
+            while (valueEnd < blockJson.length() && (std::isdigit(blockJson[valueEnd]) || blockJson[valueEnd] == '-' || blockJson[valueEnd] == '.')) {
+                valueEnd++;
+            }
+            
+            if (valueEnd > valueStart) {
+                return std::stof(blockJson.substr(valueStart, valueEnd - valueStart));
+            }
+            return 0.0f;
+        };
+        
+        // Parse basic properties; blocks without an id get the next free one
+        block.id = blockJson.find("\"id\":") != std::string::npos ? extractInt("id") : -1;
+        block.name = extractString("name");
+        block.displayName = extractString("displayName");
+        block.transparent = extractBool("transparent");
+        block.liquid = extractBool("liquid");
+        block.solid = blockJson.find("\"solid\":") != std::string::npos ? extractBool("solid") : !block.liquid;
+        block.flammable = extractBool("flammable");
+        block.breakable = extractBool("breakable");
+        block.emitsLight = extractBool("emitsLight");
+        block.hardness = extractFloat("hardness");
+        block.lightLevel = extractInt("lightLevel");
+        block.soundGroup = extractString("soundGroup");
+        block.toolRequired = extractString("toolRequired");
+        block.model = extractString("model");
+        block.cutout = extractBool("cutout");
+        
+        // Parse textures object
+        size_t texturesStart = blockJson.find("\"textures\":");
+        if (texturesStart != std::string::npos) {
+            size_t objStart = blockJson.find('{', texturesStart);
+            if (objStart != std::string::npos) {
+                size_t objEnd = blockJson.find('}', objStart);
+                if (objEnd != std::string::npos) {
+                    std::string texturesJson = blockJson.substr(objStart + 1, objEnd - objStart - 1);
+                    
+                    // Extract texture values
+                    auto extractTextureValue = [&](const std::string& texKey) -> std::string {
+                        std::string search = "\"" + texKey + "\":";
+                        size_t keyPos = texturesJson.find(search);
+                        if (keyPos == std::string::npos) return "";
+                        
+                        size_t valueStart = texturesJson.find("\"", keyPos + search.length());
+                        if (valueStart == std::string::npos) return "";
+                        valueStart++;
+                        
+                        size_t valueEnd = texturesJson.find("\"", valueStart);
+                        if (valueEnd == std::string::npos) return "";
+                        
+                        return texturesJson.substr(valueStart, valueEnd - valueStart);
+                    };
+                    
+                    block.allTexture = extractTextureValue("all");
+                    block.topTexture = extractTextureValue("top");
+                    block.bottomTexture = extractTextureValue("bottom");
+                    block.sideTexture = extractTextureValue("side");
+                }
+            }
+        }
+        
+        // Parse tint color (simple approach - just set to white for now)
+        block.tintColor = {255, 255, 255, 255};
+        
+    } catch (const std::exception& e) {
+        std::cout << "Error parsing block JSON: " << e.what() << std::endl;
+        block.name.clear(); // Mark as invalid
+    }
+    
+    return block;
+}
+
+int BlockRegistry::InternTexture(const std::string& name) {
+    auto it = textureIds.find(name);
+    if (it != textureIds.end()) return it->second;
+
+    int textureId = (int)textureNames.size();
+    textureNames.push_back(name);
+    textureIds[name] = textureId;
+    return textureId;
+}
+
+int BlockRegistry::FindTexture(const std::string& name) const {
+    auto it = textureIds.find(name);
+    return it != textureIds.end() ? it->second : -1;
+}
+
+int BlockRegistry::FindBlock(const std::string& name) const {
+    auto it = idsByName.find(name);
+    return it != idsByName.end() ? it->second : -1;
+}
+
+int BlockRegistry::Register(const BlockData& block) {
+    int id = FindBlock(block.name);
+    if (id < 0 && block.id >= 0 && block.id < BLOCK_ID_LIMIT) {
+        id = block.id;
+    }
+    if (id < 0) {
+        // Lowest free id keeps the tables dense
+        for (int candidate = 0; candidate < BLOCK_ID_LIMIT && id < 0; candidate++) {
+            if (!IsDefined(candidate)) id = candidate;
+        }
+        if (id < 0) return -1;
+    }
+
+    // A block taking over an id drops the previous owner's name
+    if (IsDefined(id) && blocks[id].name != block.name) {
+        idsByName.erase(blocks[id].name);
+    }
+
+    blocks[id] = block;
+    blocks[id].id = id;
+    idsByName[block.name] = id;
+    if (id >= idLimit) idLimit = id + 1;
+
+    UpdateTables(id);
+    return id;
+}
+
+void BlockRegistry::UpdateTables(int id) {
+    const BlockData& block = blocks[id];
+    bool solid = block.solid && id != VOXEL_AIR;
+    
+    int modelId = block.model.empty() ? MODEL_CUBE : models.Find(block.model);
+    if (modelId < 0) modelId = MODEL_CUBE;  // models.json not loaded yet, or a typo
+    bool isCube = modelId == MODEL_CUBE;
+
+    uint8_t blockFlags = BLOCK_DEFINED;
+    if (solid) blockFlags |= BLOCK_SOLID;
+    if (solid && !block.transparent && isCube) blockFlags |= BLOCK_OPAQUE;
+    if (block.liquid) blockFlags |= BLOCK_LIQUID;
+    if (!solid && id != VOXEL_AIR) blockFlags |= BLOCK_SEE_THROUGH;
+    if (block.breakable && block.hardness >= 0.0f) blockFlags |= BLOCK_BREAKABLE;
+    if (block.flammable) blockFlags |= BLOCK_FLAMMABLE;
+    if (block.cutout) blockFlags |= BLOCK_CUTOUT;
+
+    flags[id] = blockFlags;
+    lightLevel[id] = (uint8_t)block.lightLevel;
+    hardness[id] = block.hardness;
+    tint[id] = block.tintColor;
+    model[id] = (uint8_t)modelId;
+    
+    // Air never hides its neighbors' faces
+    const BlockModel& blockModel = models.GetModel(modelId);
+    for (int face = 0; face < FACES; face++) {
+        faceShape[face][id] = id == VOXEL_AIR ? SHAPE_NONE : blockModel.faceShape[face];
+    }
+
+    // Same fallback order as the per-face JSON keys: specific face, then "all", then stone
+    auto faceTextureId = [this, &block](const std::string& specific) {
+        if (!specific.empty()) return InternTexture(specific);
+        if (!block.allTexture.empty()) return InternTexture(block.allTexture);
+        return 0;
+    };
+    faceTexture[FACE_TOP][id] = (uint16_t)faceTextureId(block.topTexture);
+    faceTexture[FACE_BOTTOM][id] = (uint16_t)faceTextureId(block.bottomTexture);
+    uint16_t side = (uint16_t)faceTextureId(block.sideTexture);
+    faceTexture[FACE_FRONT][id] = side;
+    faceTexture[FACE_BACK][id] = side;
+    faceTexture[FACE_RIGHT][id] = side;
+    faceTexture[FACE_LEFT][id] = side;
+}
@@ -0,0 +1,169 @@
+#include "../include/block_ticks.h"
+#include "../include/job_system.h"
+
+BlockTickScheduler::BlockTickScheduler(VoxelWorld* world)
+    : world(world), currentTick(0), listenerId(-1), processedLastTick(0) {
+    chunkTicks.resize(world->GetWidth() * world->GetDepth());
+
+    // Anything that changes can wake up itself and its neighbors
+    listenerId = world->AddEditListener([this](int, int, const std::vector<BlockEdit>& edits) {
+        OnChunkEdited(edits);
+    });
+}
+
+BlockTickScheduler::~BlockTickScheduler() {
+    world->RemoveEditListener(listenerId);
+}
+
+BlockTickScheduler::ChunkTicks* BlockTickScheduler::GetChunkTicks(int chunkX, int chunkZ) {
+    if (chunkX < 0 || chunkX >= world->GetWidth() || chunkZ < 0 || chunkZ >= world->GetDepth()) {
+        return nullptr;
+    }
+    return &chunkTicks[chunkX * world->GetDepth() + chunkZ];
+}
+
+bool BlockTickScheduler::IsScheduledType(VoxelType type) {
+    switch (type) {
+        case VOXEL_SAND:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int BlockTickScheduler::GetDelayForType(VoxelType type) {
+    switch (type) {
+        case VOXEL_SAND: return SAND_FALL_DELAY;
+        default: return 1;
+    }
+}
+
+void BlockTickScheduler::Schedule(int worldX, int worldY, int worldZ, int delay) {
+    if (worldY < 0 || worldY >= VoxelChunk::CHUNK_HEIGHT) return;
+
+    int chunkX, chunkZ, localX, localZ;
+    world->WorldToChunkCoords(worldX, worldZ, chunkX, chunkZ, localX, localZ);
+    ChunkTicks* ticks = GetChunkTicks(chunkX, chunkZ);
+    if (!ticks) return;
+
+    int cell = VoxelChunk::CellIndex(localX, worldY, localZ);
+    if (ticks->scheduled.test(cell)) return;
+    ticks->scheduled.set(cell);
+    ticks->pendingCount++;
+
+    if (delay < 1) delay = 1;
+    uint64_t dueTick = currentTick + (uint64_t)delay;
+    if (delay < WHEEL_SIZE) {
+        ticks->buckets[dueTick % WHEEL_SIZE].push_back((uint16_t)cell);
+    } else {
+        ticks->overflow.push_back({dueTick, (uint16_t)cell});
+    }
+}
+
+void BlockTickScheduler::PromoteOverflow(ChunkTicks& ticks) {
+    size_t kept = 0;
+    for (size_t i = 0; i < ticks.overflow.size(); i++) {
+        const OverflowEntry& entry = ticks.overflow[i];
+        if (entry.tick - currentTick < (uint64_t)WHEEL_SIZE) {
+            ticks.buckets[entry.tick % WHEEL_SIZE].push_back(entry.cell);
+        } else {
+            ticks.overflow[kept++] = entry;
+        }
+    }
+    ticks.overflow.resize(kept);
+}
+
+void BlockTickScheduler::ProcessCell(int chunkX, int chunkZ, int cell, std::vector<BlockEdit>& edits) const {
+    int localX, y, localZ;
+    VoxelChunk::CellCoords(cell, localX, y, localZ);
+    int x = chunkX * VoxelChunk::CHUNK_SIZE + localX;
+    int z = chunkZ * VoxelChunk::CHUNK_SIZE + localZ;
+
+    // The cell may have changed since it was scheduled
+    VoxelType type = world->GetVoxel(x, y, z).type;
+
+    switch (type) {
+        case VOXEL_SAND:
+            // Gravity: fall one cell per update while unsupported
+            if (y > 0 && !world->IsSolid(x, y - 1, z)) {
+                edits.emplace_back(x, y, z, VOXEL_AIR);
+                edits.emplace_back(x, y - 1, z, VOXEL_SAND);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void BlockTickScheduler::OnChunkEdited(const std::vector<BlockEdit>& edits) {
+    static const int offsets[7][3] = {
+        {0, 0, 0}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+    };
+
+    for (const BlockEdit& edit : edits) {
+        for (int i = 0; i < 7; i++) {
+            int x = edit.x + offsets[i][0];
+            int y = edit.y + offsets[i][1];
+            int z = edit.z + offsets[i][2];
+            VoxelType type = world->GetVoxel(x, y, z).type;
+            if (IsScheduledType(type)) {
+                Schedule(x, y, z, GetDelayForType(type));
+            }
+        }
+    }
+}
+
+void BlockTickScheduler::Tick() {
+    int slot = (int)(currentTick % WHEEL_SIZE);
+    int depth = world->GetDepth();
+
+    // Find chunks with updates due this tick. Workers hold the chunk and the neighbors
+    // its cells look at; updates in a chunk that isn't loaded right now wait a tick.
+    std::vector<int> dueChunks;
+    std::vector<ChunkHandle> held;
+    for (int i = 0; i < (int)chunkTicks.size(); i++) {
+        ChunkTicks& ticks = chunkTicks[i];
+        if (!ticks.overflow.empty()) {
+            PromoteOverflow(ticks);
+        }
+        if (ticks.buckets[slot].empty()) continue;
+        if (world->AcquireChunkArea(i / depth, i % depth, held)) {
+            dueChunks.push_back(i);
+        } else {
+            std::vector<uint16_t>& next = ticks.buckets[(slot + 1) % WHEEL_SIZE];
+            next.insert(next.end(), ticks.buckets[slot].begin(), ticks.buckets[slot].end());
+            ticks.buckets[slot].clear();
+        }
+    }
+
+    // Process each chunk's batch in parallel; edits are only collected here
+    std::vector<std::vector<BlockEdit>> chunkEdits(dueChunks.size());
+    std::vector<int> chunkProcessed(dueChunks.size(), 0);
+
+    JobSystem::Get().ParallelFor((int)dueChunks.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int index = dueChunks[i];
+            ChunkTicks& ticks = chunkTicks[index];
+
+            std::vector<uint16_t>& due = ticks.buckets[slot];
+            for (uint16_t cell : due) {
+                ticks.scheduled.reset(cell);
+                ProcessCell(index / depth, index % depth, cell, chunkEdits[i]);
+            }
+            ticks.pendingCount -= (int)due.size();
+            chunkProcessed[i] = (int)due.size();
+            due.clear();
+        }
+    });
+
+    // Apply everything as one batch so each chunk is remeshed once
+    std::vector<BlockEdit> edits;
+    processedLastTick = 0;
+    for (size_t i = 0; i < chunkEdits.size(); i++) {
+        edits.insert(edits.end(), chunkEdits[i].begin(), chunkEdits[i].end());
+        processedLastTick += chunkProcessed[i];
+    }
+    world->ApplyEdits(edits);
+
+    currentTick++;
+}
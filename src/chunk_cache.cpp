@@ -0,0 +1,162 @@
+#include "../include/chunk_cache.h"
+#include "../include/chunk_codec.h"
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sys/stat.h>
+
+namespace {
+    // mkdir -p
+    bool MakeDirectories(const std::string& path) {
+        for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+            std::string prefix = path.substr(0, slash);
+            if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) return false;
+            if (slash == std::string::npos) return true;
+        }
+    }
+
+    void WriteU32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+
+    uint32_t ReadU32(const uint8_t* data) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= (uint32_t)data[i] << (i * 8);
+        }
+        return value;
+    }
+
+    bool ReadFile(const std::string& path, std::vector<uint8_t>& data) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // Written beside the target and renamed over it, so a crash never leaves half a file
+    bool WriteFile(const std::string& path, const std::vector<uint8_t>& data) {
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write((const char*)data.data(), data.size());
+            if (!file) return false;
+        }
+        return std::rename(temporary.c_str(), path.c_str()) == 0;
+    }
+}
+
+bool ChunkCache::Open(const std::string& cacheDirectory) {
+    SaveIndex();
+    directory.clear();
+    entries.clear();
+    references.clear();
+    indexDirty = false;
+
+    if (cacheDirectory.empty() || !MakeDirectories(cacheDirectory)) {
+        std::cout << "Could not create chunk cache directory " << cacheDirectory << std::endl;
+        return false;
+    }
+    directory = cacheDirectory;
+
+    // A missing or unreadable index just means an empty cache
+    std::vector<uint8_t> data;
+    if (!ReadFile(directory + "/index.bin", data) || data.size() < 12) return true;
+    if (ReadU32(data.data()) != INDEX_MAGIC || ReadU32(data.data() + 4) != INDEX_VERSION) return true;
+
+    uint32_t count = ReadU32(data.data() + 8);
+    if (count > (data.size() - 12) / 16) return true;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* entry = data.data() + 12 + i * 16;
+        int chunkX = (int)ReadU32(entry);
+        int chunkZ = (int)ReadU32(entry + 4);
+        uint64_t hash = ReadU32(entry + 8) | ((uint64_t)ReadU32(entry + 12) << 32);
+        entries[{chunkX, chunkZ}] = hash;
+        references[hash]++;
+    }
+    return true;
+}
+
+std::string ChunkCache::GetChunkPath(uint64_t hash) const {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.chunk", (unsigned long long)hash);
+    return directory + name;
+}
+
+void ChunkCache::Release(uint64_t hash) {
+    auto reference = references.find(hash);
+    if (reference == references.end()) return;
+    if (--reference->second == 0) {
+        references.erase(reference);
+        std::remove(GetChunkPath(hash).c_str());
+    }
+}
+
+uint64_t ChunkCache::Store(int chunkX, int chunkZ, const Voxel* cells) {
+    uint64_t hash = ChunkCodec::Hash(cells);
+    if (!IsOpen()) return hash;
+
+    uint64_t& entry = entries[{chunkX, chunkZ}];
+    if (entry == hash) return hash;
+
+    // Content-addressed, so an existing file already holds these cells
+    if (references[hash]++ == 0) {
+        std::vector<uint8_t> encoded;
+        ChunkCodec::Encode(cells, encoded);
+        if (!WriteFile(GetChunkPath(hash), encoded)) {
+            references.erase(hash);
+            Release(entry);
+            entries.erase({chunkX, chunkZ});
+            indexDirty = true;
+            return hash;
+        }
+    }
+
+    if (entry != 0) Release(entry);
+    entry = hash;
+    indexDirty = true;
+    return hash;
+}
+
+bool ChunkCache::Load(int chunkX, int chunkZ, Voxel* cells) {
+    auto entry = entries.find({chunkX, chunkZ});
+    if (entry == entries.end()) return false;
+
+    std::vector<uint8_t> encoded;
+    if (ReadFile(GetChunkPath(entry->second), encoded) &&
+        ChunkCodec::Decode(encoded.data(), encoded.size(), cells) &&
+        ChunkCodec::Hash(cells) == entry->second) {
+        return true;
+    }
+
+    Release(entry->second);
+    entries.erase(entry);
+    indexDirty = true;
+    return false;
+}
+
+void ChunkCache::SaveIndex() {
+    if (!IsOpen() || !indexDirty) return;
+
+    std::vector<uint8_t> data;
+    data.reserve(12 + entries.size() * 16);
+    WriteU32(data, INDEX_MAGIC);
+    WriteU32(data, INDEX_VERSION);
+    WriteU32(data, (uint32_t)entries.size());
+    for (const auto& entry : entries) {
+        WriteU32(data, (uint32_t)entry.first.first);
+        WriteU32(data, (uint32_t)entry.first.second);
+        WriteU32(data, (uint32_t)entry.second);
+        WriteU32(data, (uint32_t)(entry.second >> 32));
+    }
+    if (WriteFile(directory + "/index.bin", data)) {
+        indexDirty = false;
+    } else {
+        std::cout << "Could not save chunk cache index in " << directory << std::endl;
+    }
+}
@@ -0,0 +1,261 @@
+#include "../include/chunk_codec.h"
+
+namespace {
+    enum EncodingMode : uint8_t {
+        MODE_UNIFORM = 0,  // One palette entry, no indices
+        MODE_RUNS,         // (run length, palette index) varint pairs
+        MODE_PACKED        // Fixed-width indices, LSB first
+    };
+
+    const int PALETTE_KEYS = 1 << 16;  // type | metadata << 8
+
+    uint16_t PaletteKey(const Voxel& voxel) {
+        return (uint16_t)((uint8_t)voxel.type | (voxel.metadata << 8));
+    }
+
+    void WriteVarint(std::vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    bool ReadVarint(const uint8_t* data, size_t size, size_t& position, uint32_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (position >= size) return false;
+            uint8_t byte = data[position++];
+            value |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    void WriteU64(std::vector<uint8_t>& out, uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            out.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+
+    uint64_t ReadU64(const uint8_t* data) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) {
+            value |= (uint64_t)data[i] << (i * 8);
+        }
+        return value;
+    }
+
+    int BitsForPalette(size_t paletteSize) {
+        int bits = 1;
+        while (((size_t)1 << bits) < paletteSize) bits++;
+        return bits;
+    }
+}
+
+void ChunkCodec::Encode(const Voxel* cells, std::vector<uint8_t>& out) {
+    // Key -> palette slot. Only the slots this call used are reset afterwards.
+    thread_local std::vector<int> slots(PALETTE_KEYS, -1);
+    std::vector<uint16_t> palette;
+    std::vector<uint16_t> indices(VoxelChunk::CHUNK_VOLUME);
+
+    for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+        uint16_t key = PaletteKey(cells[cell]);
+        if (slots[key] < 0) {
+            slots[key] = (int)palette.size();
+            palette.push_back(key);
+        }
+        indices[cell] = (uint16_t)slots[key];
+    }
+    for (uint16_t key : palette) {
+        slots[key] = -1;
+    }
+
+    std::vector<uint8_t> runs;
+    if (palette.size() > 1) {
+        for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME;) {
+            int runEnd = cell + 1;
+            while (runEnd < VoxelChunk::CHUNK_VOLUME && indices[runEnd] == indices[cell]) runEnd++;
+            WriteVarint(runs, (uint32_t)(runEnd - cell));
+            WriteVarint(runs, indices[cell]);
+            cell = runEnd;
+        }
+    }
+
+    int bits = BitsForPalette(palette.size());
+    size_t packedSize = ((size_t)VoxelChunk::CHUNK_VOLUME * bits + 7) / 8;
+    EncodingMode mode = palette.size() == 1 ? MODE_UNIFORM : runs.size() <= packedSize ? MODE_RUNS : MODE_PACKED;
+
+    out.push_back(mode);
+    WriteVarint(out, (uint32_t)palette.size());
+    for (uint16_t key : palette) {
+        out.push_back((uint8_t)key);
+        out.push_back((uint8_t)(key >> 8));
+    }
+
+    if (mode == MODE_RUNS) {
+        out.insert(out.end(), runs.begin(), runs.end());
+    } else if (mode == MODE_PACKED) {
+        size_t start = out.size();
+        out.resize(start + packedSize, 0);
+        for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+            size_t bit = (size_t)cell * bits;
+            for (int i = 0; i < bits; i++, bit++) {
+                if (indices[cell] & (1 << i)) out[start + bit / 8] |= (uint8_t)(1 << (bit % 8));
+            }
+        }
+    }
+}
+
+void ChunkCodec::Encode(const VoxelChunk& chunk, std::vector<uint8_t>& out) {
+    std::vector<Voxel> cells(VoxelChunk::CHUNK_VOLUME);
+    for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+        int x, y, z;
+        VoxelChunk::CellCoords(cell, x, y, z);
+        cells[cell] = chunk.GetVoxel(x, y, z);
+    }
+    Encode(cells.data(), out);
+}
+
+uint64_t ChunkCodec::Hash(const Voxel* cells) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+        hash = (hash ^ (uint8_t)cells[cell].type) * 0x100000001b3ULL;
+        hash = (hash ^ cells[cell].metadata) * 0x100000001b3ULL;
+    }
+    return hash ? hash : 1;  // 0 means "no hash" to callers
+}
+
+uint64_t ChunkCodec::Hash(const VoxelChunk& chunk) {
+    std::vector<Voxel> cells(VoxelChunk::CHUNK_VOLUME);
+    for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+        int x, y, z;
+        VoxelChunk::CellCoords(cell, x, y, z);
+        cells[cell] = chunk.GetVoxel(x, y, z);
+    }
+    return Hash(cells.data());
+}
+
+bool ChunkCodec::Decode(const uint8_t* data, size_t size, Voxel* cells) {
+    size_t position = 0;
+    if (size < 1) return false;
+    uint8_t mode = data[position++];
+
+    uint32_t paletteSize;
+    if (!ReadVarint(data, size, position, paletteSize)) return false;
+    if (paletteSize == 0 || paletteSize > VoxelChunk::CHUNK_VOLUME || size - position < paletteSize * 2) return false;
+
+    const BlockRegistry& registry = BlockRegistry::Get();
+    std::vector<Voxel> palette(paletteSize);
+    for (uint32_t i = 0; i < paletteSize; i++) {
+        int type = data[position++];
+        uint8_t metadata = data[position++];
+        if (!registry.IsDefined(type)) type = VOXEL_AIR;  // Block unknown on this side
+        palette[i] = Voxel((VoxelType)type, metadata);
+    }
+
+    if (mode == MODE_UNIFORM) {
+        for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+            cells[cell] = palette[0];
+        }
+        return true;
+    }
+
+    if (mode == MODE_RUNS) {
+        int cell = 0;
+        while (cell < VoxelChunk::CHUNK_VOLUME) {
+            uint32_t length, index;
+            if (!ReadVarint(data, size, position, length) || !ReadVarint(data, size, position, index)) return false;
+            if (length == 0 || length > (uint32_t)(VoxelChunk::CHUNK_VOLUME - cell) || index >= paletteSize) return false;
+            for (uint32_t i = 0; i < length; i++) {
+                cells[cell++] = palette[index];
+            }
+        }
+        return true;
+    }
+
+    if (mode == MODE_PACKED) {
+        int bits = BitsForPalette(paletteSize);
+        size_t packedSize = ((size_t)VoxelChunk::CHUNK_VOLUME * bits + 7) / 8;
+        if (size - position < packedSize) return false;
+
+        const uint8_t* packed = data + position;
+        for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+            uint32_t index = 0;
+            size_t bit = (size_t)cell * bits;
+            for (int i = 0; i < bits; i++, bit++) {
+                if (packed[bit / 8] & (1 << (bit % 8))) index |= 1u << i;
+            }
+            if (index >= paletteSize) return false;
+            cells[cell] = palette[index];
+        }
+        return true;
+    }
+
+    return false;
+}
+
+size_t ChunkCodec::GetDeltaSize(const CellMask& changed) {
+    size_t groups = 0;
+    for (int group = 0; group < GROUP_COUNT; group++) {
+        for (int i = 0; i < GROUP_SIZE; i++) {
+            if (changed[group * GROUP_SIZE + i]) {
+                groups++;
+                break;
+            }
+        }
+    }
+    return 8 + groups * 8 + changed.count() * 2;
+}
+
+void ChunkCodec::EncodeDelta(const VoxelChunk& chunk, const CellMask& changed, std::vector<uint8_t>& out) {
+    uint64_t groupMasks[GROUP_COUNT];
+    uint64_t dirtyGroups = 0;
+    for (int group = 0; group < GROUP_COUNT; group++) {
+        groupMasks[group] = 0;
+        for (int i = 0; i < GROUP_SIZE; i++) {
+            if (changed[group * GROUP_SIZE + i]) groupMasks[group] |= (uint64_t)1 << i;
+        }
+        if (groupMasks[group]) dirtyGroups |= (uint64_t)1 << group;
+    }
+
+    WriteU64(out, dirtyGroups);
+    for (int group = 0; group < GROUP_COUNT; group++) {
+        if (groupMasks[group]) WriteU64(out, groupMasks[group]);
+    }
+    for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+        if (!changed[cell]) continue;
+        int x, y, z;
+        VoxelChunk::CellCoords(cell, x, y, z);
+        Voxel voxel = chunk.GetVoxel(x, y, z);
+        out.push_back((uint8_t)voxel.type);
+        out.push_back(voxel.metadata);
+    }
+}
+
+size_t ChunkCodec::DecodeDelta(const uint8_t* data, size_t size, std::vector<std::pair<int, Voxel>>& changes) {
+    if (size < 8) return 0;
+    uint64_t dirtyGroups = ReadU64(data);
+    size_t position = 8;
+
+    std::vector<int> cells;
+    for (int group = 0; group < GROUP_COUNT; group++) {
+        if (!(dirtyGroups & ((uint64_t)1 << group))) continue;
+        if (size - position < 8) return 0;
+        uint64_t mask = ReadU64(data + position);
+        position += 8;
+        for (int i = 0; i < GROUP_SIZE; i++) {
+            if (mask & ((uint64_t)1 << i)) cells.push_back(group * GROUP_SIZE + i);
+        }
+    }
+
+    if (size - position < cells.size() * 2) return 0;
+    const BlockRegistry& registry = BlockRegistry::Get();
+    for (int cell : cells) {
+        int type = data[position++];
+        uint8_t metadata = data[position++];
+        if (!registry.IsDefined(type)) type = VOXEL_AIR;
+        changes.emplace_back(cell, Voxel((VoxelType)type, metadata));
+    }
+    return position;
+}
@@ -0,0 +1,794 @@
+#include "../include/chunk_mesh.h"
+#include "../include/voxel.h"
+#include "../include/texture_manager.h"
+#include "../include/job_system.h"
+#include "rlgl.h"
+#include <cmath>
+
+// Meshing and drawing of VoxelChunk and VoxelWorld, kept apart from the simulation in
+// voxel.cpp so that a headless server builds without this file, raylib or a GL context.
+
+// Frees the CPU-side arrays of a mesh that was never uploaded
+static void FreeMeshData(Mesh& mesh) {
+    RL_FREE(mesh.vertices);
+    RL_FREE(mesh.normals);
+    RL_FREE(mesh.texcoords);
+    RL_FREE(mesh.colors);
+    mesh = Mesh{0};
+}
+
+// Alpha-tested fragment shader for foliage; the vertex stage is raylib's default
+static const char* CUTOUT_FRAGMENT_SHADER = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+out vec4 finalColor;
+void main() {
+    vec4 texel = texture(texture0, fragTexCoord) * colDiffuse * fragColor;
+    if (texel.a < 0.5) discard;
+    finalColor = texel;
+}
+)";
+
+// Camera frustum planes (a, b, c, d), inside where ax + by + cz + d >= 0, read from rlgl's
+// current matrices - only meaningful between BeginMode3D and EndMode3D
+static void GetViewFrustum(Vector4 planes[6]) {
+    Matrix m = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    Vector4 rows[4] = {
+        {m.m0, m.m4, m.m8, m.m12}, {m.m1, m.m5, m.m9, m.m13},
+        {m.m2, m.m6, m.m10, m.m14}, {m.m3, m.m7, m.m11, m.m15}
+    };
+    for (int axis = 0; axis < 3; axis++) {
+        const Vector4& w = rows[3];
+        const Vector4& r = rows[axis];
+        planes[axis * 2] = {w.x + r.x, w.y + r.y, w.z + r.z, w.w + r.w};
+        planes[axis * 2 + 1] = {w.x - r.x, w.y - r.y, w.z - r.z, w.w - r.w};
+    }
+}
+
+// Whether a chunk's column overlaps the frustum; tests each plane against the box's
+// corner furthest along its normal
+static bool ChunkInView(const Vector4 planes[6], Vector3 chunkPosition) {
+    Vector3 min = {chunkPosition.x - 0.5f, chunkPosition.y - 0.5f, chunkPosition.z - 0.5f};
+    Vector3 max = {min.x + VoxelChunk::CHUNK_SIZE, min.y + VoxelChunk::CHUNK_HEIGHT, min.z + VoxelChunk::CHUNK_SIZE};
+    for (int i = 0; i < 6; i++) {
+        const Vector4& p = planes[i];
+        float x = p.x >= 0.0f ? max.x : min.x;
+        float y = p.y >= 0.0f ? max.y : min.y;
+        float z = p.z >= 0.0f ? max.z : min.z;
+        if (p.x * x + p.y * y + p.z * z + p.w < 0.0f) return false;
+    }
+    return true;
+}
+
+ChunkMeshes::~ChunkMeshes() {
+    for (auto* meshes : {&solid, &foliage}) {
+        for (auto& pair : *meshes) {
+            if (pair.second.isGenerated) {
+                UnloadMesh(pair.second.mesh);
+                UnloadMaterial(pair.second.material);
+            } else {
+                FreeMeshData(pair.second.mesh);
+            }
+        }
+    }
+}
+
+void ChunkMeshes::Upload(const TextureManager* textureManager) {
+    for (auto* meshes : {&solid, &foliage}) {
+        for (auto& pair : *meshes) {
+            MaterialMesh& matMesh = pair.second;
+            if (matMesh.isGenerated) continue;
+            
+            // Upload mesh to GPU
+            UploadMesh(&matMesh.mesh, false);
+            matMesh.isGenerated = true;
+            
+            // Set up material with appropriate texture
+            matMesh.material = LoadMaterialDefault();
+            if (textureManager && textureManager->HasTexture(matMesh.textureName)) {
+                matMesh.material.maps[MATERIAL_MAP_DIFFUSE].texture = textureManager->GetTexture(matMesh.textureName);
+            }
+        }
+    }
+}
+
+size_t ChunkMeshes::GetVertexCount() const {
+    size_t vertices = 0;
+    for (const auto* meshes : {&solid, &foliage}) {
+        for (const auto& pair : *meshes) {
+            vertices += (size_t)pair.second.mesh.vertexCount;
+        }
+    }
+    return vertices;
+}
+
+void VoxelChunk::GenerateMesh(VoxelWorld* world, TextureManager* textureManager) {
+    if (!meshNeedsUpdate) return;
+    
+    BuildMesh(world);
+    UploadPendingMesh(textureManager);
+}
+
+void VoxelChunk::BuildMesh(const VoxelWorld* world) {
+    // A rebuild before the previous result was uploaded replaces it
+    pendingMeshes = std::make_shared<ChunkMeshes>();
+    
+    // Use greedy meshing for optimization; pure air has nothing to mesh
+    if (LoadVoxels()) {
+        GenerateGreedyMesh(world);
+    }
+    
+    meshNeedsUpdate = false;
+    meshEvicted = false;
+    TransitionState(CHUNK_LIT, CHUNK_MESHED);
+}
+
+void VoxelChunk::UploadPendingMesh(const TextureManager* textureManager) {
+    if (!pendingMeshes) return;
+    
+    // The previous meshes are unloaded as they're replaced
+    pendingMeshes->Upload(textureManager);
+    meshes = std::move(pendingMeshes);
+    
+    meshBytes = meshes->GetVertexCount() * MESH_VERTEX_BYTES;
+    lastMeshBytes = meshBytes;
+    TransitionState(CHUNK_MESHED, CHUNK_VISIBLE);
+}
+
+void VoxelChunk::Draw() {
+    if (!meshes) return;
+    
+    for (const auto& pair : meshes->solid) {
+        const MaterialMesh& matMesh = pair.second;
+        if (matMesh.isGenerated && matMesh.mesh.vertexCount > 0) {
+            DrawMesh(matMesh.mesh, matMesh.material, MatrixIdentity());
+        }
+    }
+}
+
+void VoxelChunk::DrawFoliage(Shader cutoutShader) {
+    if (!meshes) return;
+    
+    for (const auto& pair : meshes->foliage) {
+        const MaterialMesh& matMesh = pair.second;
+        if (matMesh.isGenerated && matMesh.mesh.vertexCount > 0) {
+            // The shader is shared by every chunk, so only a copy of the material
+            // gets it; UnloadMaterial on the chunk's own would delete the program
+            Material material = matMesh.material;
+            material.shader = cutoutShader;
+            DrawMesh(matMesh.mesh, material, MatrixIdentity());
+        }
+    }
+}
+
+void VoxelWorld::Update() {
+    CollectUnloadedChunks();
+    
+    // Build meshes for dirty chunks in parallel; meshing only reads voxels. The jobs
+    // hold the chunk and the neighbors its border faces look into, so chunks still
+    // loading or on their way out are left alone.
+    std::vector<VoxelChunk*> dirty;
+    std::vector<ChunkHandle> held;
+    for (int x = 0; x < worldWidth; x++) {
+        for (int z = 0; z < worldDepth; z++) {
+            VoxelChunk* chunk = chunks[x][z];
+            chunk->TransitionState(CHUNK_GENERATED, CHUNK_LIT);
+            if (chunk->GetState() >= CHUNK_LIT && chunk->NeedsMeshUpdate() && AcquireChunkArea(x, z, held)) {
+                dirty.push_back(chunk);
+            }
+        }
+    }
+    
+    // Each build is a job and its upload a main-thread job that follows it, so while
+    // we wait here the main thread uploads finished chunks as the workers mesh the
+    // rest. Uploads are capped per frame; the ones over the cap stay pending.
+    JobSystem& jobs = JobSystem::Get();
+    std::unique_ptr<JobCounter[]> built(new JobCounter[dirty.size()]);
+    JobCounter uploaded;
+    int uploads = 0;
+    for (size_t i = 0; i < dirty.size(); i++) {
+        VoxelChunk* chunk = dirty[i];
+        jobs.Submit([this, chunk]() { chunk->BuildMesh(this); }, JOB_HIGH, &built[i]);
+        jobs.SubmitMainThreadAfter(built[i], [this, chunk, &uploads]() {
+            if (uploads < meshUploadBudget) {
+                chunk->UploadPendingMesh(textureManager);
+                uploads++;
+            }
+        }, &uploaded);
+    }
+    jobs.Wait(uploaded, JOB_HIGH);
+    
+    // Spare budget goes to meshes left pending on earlier frames, continuing
+    // round-robin so a big burst of rebuilds can't starve any chunk
+    int chunkCount = worldWidth * worldDepth;
+    for (int n = 0; n < chunkCount && uploads < meshUploadBudget; n++) {
+        int index = (uploadCursor + n) % chunkCount;
+        VoxelChunk* chunk = chunks[index / worldDepth][index % worldDepth];
+        if (chunk->HasPendingMesh() && chunk->GetState() != CHUNK_UNLOADING) {
+            chunk->UploadPendingMesh(textureManager);
+            uploads++;
+            uploadCursor = (index + 1) % chunkCount;
+        }
+    }
+}
+
+void VoxelWorld::Draw() {
+    float savedDistance = foliageDistance;
+    foliageDistance = INFINITY;
+    DrawChunks(Vector3{0.0f, 0.0f, 0.0f}, false);
+    foliageDistance = savedDistance;
+}
+
+void VoxelWorld::Draw(Vector3 viewPosition) {
+    DrawChunks(viewPosition, true);
+}
+
+void VoxelWorld::DrawChunks(Vector3 viewPosition, bool cullToView) {
+    Vector4 frustum[6];
+    if (cullToView) GetViewFrustum(frustum);
+    auto inView = [&](const VoxelChunk* chunk) {
+        return chunk->GetState() == CHUNK_VISIBLE && (!cullToView || ChunkInView(frustum, chunk->GetChunkPosition()));
+    };
+    
+    // Only chunks actually drawn count as seen, so MemoryBudget sheds what's behind the camera first
+    drawFrame++;
+    for (int x = 0; x < worldWidth; x++) {
+        for (int z = 0; z < worldDepth; z++) {
+            if (inView(chunks[x][z])) {
+                chunks[x][z]->Draw();
+                chunks[x][z]->MarkVisible(drawFrame);
+            }
+        }
+    }
+    
+    if (!cutoutShader) {
+        cutoutShader = std::shared_ptr<Shader>(new Shader(LoadShaderFromMemory(nullptr, CUTOUT_FRAGMENT_SHADER)),
+                                               [](Shader* shader) {
+            UnloadShader(*shader);
+            delete shader;
+        });
+    }
+    
+    // Foliage after the opaque pass; dense forests are skipped past the foliage distance
+    const float halfChunk = VoxelChunk::CHUNK_SIZE * 0.5f;
+    for (int x = 0; x < worldWidth; x++) {
+        for (int z = 0; z < worldDepth; z++) {
+            if (!inView(chunks[x][z])) continue;
+            Vector3 chunkPosition = chunks[x][z]->GetChunkPosition();
+            float dx = chunkPosition.x + halfChunk - viewPosition.x;
+            float dz = chunkPosition.z + halfChunk - viewPosition.z;
+            if (sqrtf(dx * dx + dz * dz) - halfChunk * 1.4142f > foliageDistance) continue;
+            chunks[x][z]->DrawFoliage(*cutoutShader);
+        }
+    }
+}
+
+// Greedy Meshing Implementation
+void VoxelChunk::GenerateGreedyMesh(const VoxelWorld* world) {
+    // Collect quads for each material, indexed by registry texture id
+    const BlockRegistry& registry = BlockRegistry::Get();
+    std::vector<std::vector<QuadMesh>> materialQuads(registry.GetTextureCount());
+    
+    // Process each face direction and each layer
+    for (int face = 0; face < FACE_COUNT; face++) {
+        FaceDirection faceDir = (FaceDirection)face;
+        
+        // For each face direction, process all layers
+        int maxLayer = GetMaxLayerForFace(faceDir);
+        for (int layer = 0; layer < maxLayer; layer++) {
+            FaceMask mask[CHUNK_SIZE][CHUNK_SIZE];
+            
+            // Extract face mask for this direction and layer
+            ExtractFaceMask(faceDir, layer, world, mask);
+            
+            // Generate quads using greedy meshing
+            std::vector<QuadMesh> quads;
+            GreedyMeshFace(faceDir, layer, mask, quads);
+            
+            // Group quads by texture
+            for (const auto& quad : quads) {
+                materialQuads[quad.textureId].push_back(quad);
+            }
+        }
+    }
+    
+    // Non-cube blocks skip the greedy pass and contribute their precompiled quads
+    std::vector<VertexBuffers> modelGeometry(materialQuads.size());
+    AddModelQuads(world, modelGeometry);
+    
+    // Convert quads to meshes for each material
+    for (int textureId = 0; textureId < (int)materialQuads.size(); textureId++) {
+        const std::string& textureName = registry.GetTextureName(textureId);
+        const std::vector<QuadMesh>& quads = materialQuads[textureId];
+        VertexBuffers& buffers = modelGeometry[textureId];
+        
+        if (quads.empty() && buffers.vertices.empty()) continue;
+        
+        std::vector<Vector3>& vertices = buffers.vertices;
+        std::vector<Vector3>& normals = buffers.normals;
+        std::vector<Vector2>& texcoords = buffers.texcoords;
+        std::vector<Color>& colors = buffers.colors;
+        
+        // Convert each quad to mesh data using original face logic
+        for (const auto& quad : quads) {
+            AddQuadToMesh(vertices, normals, texcoords, colors, quad);
+        }
+        
+        // Create material mesh; uploading happens later in UploadPendingMesh
+        FillMaterialMesh(pendingMeshes->solid[textureName], textureName, buffers);
+    }
+    
+    // Foliage goes into its own cutout meshes so it can be drawn (or skipped) separately
+    std::vector<VertexBuffers> foliageGeometry(materialQuads.size());
+    AddFoliageQuads(world, foliageGeometry);
+    for (int textureId = 0; textureId < (int)foliageGeometry.size(); textureId++) {
+        if (foliageGeometry[textureId].vertices.empty()) continue;
+        const std::string& textureName = registry.GetTextureName(textureId);
+        FillMaterialMesh(pendingMeshes->foliage[textureName], textureName, foliageGeometry[textureId]);
+    }
+}
+
+void VoxelChunk::FillMaterialMesh(MaterialMesh& matMesh, const std::string& textureName, const VertexBuffers& buffers) {
+    const std::vector<Vector3>& vertices = buffers.vertices;
+    const std::vector<Vector3>& normals = buffers.normals;
+    const std::vector<Vector2>& texcoords = buffers.texcoords;
+    const std::vector<Color>& colors = buffers.colors;
+    
+    matMesh.textureName = textureName;
+    
+    // Initialize mesh
+    matMesh.mesh.vertexCount = vertices.size();
+    matMesh.mesh.triangleCount = vertices.size() / 3;
+    
+    // Allocate mesh data
+    matMesh.mesh.vertices = (float*)RL_MALLOC(vertices.size() * 3 * sizeof(float));
+    matMesh.mesh.normals = (float*)RL_MALLOC(vertices.size() * 3 * sizeof(float));
+    matMesh.mesh.texcoords = (float*)RL_MALLOC(vertices.size() * 2 * sizeof(float));
+    matMesh.mesh.colors = (unsigned char*)RL_MALLOC(vertices.size() * 4 * sizeof(unsigned char));
+    
+    // Copy data to mesh
+    for (size_t i = 0; i < vertices.size(); i++) {
+        matMesh.mesh.vertices[i * 3] = vertices[i].x;
+        matMesh.mesh.vertices[i * 3 + 1] = vertices[i].y;
+        matMesh.mesh.vertices[i * 3 + 2] = vertices[i].z;
+        
+        matMesh.mesh.normals[i * 3] = normals[i].x;
+        matMesh.mesh.normals[i * 3 + 1] = normals[i].y;
+        matMesh.mesh.normals[i * 3 + 2] = normals[i].z;
+        
+        matMesh.mesh.texcoords[i * 2] = texcoords[i].x;
+        matMesh.mesh.texcoords[i * 2 + 1] = texcoords[i].y;
+        
+        matMesh.mesh.colors[i * 4] = colors[i].r;
+        matMesh.mesh.colors[i * 4 + 1] = colors[i].g;
+        matMesh.mesh.colors[i * 4 + 2] = colors[i].b;
+        matMesh.mesh.colors[i * 4 + 3] = colors[i].a;
+    }
+}
+
+void VoxelChunk::AddModelQuads(const VoxelWorld* world, std::vector<VertexBuffers>& geometry) const {
+    const BlockRegistry& registry = BlockRegistry::Get();
+    
+    // Most chunks are all cubes; the block histogram says so without a scan
+    bool hasModels = false;
+    for (int type = 0; type < registry.GetIdLimit() && !hasModels; type++) {
+        hasModels = registry.model[type] != MODEL_CUBE && blockCounts[type] > 0;
+    }
+    if (!hasModels) return;
+    
+    const int CORNER_ORDER[6] = {0, 1, 2, 0, 2, 3};
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_HEIGHT; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                const Voxel& voxel = voxels[x][y][z];
+                int modelId = registry.model[voxel.type];
+                if (modelId == MODEL_CUBE || !voxel.isActive || registry.HasFlag(voxel.type, BLOCK_CUTOUT)) continue;
+                
+                // Each face is culled once; the model's quads on that side share the result
+                uint8_t visibleFaces = 0;
+                for (int face = 0; face < FACE_COUNT; face++) {
+                    if (IsFaceVisible(x, y, z, (FaceDirection)face, world)) visibleFaces |= 1 << face;
+                }
+                
+                Vector3 origin = GetWorldPosition(x, y, z);
+                for (const ModelQuad& quad : registry.GetModels().GetModel(modelId).quads) {
+                    if (quad.cullFace >= 0 && !(visibleFaces & (1 << quad.cullFace))) continue;
+                    
+                    VertexBuffers& out = geometry[registry.faceTexture[quad.textureFace][voxel.type]];
+                    for (int corner : CORNER_ORDER) {
+                        out.vertices.push_back(Vector3Add(origin, quad.corners[corner]));
+                        out.normals.push_back(quad.normal);
+                        out.texcoords.push_back(quad.uvs[corner]);
+                        out.colors.push_back(WHITE);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void VoxelChunk::AddFoliageQuads(const VoxelWorld* world, std::vector<VertexBuffers>& geometry) const {
+    const BlockRegistry& registry = BlockRegistry::Get();
+    
+    bool hasFoliage = false;
+    for (int type = 0; type < registry.GetIdLimit() && !hasFoliage; type++) {
+        hasFoliage = registry.HasFlag(type, BLOCK_CUTOUT) && blockCounts[type] > 0;
+    }
+    if (!hasFoliage) return;
+    
+    const int CORNER_ORDER[6] = {0, 1, 2, 0, 2, 3};
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+        for (int y = 0; y < CHUNK_HEIGHT; y++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                const Voxel& voxel = voxels[x][y][z];
+                if (!voxel.isActive || !registry.HasFlag(voxel.type, BLOCK_CUTOUT)) continue;
+                Vector3 origin = GetWorldPosition(x, y, z);
+                int modelId = registry.model[voxel.type];
+                
+                // Cutout cubes (leaves) keep the usual per-face culling
+                if (modelId == MODEL_CUBE) {
+                    for (int face = 0; face < FACE_COUNT; face++) {
+                        if (!IsFaceVisible(x, y, z, (FaceDirection)face, world)) continue;
+                        VertexBuffers& out = geometry[registry.faceTexture[face][voxel.type]];
+                        AddFaceToMesh(out.vertices, out.normals, out.texcoords, out.colors, origin, (FaceDirection)face);
+                    }
+                    continue;
+                }
+                
+                // Plants: rotate about Y and nudge sideways by a hash of the position so
+                // a field of them doesn't line up on the grid
+                uint32_t hash = PositionHash((int)origin.x, (int)origin.y, (int)origin.z);
+                float angle = (hash & 0xFF) / 256.0f * (PI / 2.0f);
+                float offsetX = (((hash >> 8) & 0xFF) / 255.0f - 0.5f) * 2.0f * FOLIAGE_MAX_OFFSET;
+                float offsetZ = (((hash >> 16) & 0xFF) / 255.0f - 0.5f) * 2.0f * FOLIAGE_MAX_OFFSET;
+                float cosA = cosf(angle), sinA = sinf(angle);
+                
+                for (const ModelQuad& quad : registry.GetModels().GetModel(modelId).quads) {
+                    VertexBuffers& out = geometry[registry.faceTexture[quad.textureFace][voxel.type]];
+                    Vector3 normal = {quad.normal.x * cosA - quad.normal.z * sinA, quad.normal.y,
+                                      quad.normal.x * sinA + quad.normal.z * cosA};
+                    for (int corner : CORNER_ORDER) {
+                        const Vector3& c = quad.corners[corner];
+                        out.vertices.push_back({origin.x + offsetX + c.x * cosA - c.z * sinA, origin.y + c.y,
+                                                origin.z + offsetZ + c.x * sinA + c.z * cosA});
+                        out.normals.push_back(normal);
+                        out.texcoords.push_back(quad.uvs[corner]);
+                        out.colors.push_back(registry.tint[voxel.type]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int VoxelChunk::GetMaxLayerForFace(FaceDirection face) const {
+    switch (face) {
+        case FACE_TOP:
+        case FACE_BOTTOM:
+            return CHUNK_HEIGHT;  // Y layers
+        case FACE_FRONT:
+        case FACE_BACK:
+            return CHUNK_SIZE;    // Z layers
+        case FACE_RIGHT:
+        case FACE_LEFT:
+            return CHUNK_SIZE;    // X layers
+        default:
+            return 1;
+    }
+}
+
+void VoxelChunk::ExtractFaceMask(FaceDirection face, int layer, const VoxelWorld* world,
+                                 FaceMask mask[CHUNK_SIZE][CHUNK_SIZE]) {
+    // Initialize mask
+    for (int i = 0; i < CHUNK_SIZE; i++) {
+        for (int j = 0; j < CHUNK_SIZE; j++) {
+            mask[i][j] = FaceMask();
+        }
+    }
+    
+    // Extract face information for the specific layer
+    for (int u = 0; u < CHUNK_SIZE; u++) {
+        for (int v = 0; v < CHUNK_SIZE; v++) {
+            // Convert u,v coordinates to x,y,z based on face direction and layer
+            int x, y, z;
+            
+            switch (face) {
+                case FACE_TOP:
+                    x = u; y = layer; z = v;
+                    break;
+                case FACE_BOTTOM:
+                    x = u; y = layer; z = v;
+                    break;
+                case FACE_FRONT:
+                    x = u; y = v; z = layer;
+                    break;
+                case FACE_BACK:
+                    x = u; y = v; z = layer;
+                    break;
+                case FACE_RIGHT:
+                    x = layer; y = v; z = u;
+                    break;
+                case FACE_LEFT:
+                    x = layer; y = v; z = u;
+                    break;
+                default:
+                    continue;
+            }
+            
+            // Check if we should render this face; non-cube models are meshed separately
+            if (!IsValidPosition(x, y, z)) continue;
+            VoxelType type = voxels[x][y][z].type;
+            if (BlockRegistry::Get().model[type] == MODEL_CUBE &&
+                !BlockRegistry::Get().HasFlag(type, BLOCK_CUTOUT) && IsFaceVisible(x, y, z, face, world)) {
+                mask[u][v] = FaceMask(true, type, BlockRegistry::Get().faceTexture[face][type]);
+            }
+        }
+    }
+}
+
+void VoxelChunk::GreedyMeshFace(FaceDirection face, int layer, FaceMask mask[CHUNK_SIZE][CHUNK_SIZE], 
+                                std::vector<QuadMesh>& quads) {
+    // Create a copy of the mask to mark processed areas
+    bool processed[CHUNK_SIZE][CHUNK_SIZE] = {false};
+    
+    for (int u = 0; u < CHUNK_SIZE; u++) {
+        for (int v = 0; v < CHUNK_SIZE; v++) {
+            if (processed[u][v] || !mask[u][v].visible) continue;
+            
+            // Find the width of the quad (extend in u direction)
+            int width = 1;
+            while (u + width < CHUNK_SIZE && 
+                   !processed[u + width][v] && 
+                   mask[u + width][v].visible &&
+                   mask[u + width][v] == mask[u][v]) {
+                width++;
+            }
+            
+            // Find the height of the quad (extend in v direction)
+            int height = 1;
+            bool canExtend = true;
+            while (v + height < CHUNK_SIZE && canExtend) {
+                // Check if the entire row can be extended
+                for (int i = 0; i < width; i++) {
+                    if (processed[u + i][v + height] || 
+                        !mask[u + i][v + height].visible ||
+                        !(mask[u + i][v + height] == mask[u][v])) {
+                        canExtend = false;
+                        break;
+                    }
+                }
+                if (canExtend) height++;
+            }
+            
+            // Mark the quad area as processed
+            for (int i = 0; i < width; i++) {
+                for (int j = 0; j < height; j++) {
+                    processed[u + i][v + j] = true;
+                }
+            }
+            
+            // Create the quad with the position of the first voxel
+            Vector3 startPosition;
+            
+            // Convert u,v coordinates and layer back to world position
+            switch (face) {
+                case FACE_TOP:
+                    startPosition = GetWorldPosition(u, layer, v);
+                    break;
+                case FACE_BOTTOM:
+                    startPosition = GetWorldPosition(u, layer, v);
+                    break;
+                case FACE_FRONT:
+                    startPosition = GetWorldPosition(u, v, layer);
+                    break;
+                case FACE_BACK:
+                    startPosition = GetWorldPosition(u, v, layer);
+                    break;
+                case FACE_RIGHT:
+                    startPosition = GetWorldPosition(layer, v, u);
+                    break;
+                case FACE_LEFT:
+                    startPosition = GetWorldPosition(layer, v, u);
+                    break;
+            }
+            
+            quads.emplace_back(startPosition, width, height, face, mask[u][v].textureId);
+        }
+    }
+}
+
+void VoxelChunk::AddQuadToMesh(std::vector<Vector3>& vertices, std::vector<Vector3>& normals, 
+                               std::vector<Vector2>& texcoords, std::vector<Color>& colors,
+                               const QuadMesh& quad) const {
+    // Instead of creating custom vertex logic, use the original AddFaceToMesh for each voxel position
+    // This preserves the exact same rotation and positioning as the working single-face system
+    
+    for (int w = 0; w < quad.width; w++) {
+        for (int h = 0; h < quad.height; h++) {
+            Vector3 voxelPosition = quad.startPosition;
+            
+            // Calculate the position offset for this voxel in the quad
+            switch (quad.face) {
+                case FACE_TOP:
+                case FACE_BOTTOM:
+                    // For top/bottom faces: width extends in X, height extends in Z
+                    voxelPosition.x += w;
+                    voxelPosition.z += h;
+                    break;
+                case FACE_FRONT:
+                case FACE_BACK:
+                    // For front/back faces: width extends in X, height extends in Y
+                    voxelPosition.x += w;
+                    voxelPosition.y += h;
+                    break;
+                case FACE_RIGHT:
+                case FACE_LEFT:
+                    // For left/right faces: width extends in Z, height extends in Y
+                    voxelPosition.z += w;
+                    voxelPosition.y += h;
+                    break;
+            }
+            
+            // Use the original AddFaceToMesh function - this keeps rotation/positioning identical
+            AddFaceToMesh(vertices, normals, texcoords, colors, voxelPosition, quad.face);
+        }
+    }
+}
+
+bool VoxelChunk::IsFaceVisible(int x, int y, int z, FaceDirection face, const VoxelWorld* world) const {
+    if (!voxels[x][y][z].isActive) return false;
+    
+    // Opaque cubes hide everything. See-through faces (liquids, fire) only show against air;
+    // solid faces also show through them. Alpha-tested blocks (leaves) have holes, so they
+    // only hide faces of their own kind. Beyond that the neighbor has to cover this face's
+    // shape (a slab doesn't hide a cube's side).
+    const BlockRegistry& registry = BlockRegistry::Get();
+    VoxelType selfType = voxels[x][y][z].type;
+    bool selfIsSeeThrough = registry.HasFlag(selfType, BLOCK_SEE_THROUGH);
+    auto hidesFace = [&registry, selfType, selfIsSeeThrough, face](const Voxel& neighbor) {
+        if (!neighbor.isActive) return false;
+        if (registry.HasFlag(neighbor.type, BLOCK_OPAQUE)) return true;
+        if (!selfIsSeeThrough && registry.HasFlag(neighbor.type, BLOCK_SEE_THROUGH)) return false;
+        if (registry.HasFlag(neighbor.type, BLOCK_CUTOUT) && neighbor.type != selfType) return false;
+        return registry.NeighborHidesFace(selfType, face, neighbor.type);
+    };
+    
+    int nx = x, ny = y, nz = z;
+    
+    // Get neighbor coordinates based on face direction
+    switch (face) {
+        case FACE_TOP: ny++; break;
+        case FACE_BOTTOM: ny--; break;
+        case FACE_FRONT: nz++; break;
+        case FACE_BACK: nz--; break;
+        case FACE_RIGHT: nx++; break;
+        case FACE_LEFT: nx--; break;
+    }
+    
+    // Check if neighbor is within this chunk
+    if (IsValidPosition(nx, ny, nz)) {
+        // Neighbor is in same chunk - check directly
+        return !hidesFace(voxels[nx][ny][nz]);
+    }
+    
+    // Neighbor is outside chunk bounds - check neighboring chunk if world is provided
+    if (world != nullptr) {
+        // Convert local coordinates to world coordinates
+        Vector3 worldPos = GetWorldPosition(x, y, z);
+        int worldX = (int)worldPos.x;
+        int worldY = (int)worldPos.y;
+        int worldZ = (int)worldPos.z;
+        
+        // Calculate neighbor world coordinates
+        int neighborWorldX = worldX, neighborWorldY = worldY, neighborWorldZ = worldZ;
+        switch (face) {
+            case FACE_TOP: neighborWorldY++; break;
+            case FACE_BOTTOM: neighborWorldY--; break;
+            case FACE_FRONT: neighborWorldZ++; break;
+            case FACE_BACK: neighborWorldZ--; break;
+            case FACE_RIGHT: neighborWorldX++; break;
+            case FACE_LEFT: neighborWorldX--; break;
+        }
+        
+        // Check if neighbor voxel exists in world
+        Voxel neighborVoxel = world->GetVoxel(neighborWorldX, neighborWorldY, neighborWorldZ);
+        return !hidesFace(neighborVoxel);
+    }
+    
+    // If no world provided and neighbor is outside chunk, render the face
+    return true;
+}
+
+void VoxelChunk::AddFaceToMesh(std::vector<Vector3>& vertices, std::vector<Vector3>& normals, 
+                               std::vector<Vector2>& texcoords, std::vector<Color>& colors,
+                               Vector3 position, FaceDirection face) const {
+    
+    Vector3 v1, v2, v3, v4;
+    Vector3 normal;
+    
+    // Define vertices and normal for each face (counter-clockwise winding)
+    switch (face) {
+        case FACE_TOP:
+            v1 = Vector3Add(position, (Vector3){-0.5f, 0.5f, -0.5f});
+            v2 = Vector3Add(position, (Vector3){-0.5f, 0.5f, 0.5f});
+            v3 = Vector3Add(position, (Vector3){0.5f, 0.5f, 0.5f});
+            v4 = Vector3Add(position, (Vector3){0.5f, 0.5f, -0.5f});
+            normal = (Vector3){0.0f, 1.0f, 0.0f};
+            break;
+        case FACE_BOTTOM:
+            v1 = Vector3Add(position, (Vector3){-0.5f, -0.5f, -0.5f});
+            v2 = Vector3Add(position, (Vector3){0.5f, -0.5f, -0.5f});
+            v3 = Vector3Add(position, (Vector3){0.5f, -0.5f, 0.5f});
+            v4 = Vector3Add(position, (Vector3){-0.5f, -0.5f, 0.5f});
+            normal = (Vector3){0.0f, -1.0f, 0.0f};
+            break;
+        case FACE_FRONT:
+            v1 = Vector3Add(position, (Vector3){-0.5f, -0.5f, 0.5f});
+            v2 = Vector3Add(position, (Vector3){0.5f, -0.5f, 0.5f});
+            v3 = Vector3Add(position, (Vector3){0.5f, 0.5f, 0.5f});
+            v4 = Vector3Add(position, (Vector3){-0.5f, 0.5f, 0.5f});
+            normal = (Vector3){0.0f, 0.0f, 1.0f};
+            break;
+        case FACE_BACK:
+            v1 = Vector3Add(position, (Vector3){0.5f, -0.5f, -0.5f});
+            v2 = Vector3Add(position, (Vector3){-0.5f, -0.5f, -0.5f});
+            v3 = Vector3Add(position, (Vector3){-0.5f, 0.5f, -0.5f});
+            v4 = Vector3Add(position, (Vector3){0.5f, 0.5f, -0.5f});
+            normal = (Vector3){0.0f, 0.0f, -1.0f};
+            break;
+        case FACE_RIGHT:
+            v1 = Vector3Add(position, (Vector3){0.5f, -0.5f, 0.5f});
+            v2 = Vector3Add(position, (Vector3){0.5f, -0.5f, -0.5f});
+            v3 = Vector3Add(position, (Vector3){0.5f, 0.5f, -0.5f});
+            v4 = Vector3Add(position, (Vector3){0.5f, 0.5f, 0.5f});
+            normal = (Vector3){1.0f, 0.0f, 0.0f};
+            break;
+        case FACE_LEFT:
+            v1 = Vector3Add(position, (Vector3){-0.5f, -0.5f, -0.5f});
+            v2 = Vector3Add(position, (Vector3){-0.5f, -0.5f, 0.5f});
+            v3 = Vector3Add(position, (Vector3){-0.5f, 0.5f, 0.5f});
+            v4 = Vector3Add(position, (Vector3){-0.5f, 0.5f, -0.5f});
+            normal = (Vector3){-1.0f, 0.0f, 0.0f};
+            break;
+    }
+    
+    // Get appropriate texture coordinates based on voxel type and face
+    Vector2 uv1 = {0.0f, 1.0f};
+    Vector2 uv2 = {1.0f, 1.0f};
+    Vector2 uv3 = {1.0f, 0.0f};
+    Vector2 uv4 = {0.0f, 0.0f};
+    
+    // Use white color for all vertices (texture will provide the color)
+    Color vertexColor = WHITE;
+    
+    // Add two triangles to form a quad
+    // Triangle 1: v1, v2, v3
+    vertices.push_back(v1);
+    vertices.push_back(v2);
+    vertices.push_back(v3);
+    normals.push_back(normal);
+    normals.push_back(normal);
+    normals.push_back(normal);
+    texcoords.push_back(uv1);
+    texcoords.push_back(uv2);
+    texcoords.push_back(uv3);
+    colors.push_back(vertexColor);
+    colors.push_back(vertexColor);
+    colors.push_back(vertexColor);
+    
+    // Triangle 2: v1, v3, v4
+    vertices.push_back(v1);
+    vertices.push_back(v3);
+    vertices.push_back(v4);
+    normals.push_back(normal);
+    normals.push_back(normal);
+    normals.push_back(normal);
+    texcoords.push_back(uv1);
+    texcoords.push_back(uv3);
+    texcoords.push_back(uv4);
+    colors.push_back(vertexColor);
+    colors.push_back(vertexColor);
+    colors.push_back(vertexColor);
+}
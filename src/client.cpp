@@ -0,0 +1,345 @@
+#include "../include/client.h"
+#include "../include/chunk_codec.h"
+#include <algorithm>
+#include <iostream>
+
+GameClient::GameClient(TextureManager* textureManager)
+    : textureManager(textureManager), clientId(0), cachedChunksLoaded(0) {
+}
+
+GameClient::~GameClient() {
+    SaveChunkCache();
+}
+
+bool GameClient::EnableChunkCache(const std::string& directory) {
+    chunkCache.reset(new ChunkCache());
+    if (chunkCache->Open(directory)) return true;
+    chunkCache.reset();
+    return false;
+}
+
+void GameClient::Connect(std::unique_ptr<Connection> newConnection, const std::string& playerName,
+                         Vector3 position, int viewDistance) {
+    SaveChunkCache();  // From a previous connection
+    connection = std::move(newConnection);
+    world.reset();
+    clientId = 0;
+    disconnectReason.clear();
+    if (!connection) return;
+
+    PacketWriter writer(PACKET_HELLO);
+    writer.WriteU32(PROTOCOL_VERSION);
+    writer.WriteString(playerName);
+    writer.WriteF32(position.x);
+    writer.WriteF32(position.y);
+    writer.WriteF32(position.z);
+    writer.WriteU8((uint8_t)std::max(0, std::min(viewDistance, 255)));
+    writer.WriteU8(chunkCache ? 1 : 0);
+    if (chunkCache) {
+        writer.WriteU32((uint32_t)chunkCache->GetEntries().size());
+        for (const auto& entry : chunkCache->GetEntries()) {
+            writer.WriteI32(entry.first.first);
+            writer.WriteI32(entry.first.second);
+            writer.WriteU64(entry.second);
+        }
+    } else {
+        writer.WriteU32(0);
+    }
+    connection->Send(writer);
+}
+
+void GameClient::Disconnect() {
+    if (!IsConnected()) return;
+
+    PacketWriter writer(PACKET_DISCONNECT);
+    writer.WriteString("Quit");
+    connection->Send(writer);
+    std::vector<std::vector<uint8_t>> ignored;
+    connection->Poll(ignored);  // Flush before closing
+    connection->Close();
+    SaveChunkCache();
+}
+
+void GameClient::Poll() {
+    if (!connection) return;
+
+    std::vector<std::vector<uint8_t>> packets;
+    connection->Poll(packets);
+    for (const std::vector<uint8_t>& packet : packets) {
+        HandlePacket(packet);
+    }
+
+    // Headless clients never call world->Update, so unloads are collected here too
+    if (world) world->CollectUnloadedChunks();
+
+    // Dropped without a DISCONNECT; keep what we had
+    if (!connection->IsOpen()) SaveChunkCache();
+}
+
+void GameClient::HandlePacket(const std::vector<uint8_t>& packet) {
+    PacketReader reader(packet);
+    switch (reader.GetType()) {
+        case PACKET_WELCOME: {
+            clientId = (int)reader.ReadU32();
+            int width = reader.ReadU16();
+            int depth = reader.ReadU16();
+            if (!reader.IsValid()) return;
+
+            world.reset(new VoxelWorld(width, depth));
+            world->SetTextureManager(textureManager);
+            receivedChunks.assign(width * depth, 0);
+            swappedChunks.assign(width * depth, 0);
+            break;
+        }
+        case PACKET_CHUNK_DATA:
+            HandleChunkData(reader);
+            break;
+        case PACKET_CHUNK_UPDATES:
+            HandleChunkUpdates(reader);
+            break;
+        case PACKET_EXPLOSION:
+            HandleExplosion(reader);
+            break;
+        case PACKET_CHUNK_UNLOAD:
+            HandleChunkUnload(reader);
+            break;
+        case PACKET_CHUNK_CACHED:
+            HandleChunkCached(reader);
+            break;
+        case PACKET_DISCONNECT:
+            disconnectReason = reader.ReadString();
+            std::cout << "Disconnected by server: " << disconnectReason << std::endl;
+            connection->Close();
+            SaveChunkCache();
+            break;
+        default:
+            break;
+    }
+}
+
+void GameClient::HandleChunkData(PacketReader& reader) {
+    if (!world) return;
+
+    int chunkX = reader.ReadI32();
+    int chunkZ = reader.ReadI32();
+    std::vector<Voxel> cells(VoxelChunk::CHUNK_VOLUME);
+    if (!ReadChunkData(reader, cells.data()) || !world->GetChunk(chunkX, chunkZ)) return;
+    ReplaceChunk(chunkX, chunkZ, cells.data());
+    receivedChunks[chunkX * world->GetDepth() + chunkZ] = 1;
+}
+
+void GameClient::HandleChunkCached(PacketReader& reader) {
+    if (!world) return;
+
+    int chunkX = reader.ReadI32();
+    int chunkZ = reader.ReadI32();
+    if (!reader.IsValid() || !world->GetChunk(chunkX, chunkZ)) return;
+
+    std::vector<Voxel> cells(VoxelChunk::CHUNK_VOLUME);
+    if (chunkCache && chunkCache->Load(chunkX, chunkZ, cells.data())) {
+        ReplaceChunk(chunkX, chunkZ, cells.data());
+        receivedChunks[chunkX * world->GetDepth() + chunkZ] = 1;
+        cachedChunksLoaded++;
+        return;
+    }
+
+    // The server believed a copy we no longer have
+    PacketWriter writer(PACKET_REQUEST_CHUNK);
+    writer.WriteI32(chunkX);
+    writer.WriteI32(chunkZ);
+    connection->Send(writer);
+}
+
+void GameClient::HandleChunkUnload(PacketReader& reader) {
+    if (!world) return;
+
+    int chunkX = reader.ReadI32();
+    int chunkZ = reader.ReadI32();
+    if (!reader.IsValid()) return;
+
+    // Out of view the chunk would go stale, so it is unloaded until it is sent again.
+    // The cache keeps it as of now, which is what the server will compare against.
+    StoreChunk(chunkX, chunkZ);
+    world->UnloadChunk(chunkX, chunkZ);
+    if (world->GetChunk(chunkX, chunkZ)) swappedChunks[chunkX * world->GetDepth() + chunkZ] = 0;
+}
+
+bool GameClient::SwapOutChunk(int chunkX, int chunkZ) {
+    if (!world || !world->GetChunk(chunkX, chunkZ)) return false;
+
+    StoreChunk(chunkX, chunkZ);
+    if (!world->UnloadChunk(chunkX, chunkZ)) return false;
+    swappedChunks[chunkX * world->GetDepth() + chunkZ] = 1;
+    return true;
+}
+
+bool GameClient::SwapInChunk(int chunkX, int chunkZ) {
+    if (!world || !world->GetChunk(chunkX, chunkZ)) return false;
+    uint8_t& swapped = swappedChunks[chunkX * world->GetDepth() + chunkZ];
+    if (!swapped) return false;
+
+    std::vector<Voxel> cells(VoxelChunk::CHUNK_VOLUME);
+    if (chunkCache && chunkCache->Load(chunkX, chunkZ, cells.data())) {
+        ReplaceChunk(chunkX, chunkZ, cells.data());
+        receivedChunks[chunkX * world->GetDepth() + chunkZ] = 1;
+        return true;
+    }
+
+    // Not cached; the server sends it again. Updates until then are covered by it.
+    swapped = 0;
+    if (!IsConnected()) return false;
+    PacketWriter writer(PACKET_REQUEST_CHUNK);
+    writer.WriteI32(chunkX);
+    writer.WriteI32(chunkZ);
+    connection->Send(writer);
+    return true;
+}
+
+void GameClient::ReplaceChunk(int chunkX, int chunkZ, const Voxel* cells) {
+    VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+    if (!chunk) return;
+
+    swappedChunks[chunkX * world->GetDepth() + chunkZ] = 0;
+
+    // A chunk we already have is overwritten in place
+    bool loading = world->BeginChunkLoad(chunkX, chunkZ);
+    for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+        int x, y, z;
+        VoxelChunk::CellCoords(cell, x, y, z);
+        chunk->SetVoxel(x, y, z, cells[cell].type, cells[cell].metadata);
+    }
+    if (loading) {
+        world->FinishChunkLoad(chunkX, chunkZ);
+        return;
+    }
+
+    // Border faces of the neighbors depend on this chunk too
+    chunk->MarkForUpdate();
+    const int NEIGHBORS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (const auto& offset : NEIGHBORS) {
+        if (VoxelChunk* neighbor = world->GetChunk(chunkX + offset[0], chunkZ + offset[1])) {
+            neighbor->MarkForUpdate();
+        }
+    }
+}
+
+void GameClient::StoreChunk(int chunkX, int chunkZ) {
+    const VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+    if (!chunkCache || !chunk) return;
+    uint8_t& received = receivedChunks[chunkX * world->GetDepth() + chunkZ];
+    if (!received) return;
+
+    std::vector<Voxel> cells(VoxelChunk::CHUNK_VOLUME);
+    for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+        int x, y, z;
+        VoxelChunk::CellCoords(cell, x, y, z);
+        cells[cell] = chunk->GetVoxel(x, y, z);
+    }
+    chunkCache->Store(chunkX, chunkZ, cells.data());
+    received = 0;
+}
+
+void GameClient::SaveChunkCache() {
+    if (!chunkCache || !world) return;
+
+    for (int chunkX = 0; chunkX < world->GetWidth(); chunkX++) {
+        for (int chunkZ = 0; chunkZ < world->GetDepth(); chunkZ++) {
+            StoreChunk(chunkX, chunkZ);
+        }
+    }
+    chunkCache->SaveIndex();
+}
+
+void GameClient::HandleChunkUpdates(PacketReader& reader) {
+    if (!world) return;
+
+    // Everything goes through one ApplyEdits, so listeners see each chunk once
+    std::vector<BlockEdit> edits;
+    std::vector<std::pair<int, Voxel>> changes;
+    std::vector<Voxel> cells(VoxelChunk::CHUNK_VOLUME);
+    int chunkCount = reader.ReadU16();
+    for (int i = 0; i < chunkCount && reader.IsValid(); i++) {
+        int chunkX = reader.ReadI32();
+        int chunkZ = reader.ReadI32();
+        uint8_t kind = reader.ReadU8();
+        SwapInChunk(chunkX, chunkZ);
+        const VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+
+        changes.clear();
+        if (kind == CHUNK_UPDATE_FULL) {
+            if (!ReadChunkData(reader, cells.data()) || !chunk) return;
+
+            // A resent chunk only produces edits for the cells that differ
+            for (int cell = 0; cell < VoxelChunk::CHUNK_VOLUME; cell++) {
+                int x, y, z;
+                VoxelChunk::CellCoords(cell, x, y, z);
+                Voxel current = chunk->GetVoxel(x, y, z);
+                if (current.type != cells[cell].type || current.metadata != cells[cell].metadata) {
+                    changes.emplace_back(cell, cells[cell]);
+                }
+            }
+        } else {
+            size_t consumed = ChunkCodec::DecodeDelta(reader.Peek(), reader.GetRemaining(), changes);
+            if (consumed == 0 || !chunk) return;
+            reader.ReadBytes(consumed);
+        }
+
+        // Swapped out and not back yet; the resent chunk will include these
+        ChunkState state = world->GetChunkState(chunkX, chunkZ);
+        if (state == CHUNK_UNLOADED || state == CHUNK_UNLOADING) continue;
+
+        for (const auto& change : changes) {
+            int x, y, z;
+            VoxelChunk::CellCoords(change.first, x, y, z);
+            edits.emplace_back(chunkX * VoxelChunk::CHUNK_SIZE + x, y, chunkZ * VoxelChunk::CHUNK_SIZE + z,
+                               change.second.type, change.second.metadata);
+        }
+    }
+    if (reader.IsValid()) world->ApplyEdits(edits);
+}
+
+void GameClient::HandleExplosion(PacketReader& reader) {
+    Vector3 center = {reader.ReadF32(), reader.ReadF32(), reader.ReadF32()};
+    uint32_t count = reader.ReadU32();
+    if (count > reader.GetRemaining() / 13) return;  // 13 bytes per block
+
+    std::vector<BlockEdit> destroyed;
+    destroyed.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        int x = reader.ReadI32(), y = reader.ReadI32(), z = reader.ReadI32();
+        destroyed.emplace_back(x, y, z, (VoxelType)reader.ReadU8());
+    }
+    if (reader.IsValid() && explosionListener) explosionListener(center, destroyed);
+}
+
+void GameClient::SendPosition(Vector3 position) {
+    if (!IsConnected()) return;
+
+    PacketWriter writer(PACKET_PLAYER_MOVE);
+    writer.WriteF32(position.x);
+    writer.WriteF32(position.y);
+    writer.WriteF32(position.z);
+    connection->Send(writer);
+}
+
+void GameClient::RequestSetBlock(int x, int y, int z, VoxelType type) {
+    if (!IsConnected()) return;
+
+    PacketWriter writer(PACKET_SET_BLOCK);
+    writer.WriteI32(x);
+    writer.WriteI32(y);
+    writer.WriteI32(z);
+    writer.WriteU8((uint8_t)type);
+    connection->Send(writer);
+}
+
+void GameClient::RequestExplosion(Vector3 center, float power) {
+    if (!IsConnected()) return;
+
+    PacketWriter writer(PACKET_EXPLODE);
+    writer.WriteF32(center.x);
+    writer.WriteF32(center.y);
+    writer.WriteF32(center.z);
+    writer.WriteF32(power);
+    connection->Send(writer);
+}
@@ -0,0 +1,304 @@
+#include "../include/crafting.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+static void AppendItem(std::string& key, int item) {
+    key.append(reinterpret_cast<const char*>(&item), sizeof(item));
+}
+
+std::string RecipeBook::ShapedKey(int width, int height, const int* items, bool mirrored) {
+    std::string key;
+    key.reserve(3 + width * height * sizeof(int));
+    key.push_back('S');
+    key.push_back((char)width);
+    key.push_back((char)height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            AppendItem(key, items[y * width + (mirrored ? width - 1 - x : x)]);
+        }
+    }
+    return key;
+}
+
+std::string RecipeBook::ShapelessKey(std::vector<int> items) {
+    items.erase(std::remove(items.begin(), items.end(), ITEM_NONE), items.end());
+    std::sort(items.begin(), items.end());
+
+    std::string key;
+    key.reserve(1 + items.size() * sizeof(int));
+    key.push_back('L');
+    for (int item : items) {
+        AppendItem(key, item);
+    }
+    return key;
+}
+
+bool RecipeBook::TrimPattern(int width, int height, const std::vector<int>& items,
+                             int& outWidth, int& outHeight, std::vector<int>& outItems) {
+    int minX = width, minY = height, maxX = -1, maxY = -1;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (items[y * width + x] == ITEM_NONE) continue;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+    }
+    if (maxX < 0) return false;
+
+    outWidth = maxX - minX + 1;
+    outHeight = maxY - minY + 1;
+    outItems.resize(outWidth * outHeight);
+    for (int y = 0; y < outHeight; y++) {
+        for (int x = 0; x < outWidth; x++) {
+            outItems[y * outWidth + x] = items[(minY + y) * width + (minX + x)];
+        }
+    }
+    return true;
+}
+
+int RecipeBook::AddShaped(const std::string& name, int width, int height, const std::vector<int>& pattern,
+                          int resultItem, int resultCount) {
+    Recipe recipe;
+    recipe.name = name;
+    recipe.shaped = true;
+    recipe.resultItem = resultItem;
+    recipe.resultCount = resultCount;
+    if (!TrimPattern(width, height, pattern, recipe.width, recipe.height, recipe.ingredients)) {
+        return -1;
+    }
+
+    std::string key = ShapedKey(recipe.width, recipe.height, recipe.ingredients.data(), false);
+    if (index.count(key)) return -1;
+
+    int recipeIndex = (int)recipes.size();
+    index[key] = recipeIndex;
+
+    // The mirror image crafts the same thing, unless another recipe claims it explicitly
+    std::string mirroredKey = ShapedKey(recipe.width, recipe.height, recipe.ingredients.data(), true);
+    index.emplace(mirroredKey, recipeIndex);
+
+    recipes.push_back(std::move(recipe));
+    return recipeIndex;
+}
+
+int RecipeBook::AddShapeless(const std::string& name, const std::vector<int>& ingredients, int resultItem, int resultCount) {
+    Recipe recipe;
+    recipe.name = name;
+    recipe.shaped = false;
+    recipe.resultItem = resultItem;
+    recipe.resultCount = resultCount;
+    recipe.ingredients = ingredients;
+    recipe.ingredients.erase(std::remove(recipe.ingredients.begin(), recipe.ingredients.end(), ITEM_NONE),
+                             recipe.ingredients.end());
+    if (recipe.ingredients.empty()) return -1;
+    std::sort(recipe.ingredients.begin(), recipe.ingredients.end());
+    recipe.width = (int)recipe.ingredients.size();
+    recipe.height = 1;
+
+    std::string key = ShapelessKey(recipe.ingredients);
+    if (index.count(key)) return -1;
+
+    int recipeIndex = (int)recipes.size();
+    index[key] = recipeIndex;
+    recipes.push_back(std::move(recipe));
+    return recipeIndex;
+}
+
+int RecipeBook::Match(const CraftingGrid& grid) const {
+    int width, height;
+    std::vector<int> trimmed;
+    if (!TrimPattern(grid.width, grid.height, grid.items, width, height, trimmed)) {
+        return -1;
+    }
+
+    // Shaped recipes take priority over a shapeless one with the same ingredients
+    auto it = index.find(ShapedKey(width, height, trimmed.data(), false));
+    if (it != index.end()) return it->second;
+
+    it = index.find(ShapelessKey(trimmed));
+    if (it != index.end()) return it->second;
+    return -1;
+}
+
+bool RecipeBook::ParseRecipe(const std::string& recipeJson, const ItemResolver& resolve) {
+    auto extractString = [](const std::string& json, const std::string& key) -> std::string {
+        std::string search = "\"" + key + "\":";
+        size_t keyPos = json.find(search);
+        if (keyPos == std::string::npos) return "";
+
+        size_t valueStart = json.find("\"", keyPos + search.length());
+        if (valueStart == std::string::npos) return "";
+        valueStart++;
+
+        size_t valueEnd = json.find("\"", valueStart);
+        if (valueEnd == std::string::npos) return "";
+
+        return json.substr(valueStart, valueEnd - valueStart);
+    };
+
+    std::string name = extractString(recipeJson, "name");
+    std::string type = extractString(recipeJson, "type");
+
+    // "result": { "block": ..., "count": ... }
+    size_t resultPos = recipeJson.find("\"result\":");
+    if (resultPos == std::string::npos) return false;
+    size_t resultEnd = recipeJson.find('}', resultPos);
+    std::string resultJson = recipeJson.substr(resultPos, resultEnd - resultPos);
+
+    int resultItem = resolve(extractString(resultJson, "block"));
+    int resultCount = 1;
+    size_t countPos = resultJson.find("\"count\":");
+    if (countPos != std::string::npos) {
+        resultCount = std::atoi(resultJson.c_str() + countPos + 8);
+    }
+    if (resultItem < 0) {
+        std::cout << "Recipe " << name << " has an unknown result" << std::endl;
+        return false;
+    }
+
+    // "pattern": [["a", "b"], ["", "c"]]
+    size_t patternPos = recipeJson.find("\"pattern\":");
+    if (patternPos == std::string::npos) return false;
+    size_t pos = recipeJson.find('[', patternPos) + 1;
+
+    std::vector<std::vector<int>> rows;
+    while (pos < recipeJson.length()) {
+        size_t rowStart = recipeJson.find_first_of("[]", pos);
+        if (rowStart == std::string::npos || recipeJson[rowStart] == ']') break;
+        size_t rowEnd = recipeJson.find(']', rowStart);
+
+        std::vector<int> row;
+        size_t cell = recipeJson.find('"', rowStart);
+        while (cell != std::string::npos && cell < rowEnd) {
+            size_t cellEnd = recipeJson.find('"', cell + 1);
+            std::string itemName = recipeJson.substr(cell + 1, cellEnd - cell - 1);
+            int item = itemName.empty() ? ITEM_NONE : resolve(itemName);
+            if (item < 0) {
+                std::cout << "Recipe " << name << " uses unknown item: " << itemName << std::endl;
+                return false;
+            }
+            row.push_back(item);
+            cell = recipeJson.find('"', cellEnd + 1);
+        }
+        rows.push_back(row);
+        pos = rowEnd + 1;
+    }
+    if (rows.empty()) return false;
+
+    int width = 0;
+    for (const std::vector<int>& row : rows) {
+        width = std::max(width, (int)row.size());
+    }
+    std::vector<int> pattern(width * rows.size(), ITEM_NONE);
+    for (size_t y = 0; y < rows.size(); y++) {
+        std::copy(rows[y].begin(), rows[y].end(), pattern.begin() + y * width);
+    }
+
+    int added = type == "shapeless" ? AddShapeless(name, pattern, resultItem, resultCount)
+                                    : AddShaped(name, width, (int)rows.size(), pattern, resultItem, resultCount);
+    return added >= 0;
+}
+
+bool RecipeBook::LoadFromJson(const ItemResolver& resolve, const std::string& jsonFilePath) {
+    std::ifstream file(jsonFilePath);
+    if (!file.is_open()) {
+        std::cout << "Failed to open recipes file: " << jsonFilePath << std::endl;
+        return false;
+    }
+
+    std::string jsonContent((std::istreambuf_iterator<char>(file)),
+                           std::istreambuf_iterator<char>());
+    file.close();
+
+    size_t recipesStart = jsonContent.find("\"recipes\":");
+    if (recipesStart == std::string::npos) {
+        std::cout << "Could not find 'recipes' array in JSON" << std::endl;
+        return false;
+    }
+
+    // Walk the top-level objects of the recipes array
+    size_t pos = jsonContent.find('[', recipesStart);
+    int loaded = 0;
+    while (pos != std::string::npos && pos < jsonContent.length()) {
+        size_t recipeStart = jsonContent.find_first_of("{]", pos);
+        if (recipeStart == std::string::npos || jsonContent[recipeStart] == ']') break;
+
+        int braceCount = 1;
+        pos = recipeStart + 1;
+        while (pos < jsonContent.length() && braceCount > 0) {
+            if (jsonContent[pos] == '{') braceCount++;
+            else if (jsonContent[pos] == '}') braceCount--;
+            pos++;
+        }
+
+        if (ParseRecipe(jsonContent.substr(recipeStart, pos - recipeStart), resolve)) {
+            loaded++;
+        }
+    }
+
+    std::cout << "Loaded " << loaded << " recipes" << std::endl;
+    return loaded > 0;
+}
+
+// CraftableSet Implementation
+CraftableSet::CraftableSet(const RecipeBook* book) : book(book), evaluationsLastChange(0) {
+    int recipeCount = book->GetRecipeCount();
+    requirements.resize(recipeCount);
+    listPosition.assign(recipeCount, -1);
+
+    for (int r = 0; r < recipeCount; r++) {
+        std::unordered_map<int, int> needed;
+        for (int item : book->GetRecipe(r).ingredients) {
+            if (item != ITEM_NONE) needed[item]++;
+        }
+        for (const auto& pair : needed) {
+            requirements[r].push_back(pair);
+            recipesByItem[pair.first].push_back(r);
+        }
+    }
+}
+
+bool CraftableSet::Evaluate(int recipeIndex) const {
+    for (const auto& requirement : requirements[recipeIndex]) {
+        if (GetItemCount(requirement.first) < requirement.second) return false;
+    }
+    return !requirements[recipeIndex].empty();
+}
+
+void CraftableSet::SetCraftable(int recipeIndex, bool craftable) {
+    int& position = listPosition[recipeIndex];
+    if (craftable == (position >= 0)) return;
+
+    if (craftable) {
+        position = (int)craftableList.size();
+        craftableList.push_back(recipeIndex);
+    } else {
+        // Swap-remove keeps both directions O(1)
+        int last = craftableList.back();
+        craftableList[position] = last;
+        listPosition[last] = position;
+        craftableList.pop_back();
+        position = -1;
+    }
+}
+
+void CraftableSet::SetItemCount(int item, int count) {
+    evaluationsLastChange = 0;
+    if (GetItemCount(item) == count) return;
+    itemCounts[item] = count;
+
+    auto it = recipesByItem.find(item);
+    if (it == recipesByItem.end()) return;
+    for (int recipeIndex : it->second) {
+        SetCraftable(recipeIndex, Evaluate(recipeIndex));
+    }
+    evaluationsLastChange = (int)it->second.size();
+}
+
+int CraftableSet::GetItemCount(int item) const {
+    auto it = itemCounts.find(item);
+    return it != itemCounts.end() ? it->second : 0;
+}
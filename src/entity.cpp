@@ -0,0 +1,694 @@
+#include "../include/entity.h"
+#include "../include/voxel.h"
+#include "../include/job_system.h"
+#include "../include/spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const float GRAVITY = -20.0f;
+    const float MOB_SPEED = 1.5f;
+    const float MOB_SEPARATION_RADIUS = 0.5f;
+    const float ITEM_GROUND_FRICTION = 0.85f;
+    const float ITEM_HALF_SIZE = 0.125f;
+    const float ITEM_MAX_SUBSTEP = 0.45f;   // Under one voxel, so sweeps can't tunnel
+    const float ITEM_MAX_FALL_SPEED = 30.0f;
+    const float ITEM_SLEEP_SPEED = 0.05f;
+    const float ITEM_SLEEP_DELAY = 0.5f;
+    const float ITEM_MERGE_RADIUS = 0.75f;
+    const int MAX_ITEM_STACK = 64;
+    const int SLEEPER_REFILE_MIN = 256;    // Smallest sleeper grid refile worth waiting for
+    const float CONTACT_EPSILON = 0.001f;
+
+    // xorshift32 - cheap per-entity randomness without shared state
+    inline uint32_t NextRandom(uint32_t& state) {
+        uint32_t x = state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        state = x;
+        return x;
+    }
+
+    inline float RandomFloat(uint32_t& state) {
+        return (NextRandom(state) & 0xFFFFFF) / (float)0x1000000;
+    }
+
+    inline int VoxelCoord(float v) {
+        // Voxels are centered on integer coordinates
+        return (int)floorf(v + 0.5f);
+    }
+
+    inline bool IsSolidAt(const VoxelWorld* world, float x, float y, float z) {
+        return world && world->IsSolid(VoxelCoord(x), VoxelCoord(y), VoxelCoord(z));
+    }
+
+    inline float& Axis(Vector3& v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    inline BoundingBox ItemBox(Vector3 feet) {
+        return {{feet.x - ITEM_HALF_SIZE, feet.y, feet.z - ITEM_HALF_SIZE},
+                {feet.x + ITEM_HALF_SIZE, feet.y + 2.0f * ITEM_HALF_SIZE, feet.z + ITEM_HALF_SIZE}};
+    }
+
+    // Moves an item box along one axis against the solid bitmask, stopping flush
+    // with the first voxel in the way. Returns true if the move was blocked.
+    bool SweepItemAxis(const VoxelWorld* world, Vector3& feet, int axis, float delta) {
+        while (delta != 0.0f) {
+            float step = std::max(-ITEM_MAX_SUBSTEP, std::min(ITEM_MAX_SUBSTEP, delta));
+            delta -= step;
+
+            Vector3 moved = feet;
+            Axis(moved, axis) += step;
+            if (!SpatialGrid::BoxHitsVoxels(world, ItemBox(moved))) {
+                feet = moved;
+                continue;
+            }
+
+            // The blocking voxel is in the layer the leading face just entered
+            BoundingBox box = ItemBox(feet);
+            if (step > 0.0f) {
+                float edge = Axis(box.max, axis);
+                float face = floorf(edge + step + 0.5f) - 0.5f - CONTACT_EPSILON;
+                Axis(feet, axis) += std::max(0.0f, face - edge);
+            } else {
+                float edge = Axis(box.min, axis);
+                float face = floorf(edge + step + 0.5f) + 0.5f + CONTACT_EPSILON;
+                Axis(feet, axis) += std::min(0.0f, face - edge);
+            }
+            return true;
+        }
+        return false;
+    }
+}
+
+// EntityChunk Implementation
+EntityChunk::EntityChunk(uint32_t mask) : componentMask(mask), count(0) {
+    entityIndex.resize(CAPACITY);
+
+    if (mask & COMPONENT_POSITION) {
+        posX.resize(CAPACITY); posY.resize(CAPACITY); posZ.resize(CAPACITY);
+    }
+    if (mask & COMPONENT_VELOCITY) {
+        velX.resize(CAPACITY); velY.resize(CAPACITY); velZ.resize(CAPACITY);
+        onGround.resize(CAPACITY);
+    }
+    if (mask & COMPONENT_LIFETIME) {
+        lifetime.resize(CAPACITY);
+    }
+    if (mask & COMPONENT_ITEM) {
+        itemType.resize(CAPACITY); itemCount.resize(CAPACITY);
+        sleeping.resize(CAPACITY); filed.resize(CAPACITY); restTime.resize(CAPACITY);
+    }
+    if (mask & COMPONENT_MOB) {
+        wanderTimer.resize(CAPACITY); heading.resize(CAPACITY); rngState.resize(CAPACITY);
+    }
+    if (mask & COMPONENT_PROJECTILE) {
+        damage.resize(CAPACITY);
+    }
+}
+
+// EntityWorld Implementation
+EntityWorld::EntityWorld()
+    : aliveCount(0), grid(new SpatialGrid()), sleeperGrid(new SpatialGrid()), staleSleepers(0), unfiledSleepers(0), unfiledInserts(0) {
+}
+
+EntityWorld::~EntityWorld() {
+}
+
+float EntityWorld::GetRadiusForArchetype(uint32_t componentMask) {
+    if (componentMask & COMPONENT_MOB) return 0.3f;
+    if (componentMask & COMPONENT_PROJECTILE) return 0.05f;
+    return 0.125f;
+}
+
+int EntityWorld::FindOrCreateArchetype(uint32_t mask) {
+    for (size_t i = 0; i < archetypes.size(); i++) {
+        if (archetypes[i]->componentMask == mask) {
+            return (int)i;
+        }
+    }
+    archetypes.push_back(std::unique_ptr<Archetype>(new Archetype(mask)));
+    return (int)archetypes.size() - 1;
+}
+
+EntityId EntityWorld::CreateEntity(uint32_t mask, int& outArchetype, EntityChunk*& outChunk, int& outRow) {
+    int archetypeIndex = FindOrCreateArchetype(mask);
+    Archetype& archetype = *archetypes[archetypeIndex];
+
+    // Archetypes are kept dense, so only the last chunk can have free rows
+    if (archetype.chunks.empty() || archetype.chunks.back()->IsFull()) {
+        archetype.chunks.push_back(std::unique_ptr<EntityChunk>(new EntityChunk(mask)));
+    }
+
+    int chunkIndex = (int)archetype.chunks.size() - 1;
+    EntityChunk* chunk = archetype.chunks[chunkIndex].get();
+    int row = chunk->count++;
+    archetype.entityCount++;
+
+    uint32_t index;
+    if (!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = (uint32_t)records.size();
+        records.emplace_back();
+    }
+
+    EntityRecord& record = records[index];
+    record.archetype = archetypeIndex;
+    record.chunk = chunkIndex;
+    record.row = row;
+    record.alive = true;
+    chunk->entityIndex[row] = index;
+    aliveCount++;
+
+    outArchetype = archetypeIndex;
+    outChunk = chunk;
+    outRow = row;
+    return EntityId(index, record.generation);
+}
+
+EntityId EntityWorld::SpawnMob(Vector3 position) {
+    int archetype, row;
+    EntityChunk* chunk;
+    EntityId id = CreateEntity(ARCHETYPE_MOB, archetype, chunk, row);
+
+    chunk->posX[row] = position.x;
+    chunk->posY[row] = position.y;
+    chunk->posZ[row] = position.z;
+    chunk->velX[row] = chunk->velY[row] = chunk->velZ[row] = 0.0f;
+    chunk->onGround[row] = 0;
+    chunk->rngState[row] = (id.index * 2654435761u) ^ 0x9E3779B9u;
+    chunk->wanderTimer[row] = 0.0f;
+    chunk->heading[row] = 0.0f;
+    return id;
+}
+
+EntityId EntityWorld::SpawnItem(Vector3 position, Vector3 velocity, int itemType, int itemCount, float lifetime) {
+    int archetype, row;
+    EntityChunk* chunk;
+    EntityId id = CreateEntity(ARCHETYPE_ITEM, archetype, chunk, row);
+
+    chunk->posX[row] = position.x;
+    chunk->posY[row] = position.y;
+    chunk->posZ[row] = position.z;
+    chunk->velX[row] = velocity.x;
+    chunk->velY[row] = velocity.y;
+    chunk->velZ[row] = velocity.z;
+    chunk->onGround[row] = 0;
+    chunk->lifetime[row] = lifetime;
+    chunk->itemType[row] = itemType;
+    chunk->itemCount[row] = itemCount;
+    chunk->sleeping[row] = 0;
+    chunk->filed[row] = 0;
+    chunk->restTime[row] = 0.0f;
+    return id;
+}
+
+void EntityWorld::SpawnItems(const std::vector<ItemDrop>& drops, float lifetime) {
+    // Bulk drops (explosions) grow the entity table once instead of per item
+    if (freeIndices.size() < drops.size()) {
+        records.reserve(records.size() + drops.size() - freeIndices.size());
+    }
+    for (const ItemDrop& drop : drops) {
+        SpawnItem(drop.position, drop.velocity, drop.itemType, drop.itemCount, lifetime);
+    }
+}
+
+EntityId EntityWorld::SpawnProjectile(Vector3 position, Vector3 velocity, float damage, float lifetime) {
+    int archetype, row;
+    EntityChunk* chunk;
+    EntityId id = CreateEntity(ARCHETYPE_PROJECTILE, archetype, chunk, row);
+
+    chunk->posX[row] = position.x;
+    chunk->posY[row] = position.y;
+    chunk->posZ[row] = position.z;
+    chunk->velX[row] = velocity.x;
+    chunk->velY[row] = velocity.y;
+    chunk->velZ[row] = velocity.z;
+    chunk->onGround[row] = 0;
+    chunk->lifetime[row] = lifetime;
+    chunk->damage[row] = damage;
+    return id;
+}
+
+void EntityWorld::CopyRow(EntityChunk& dst, int dstRow, const EntityChunk& src, int srcRow) {
+    uint32_t mask = dst.componentMask;
+    dst.entityIndex[dstRow] = src.entityIndex[srcRow];
+
+    if (mask & COMPONENT_POSITION) {
+        dst.posX[dstRow] = src.posX[srcRow];
+        dst.posY[dstRow] = src.posY[srcRow];
+        dst.posZ[dstRow] = src.posZ[srcRow];
+    }
+    if (mask & COMPONENT_VELOCITY) {
+        dst.velX[dstRow] = src.velX[srcRow];
+        dst.velY[dstRow] = src.velY[srcRow];
+        dst.velZ[dstRow] = src.velZ[srcRow];
+        dst.onGround[dstRow] = src.onGround[srcRow];
+    }
+    if (mask & COMPONENT_LIFETIME) {
+        dst.lifetime[dstRow] = src.lifetime[srcRow];
+    }
+    if (mask & COMPONENT_ITEM) {
+        dst.itemType[dstRow] = src.itemType[srcRow];
+        dst.itemCount[dstRow] = src.itemCount[srcRow];
+        dst.sleeping[dstRow] = src.sleeping[srcRow];
+        dst.filed[dstRow] = src.filed[srcRow];
+        dst.restTime[dstRow] = src.restTime[srcRow];
+    }
+    if (mask & COMPONENT_MOB) {
+        dst.wanderTimer[dstRow] = src.wanderTimer[srcRow];
+        dst.heading[dstRow] = src.heading[srcRow];
+        dst.rngState[dstRow] = src.rngState[srcRow];
+    }
+    if (mask & COMPONENT_PROJECTILE) {
+        dst.damage[dstRow] = src.damage[srcRow];
+    }
+}
+
+void EntityWorld::Destroy(EntityId id) {
+    if (!IsAlive(id)) return;
+
+    EntityRecord& record = records[id.index];
+    Archetype& archetype = *archetypes[record.archetype];
+    EntityChunk& chunk = *archetype.chunks[record.chunk];
+    if (chunk.Has(COMPONENT_ITEM) && chunk.filed[record.row]) {
+        staleSleepers++;
+    }
+
+    // Fill the hole with the archetype's last entity so chunks stay dense
+    EntityChunk& lastChunk = *archetype.chunks.back();
+    int lastRow = lastChunk.count - 1;
+    if (&lastChunk != &chunk || lastRow != record.row) {
+        CopyRow(chunk, record.row, lastChunk, lastRow);
+        EntityRecord& moved = records[chunk.entityIndex[record.row]];
+        moved.chunk = record.chunk;
+        moved.row = record.row;
+    }
+
+    lastChunk.count--;
+    archetype.entityCount--;
+    if (lastChunk.count == 0) {
+        archetype.chunks.pop_back();
+    }
+
+    record.alive = false;
+    record.generation++;
+    record.archetype = -1;
+    record.chunk = -1;
+    record.row = -1;
+    freeIndices.push_back(id.index);
+    aliveCount--;
+}
+
+void EntityWorld::SteerMob(EntityId id, float heading, float holdSeconds) {
+    int row;
+    EntityChunk* chunk = GetChunkForEntity(id, row);
+    if (!chunk || !chunk->Has(COMPONENT_MOB)) return;
+    chunk->heading[row] = heading;
+    chunk->wanderTimer[row] = holdSeconds;
+}
+
+bool EntityWorld::IsAlive(EntityId id) const {
+    return id.index < records.size() && records[id.index].alive && records[id.index].generation == id.generation;
+}
+
+Vector3 EntityWorld::GetPosition(EntityId id) const {
+    if (!IsAlive(id)) return Vector3Zero();
+
+    const EntityRecord& record = records[id.index];
+    const EntityChunk& chunk = *archetypes[record.archetype]->chunks[record.chunk];
+    return (Vector3){chunk.posX[record.row], chunk.posY[record.row], chunk.posZ[record.row]};
+}
+
+void EntityWorld::ForEachChunk(uint32_t requiredComponents, const std::function<void(EntityChunk&)>& fn) {
+    std::vector<EntityChunk*> matching;
+    for (auto& archetype : archetypes) {
+        if ((archetype->componentMask & requiredComponents) != requiredComponents) continue;
+        for (auto& chunk : archetype->chunks) {
+            matching.push_back(chunk.get());
+        }
+    }
+
+    JobSystem::Get().ParallelFor((int)matching.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            fn(*matching[i]);
+        }
+    });
+}
+
+void EntityWorld::FlushPendingDestroys() {
+    std::vector<EntityId> doomed;
+    for (auto& archetype : archetypes) {
+        for (auto& chunk : archetype->chunks) {
+            for (int row : chunk->pendingDestroy) {
+                uint32_t index = chunk->entityIndex[row];
+                doomed.emplace_back(index, records[index].generation);
+            }
+            chunk->pendingDestroy.clear();
+        }
+    }
+
+    // Resolve handles first - destroying moves rows around
+    for (const EntityId& id : doomed) {
+        Destroy(id);
+    }
+}
+
+void EntityWorld::RebuildSpatialGrid() {
+    // A refile costs one insert per sleeper. It happens once the inserts spent on
+    // sleepers that aren't filed yet add up to that, or once half the filed entries
+    // are stale (queries skip those in the meantime).
+    unfiledInserts += unfiledSleepers;
+    int refileCost = std::max(SLEEPER_REFILE_MIN, sleeperGrid->GetEntryCount());
+    if (unfiledInserts > refileCost || staleSleepers * 2 > refileCost) {
+        RebuildSleeperGrid();
+    }
+
+    grid->Clear();
+    unfiledSleepers = 0;
+
+    for (auto& archetype : archetypes) {
+        float radius = GetRadiusForArchetype(archetype->componentMask);
+        bool isItem = (archetype->componentMask & COMPONENT_ITEM) != 0;
+        for (auto& chunk : archetype->chunks) {
+            for (int row = 0; row < chunk->count; row++) {
+                if (isItem && chunk->filed[row]) continue;
+                if (isItem && chunk->sleeping[row]) unfiledSleepers++;
+
+                uint32_t index = chunk->entityIndex[row];
+                Vector3 position = {chunk->posX[row], chunk->posY[row], chunk->posZ[row]};
+                grid->Insert(EntityId(index, records[index].generation), position, radius);
+            }
+        }
+    }
+
+    grid->Build();
+}
+
+void EntityWorld::RebuildSleeperGrid() {
+    sleeperGrid->Clear();
+
+    for (auto& archetype : archetypes) {
+        if (!(archetype->componentMask & COMPONENT_ITEM)) continue;
+        float radius = GetRadiusForArchetype(archetype->componentMask);
+        for (auto& chunk : archetype->chunks) {
+            for (int row = 0; row < chunk->count; row++) {
+                chunk->filed[row] = chunk->sleeping[row];
+                if (!chunk->sleeping[row]) continue;
+
+                uint32_t index = chunk->entityIndex[row];
+                Vector3 position = {chunk->posX[row], chunk->posY[row], chunk->posZ[row]};
+                sleeperGrid->Insert(EntityId(index, records[index].generation), position, radius);
+            }
+        }
+    }
+
+    sleeperGrid->Build();
+    staleSleepers = 0;
+    unfiledInserts = 0;
+}
+
+void EntityWorld::DropStaleSleepers(std::vector<EntityId>& results, size_t first) const {
+    // Sleepers don't move, so an entry is current as long as its item is alive and filed
+    size_t kept = first;
+    for (size_t i = first; i < results.size(); i++) {
+        int row;
+        const EntityChunk* chunk = GetChunkForEntity(results[i], row);
+        if (chunk && chunk->filed[row]) {
+            results[kept++] = results[i];
+        }
+    }
+    results.resize(kept);
+}
+
+void EntityWorld::QueryRadius(Vector3 center, float radius, std::vector<EntityId>& results) const {
+    grid->QueryRadius(center, radius, results);
+    size_t first = results.size();
+    sleeperGrid->AppendRadius(center, radius, results);
+    DropStaleSleepers(results, first);
+}
+
+void EntityWorld::QueryAABB(BoundingBox box, std::vector<EntityId>& results) const {
+    grid->QueryAABB(box, results);
+    size_t first = results.size();
+    sleeperGrid->AppendAABB(box, results);
+    DropStaleSleepers(results, first);
+}
+
+void EntityWorld::UpdateMobs(float deltaTime) {
+    ForEachChunk(COMPONENT_MOB, [&](EntityChunk& chunk) {
+        std::vector<EntityId> neighbors;
+
+        for (int i = 0; i < chunk.count; i++) {
+            // Pick a new wander heading every few seconds
+            chunk.wanderTimer[i] -= deltaTime;
+            if (chunk.wanderTimer[i] <= 0.0f) {
+                chunk.heading[i] = RandomFloat(chunk.rngState[i]) * 2.0f * PI;
+                chunk.wanderTimer[i] = 2.0f + RandomFloat(chunk.rngState[i]) * 4.0f;
+            }
+
+            float desiredX = cosf(chunk.heading[i]) * MOB_SPEED;
+            float desiredZ = sinf(chunk.heading[i]) * MOB_SPEED;
+
+            // Push away from nearby entities so mobs don't stack
+            Vector3 position = {chunk.posX[i], chunk.posY[i], chunk.posZ[i]};
+            QueryRadius(position, MOB_SEPARATION_RADIUS, neighbors);
+            for (const EntityId& other : neighbors) {
+                if (other.index == chunk.entityIndex[i]) continue;
+                Vector3 away = Vector3Subtract(position, GetPosition(other));
+                float distance = Vector3Length(away);
+                if (distance > 0.0001f && distance < MOB_SEPARATION_RADIUS) {
+                    float push = (MOB_SEPARATION_RADIUS - distance) / MOB_SEPARATION_RADIUS * MOB_SPEED * 2.0f;
+                    desiredX += away.x / distance * push;
+                    desiredZ += away.z / distance * push;
+                }
+            }
+
+            chunk.velX[i] = desiredX;
+            chunk.velZ[i] = desiredZ;
+        }
+    });
+}
+
+void EntityWorld::UpdateItem(EntityChunk& chunk, int row, float deltaTime, const VoxelWorld* world) {
+    Vector3 feet = {chunk.posX[row], chunk.posY[row], chunk.posZ[row]};
+
+    // Something was built into the item: pop it up onto the block
+    if (SpatialGrid::BoxHitsVoxels(world, ItemBox(feet))) {
+        chunk.posY[row] = VoxelCoord(feet.y) + 0.5f;
+        chunk.velY[row] = 0.0f;
+        chunk.restTime[row] = 0.0f;
+        return;
+    }
+
+    chunk.velY[row] = std::max(chunk.velY[row] + GRAVITY * deltaTime, -ITEM_MAX_FALL_SPEED);
+
+    bool landed = false;
+    if (SweepItemAxis(world, feet, 1, chunk.velY[row] * deltaTime)) {
+        landed = chunk.velY[row] < 0.0f;
+        chunk.velY[row] = 0.0f;
+    }
+    if (SweepItemAxis(world, feet, 0, chunk.velX[row] * deltaTime)) chunk.velX[row] = 0.0f;
+    if (SweepItemAxis(world, feet, 2, chunk.velZ[row] * deltaTime)) chunk.velZ[row] = 0.0f;
+    chunk.onGround[row] = landed ? 1 : 0;
+
+    if (landed) {
+        chunk.velX[row] *= ITEM_GROUND_FRICTION;
+        chunk.velZ[row] *= ITEM_GROUND_FRICTION;
+    }
+
+    chunk.posX[row] = feet.x;
+    chunk.posY[row] = feet.y;
+    chunk.posZ[row] = feet.z;
+
+    // Items that fell out of the world or off its edges are gone; UpdateLifetimes
+    // removes them this update
+    if (world) {
+        float edgeX = world->GetWidth() * VoxelChunk::CHUNK_SIZE - 0.5f;
+        float edgeZ = world->GetDepth() * VoxelChunk::CHUNK_SIZE - 0.5f;
+        if (feet.y < -0.5f || feet.x < -0.5f || feet.x >= edgeX || feet.z < -0.5f || feet.z >= edgeZ) {
+            chunk.lifetime[row] = 0.0f;
+            return;
+        }
+    }
+
+    // Items resting on the ground long enough stop simulating entirely
+    bool resting = landed && fabsf(chunk.velX[row]) + fabsf(chunk.velZ[row]) < ITEM_SLEEP_SPEED;
+    chunk.restTime[row] = resting ? chunk.restTime[row] + deltaTime : 0.0f;
+    if (chunk.restTime[row] >= ITEM_SLEEP_DELAY) {
+        chunk.sleeping[row] = 1;
+        chunk.velX[row] = chunk.velY[row] = chunk.velZ[row] = 0.0f;
+        chunk.fellAsleep.push_back(row);
+    }
+}
+
+void EntityWorld::UpdatePhysics(float deltaTime, const VoxelWorld* world) {
+    ForEachChunk(COMPONENT_POSITION | COMPONENT_VELOCITY, [&](EntityChunk& chunk) {
+        bool isItem = chunk.Has(COMPONENT_ITEM);
+        bool isProjectile = chunk.Has(COMPONENT_PROJECTILE);
+        bool isMob = chunk.Has(COMPONENT_MOB);
+        float gravity = isProjectile ? GRAVITY * 0.25f : GRAVITY;
+
+        if (isItem) {
+            for (int i = 0; i < chunk.count; i++) {
+                if (!chunk.sleeping[i]) UpdateItem(chunk, i, deltaTime, world);
+            }
+            return;
+        }
+
+        for (int i = 0; i < chunk.count; i++) {
+            chunk.velY[i] += gravity * deltaTime;
+
+            float newX = chunk.posX[i] + chunk.velX[i] * deltaTime;
+            float newY = chunk.posY[i] + chunk.velY[i] * deltaTime;
+            float newZ = chunk.posZ[i] + chunk.velZ[i] * deltaTime;
+
+            if (isProjectile) {
+                // Projectiles stop on first contact
+                if (IsSolidAt(world, newX, newY, newZ)) {
+                    chunk.lifetime[i] = 0.0f;
+                    continue;
+                }
+            } else if (IsSolidAt(world, newX, newY - 0.01f, newZ) && chunk.velY[i] <= 0.0f) {
+                // Land on top of the voxel below the feet
+                newY = VoxelCoord(newY - 0.01f) + 0.5f;
+                chunk.velY[i] = 0.0f;
+                chunk.onGround[i] = 1;
+            } else {
+                chunk.onGround[i] = 0;
+            }
+
+            // Don't walk into walls. Mobs step up single blocks with room above them,
+            // the same climbs navigation plans paths with.
+            if (!isProjectile && IsSolidAt(world, newX, newY + 0.5f, newZ)) {
+                if (isMob && chunk.onGround[i] && !IsSolidAt(world, newX, newY + 1.5f, newZ) &&
+                    !IsSolidAt(world, newX, newY + 2.5f, newZ)) {
+                    newY += 1.0f;
+                } else {
+                    newX = chunk.posX[i];
+                    newZ = chunk.posZ[i];
+                }
+            }
+
+            chunk.posX[i] = newX;
+            chunk.posY[i] = newY;
+            chunk.posZ[i] = newZ;
+        }
+    });
+}
+
+EntityChunk* EntityWorld::GetChunkForEntity(EntityId id, int& row) const {
+    if (!IsAlive(id)) return nullptr;
+    const EntityRecord& record = records[id.index];
+    row = record.row;
+    return archetypes[record.archetype]->chunks[record.chunk].get();
+}
+
+void EntityWorld::MergeItemStacks() {
+    std::vector<EntityId> sleepers;
+    for (auto& archetype : archetypes) {
+        if (!(archetype->componentMask & COMPONENT_ITEM)) continue;
+        for (auto& chunk : archetype->chunks) {
+            for (int row : chunk->fellAsleep) {
+                uint32_t index = chunk->entityIndex[row];
+                sleepers.push_back(EntityId(index, records[index].generation));
+            }
+            chunk->fellAsleep.clear();
+        }
+    }
+
+    // A stack that just came to rest absorbs matching sleeping stacks around it.
+    // Destroy swaps rows around, so every lookup goes through the handle.
+    std::vector<EntityId> nearby;
+    for (EntityId id : sleepers) {
+        int row;
+        EntityChunk* chunk = GetChunkForEntity(id, row);
+        if (!chunk) continue;
+
+        Vector3 position = {chunk->posX[row], chunk->posY[row], chunk->posZ[row]};
+        QueryRadius(position, ITEM_MERGE_RADIUS, nearby);
+        for (EntityId other : nearby) {
+            int otherRow;
+            EntityChunk* otherChunk = GetChunkForEntity(other, otherRow);
+            if (other == id || !otherChunk || !otherChunk->Has(COMPONENT_ITEM) || !otherChunk->sleeping[otherRow]) continue;
+            if (otherChunk->itemType[otherRow] != chunk->itemType[row]) continue;
+            if (otherChunk->itemCount[otherRow] + chunk->itemCount[row] > MAX_ITEM_STACK) continue;
+
+            Vector3 otherPosition = {otherChunk->posX[otherRow], otherChunk->posY[otherRow], otherChunk->posZ[otherRow]};
+            if (Vector3Distance(position, otherPosition) > ITEM_MERGE_RADIUS) continue;
+
+            int count = otherChunk->itemCount[otherRow];
+            Destroy(other);
+            chunk = GetChunkForEntity(id, row);
+            chunk->itemCount[row] += count;
+        }
+    }
+}
+
+void EntityWorld::WakeItemsNear(const std::vector<BlockEdit>& edits) {
+    std::vector<EntityId> nearby;
+    for (const BlockEdit& edit : edits) {
+        BoundingBox box = {{edit.x - 1.5f, edit.y - 1.5f, edit.z - 1.5f}, {edit.x + 1.5f, edit.y + 1.5f, edit.z + 1.5f}};
+        QueryAABB(box, nearby);
+        for (EntityId id : nearby) {
+            int row;
+            EntityChunk* chunk = GetChunkForEntity(id, row);
+            if (chunk && chunk->Has(COMPONENT_ITEM)) {
+                chunk->sleeping[row] = 0;
+                chunk->restTime[row] = 0.0f;
+                if (chunk->filed[row]) {
+                    // Left in the sleeper grid until the next refile; queries skip it
+                    chunk->filed[row] = 0;
+                    staleSleepers++;
+                }
+            }
+        }
+    }
+}
+
+void EntityWorld::UpdateLifetimes(float deltaTime) {
+    ForEachChunk(COMPONENT_LIFETIME, [&](EntityChunk& chunk) {
+        for (int i = 0; i < chunk.count; i++) {
+            chunk.lifetime[i] -= deltaTime;
+            if (chunk.lifetime[i] <= 0.0f) {
+                chunk.pendingDestroy.push_back(i);
+            }
+        }
+    });
+
+    FlushPendingDestroys();
+}
+
+void EntityWorld::Update(float deltaTime, const VoxelWorld* world) {
+    RebuildSpatialGrid();
+    UpdateMobs(deltaTime);
+    UpdatePhysics(deltaTime, world);
+    MergeItemStacks();
+    UpdateLifetimes(deltaTime);
+}
+
+void EntityWorld::Draw() const {
+    for (const auto& archetype : archetypes) {
+        Color color = WHITE;
+        Vector3 size = {0.25f, 0.25f, 0.25f};
+        if (archetype->componentMask & COMPONENT_MOB) {
+            color = MAROON;
+            size = (Vector3){0.6f, 1.0f, 0.6f};
+        } else if (archetype->componentMask & COMPONENT_PROJECTILE) {
+            color = DARKGRAY;
+            size = (Vector3){0.1f, 0.1f, 0.1f};
+        }
+
+        for (const auto& chunk : archetype->chunks) {
+            for (int i = 0; i < chunk->count; i++) {
+                // Positions are at the feet, cubes are drawn around their center
+                Vector3 center = {chunk->posX[i], chunk->posY[i] + size.y * 0.5f, chunk->posZ[i]};
+                DrawCubeV(center, size, color);
+            }
+        }
+    }
+}
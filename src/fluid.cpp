@@ -0,0 +1,249 @@
+#include "../include/fluid.h"
+#include "../include/job_system.h"
+#include <algorithm>
+
+static const int HORIZONTAL_OFFSETS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+FluidSimulator::FluidSimulator(VoxelWorld* world, int budgetPerStep)
+    : world(world), listenerId(-1), budgetPerStep(budgetPerStep), tickCount(0), processedLastStep(0),
+      nextChunk(0) {
+    chunkFluids.resize(world->GetWidth() * world->GetDepth());
+
+    listenerId = world->AddEditListener([this](int, int, const std::vector<BlockEdit>& edits) {
+        OnChunkEdited(edits);
+    });
+
+    // Pick up water that was placed before the simulator existed
+    for (int x = 0; x < world->GetWidth() * VoxelChunk::CHUNK_SIZE; x++) {
+        for (int z = 0; z < world->GetDepth() * VoxelChunk::CHUNK_SIZE; z++) {
+            for (int y = 0; y < VoxelChunk::CHUNK_HEIGHT; y++) {
+                if (world->GetVoxel(x, y, z).type == VOXEL_WATER) {
+                    Activate(x, y, z);
+                }
+            }
+        }
+    }
+}
+
+FluidSimulator::~FluidSimulator() {
+    world->RemoveEditListener(listenerId);
+}
+
+FluidSimulator::ChunkFluid* FluidSimulator::GetChunkFluid(int chunkX, int chunkZ) {
+    if (chunkX < 0 || chunkX >= world->GetWidth() || chunkZ < 0 || chunkZ >= world->GetDepth()) {
+        return nullptr;
+    }
+    return &chunkFluids[chunkX * world->GetDepth() + chunkZ];
+}
+
+void FluidSimulator::Activate(int worldX, int worldY, int worldZ) {
+    if (worldY < 0 || worldY >= VoxelChunk::CHUNK_HEIGHT) return;
+
+    int chunkX, chunkZ, localX, localZ;
+    world->WorldToChunkCoords(worldX, worldZ, chunkX, chunkZ, localX, localZ);
+    ChunkFluid* fluid = GetChunkFluid(chunkX, chunkZ);
+    if (!fluid) return;
+
+    int cell = VoxelChunk::CellIndex(localX, worldY, localZ);
+    if (!fluid->queued.test(cell)) {
+        fluid->queued.set(cell);
+        fluid->active.push_back((uint16_t)cell);
+    }
+}
+
+void FluidSimulator::OnChunkEdited(const std::vector<BlockEdit>& edits) {
+    static const int offsets[7][3] = {
+        {0, 0, 0}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+    };
+
+    for (const BlockEdit& edit : edits) {
+        for (int i = 0; i < 7; i++) {
+            int x = edit.x + offsets[i][0];
+            int y = edit.y + offsets[i][1];
+            int z = edit.z + offsets[i][2];
+            if (world->GetVoxel(x, y, z).type == VOXEL_WATER) {
+                Activate(x, y, z);
+            }
+        }
+    }
+}
+
+void FluidSimulator::UpdateCell(int x, int y, int z, std::vector<BlockEdit>& edits) const {
+    Voxel self = world->GetVoxel(x, y, z);
+    if (self.type != VOXEL_WATER) return;
+    uint8_t level = self.metadata;
+
+    // Flowing water has to be fed from above or by a stronger neighbor
+    if (level != WATER_SOURCE_LEVEL) {
+        int expected;
+        if (world->GetVoxel(x, y + 1, z).type == VOXEL_WATER) {
+            expected = 1;
+        } else {
+            int strongest = WATER_MAX_LEVEL;
+            for (int i = 0; i < 4; i++) {
+                Voxel neighbor = world->GetVoxel(x + HORIZONTAL_OFFSETS[i][0], y, z + HORIZONTAL_OFFSETS[i][1]);
+                if (neighbor.type == VOXEL_WATER && neighbor.metadata < strongest) {
+                    strongest = neighbor.metadata;
+                }
+            }
+            expected = strongest + 1;
+        }
+
+        if (expected > WATER_MAX_LEVEL) {
+            edits.emplace_back(x, y, z, VOXEL_AIR);
+            return;
+        }
+        if (expected != level) {
+            // The edit wakes this cell again, so spreading waits for the next step
+            edits.emplace_back(x, y, z, VOXEL_WATER, (uint8_t)expected);
+            return;
+        }
+    }
+
+    // Falling takes priority over spreading
+    if (y > 0) {
+        Voxel below = world->GetVoxel(x, y - 1, z);
+        if (below.type == VOXEL_AIR) {
+            edits.emplace_back(x, y - 1, z, VOXEL_WATER, (uint8_t)1);
+            return;
+        }
+        if (below.type == VOXEL_WATER) {
+            return;
+        }
+    }
+
+    if (level >= WATER_MAX_LEVEL) return;
+
+    uint8_t spreadLevel = (uint8_t)(level + 1);
+    for (int i = 0; i < 4; i++) {
+        int nx = x + HORIZONTAL_OFFSETS[i][0];
+        int nz = z + HORIZONTAL_OFFSETS[i][1];
+        Voxel neighbor = world->GetVoxel(nx, y, nz);
+        if (neighbor.type == VOXEL_AIR ||
+            (neighbor.type == VOXEL_WATER && neighbor.metadata > spreadLevel)) {
+            edits.emplace_back(nx, y, nz, VOXEL_WATER, spreadLevel);
+        }
+    }
+}
+
+int FluidSimulator::RunPhase(int phase, const std::vector<int>& quotas) {
+    int depth = world->GetDepth();
+
+    // Workers hold the chunk and the neighbors its cells flow into; a chunk that isn't
+    // loaded right now keeps its cells queued for a later step
+    std::vector<int> phaseChunks;
+    std::vector<ChunkHandle> held;
+    for (int i = 0; i < (int)chunkFluids.size(); i++) {
+        int chunkX = i / depth;
+        int chunkZ = i % depth;
+        if (((chunkX + chunkZ) & 1) == phase && quotas[i] > 0 && world->AcquireChunkArea(chunkX, chunkZ, held)) {
+            phaseChunks.push_back(i);
+        }
+    }
+    if (phaseChunks.empty()) return 0;
+
+    // Same-phase chunks never share a face, and nothing is written until the
+    // whole phase has been computed, so workers only ever read the world
+    std::vector<std::vector<BlockEdit>> chunkEdits(phaseChunks.size());
+    std::vector<int> chunkProcessed(phaseChunks.size(), 0);
+
+    JobSystem::Get().ParallelFor((int)phaseChunks.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int index = phaseChunks[i];
+            ChunkFluid& fluid = chunkFluids[index];
+            int baseX = (index / depth) * VoxelChunk::CHUNK_SIZE;
+            int baseZ = (index % depth) * VoxelChunk::CHUNK_SIZE;
+
+            // Whatever isn't taken stays queued for the next step
+            int count = quotas[index];
+            for (int c = 0; c < count; c++) {
+                int cell = fluid.active.front();
+                fluid.active.pop_front();
+                fluid.queued.reset(cell);
+
+                int localX, y, localZ;
+                VoxelChunk::CellCoords(cell, localX, y, localZ);
+                UpdateCell(baseX + localX, y, baseZ + localZ, chunkEdits[i]);
+            }
+            chunkProcessed[i] = count;
+        }
+    });
+
+    std::vector<BlockEdit> edits;
+    int processed = 0;
+    for (size_t i = 0; i < chunkEdits.size(); i++) {
+        edits.insert(edits.end(), chunkEdits[i].begin(), chunkEdits[i].end());
+        processed += chunkProcessed[i];
+    }
+
+    // Diagonal chunks can both flow into a shared neighbor's corner cell:
+    // keep one edit per cell, preferring water over air and stronger water over weaker
+    std::sort(edits.begin(), edits.end(), [](const BlockEdit& a, const BlockEdit& b) {
+        if (a.x != b.x) return a.x < b.x;
+        if (a.y != b.y) return a.y < b.y;
+        if (a.z != b.z) return a.z < b.z;
+        if (a.type != b.type) return a.type == VOXEL_WATER;
+        return a.metadata < b.metadata;
+    });
+    edits.erase(std::unique(edits.begin(), edits.end(), [](const BlockEdit& a, const BlockEdit& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }), edits.end());
+
+    world->ApplyEdits(edits);
+    return processed;
+}
+
+void FluidSimulator::SplitBudget(std::vector<int>& quotas) {
+    int chunkCount = (int)chunkFluids.size();
+    quotas.assign(chunkCount, 0);
+
+    // Active chunks in round-robin order, so the ones that only get part of the
+    // remainder this step are first in line next step
+    std::vector<int> pending;
+    for (int n = 0; n < chunkCount; n++) {
+        int i = (nextChunk + n) % chunkCount;
+        if (!chunkFluids[i].active.empty()) pending.push_back(i);
+    }
+
+    // Even shares, handing what a nearly settled chunk can't use to the others,
+    // until the budget or the active cells run out
+    int remaining = budgetPerStep;
+    while (remaining > 0 && !pending.empty()) {
+        int share = remaining / (int)pending.size();
+        if (share == 0) {
+            for (int n = 0; n < remaining; n++) {
+                quotas[pending[n]]++;
+            }
+            nextChunk = (pending[remaining - 1] + 1) % chunkCount;
+            return;
+        }
+
+        std::vector<int> unfilled;
+        for (int i : pending) {
+            int take = std::min(share, (int)chunkFluids[i].active.size() - quotas[i]);
+            quotas[i] += take;
+            remaining -= take;
+            if (quotas[i] < (int)chunkFluids[i].active.size()) unfilled.push_back(i);
+        }
+        pending.swap(unfilled);
+    }
+}
+
+void FluidSimulator::Tick() {
+    if (tickCount++ % FLOW_INTERVAL != 0) return;
+
+    std::vector<int> quotas;
+    SplitBudget(quotas);
+
+    processedLastStep = 0;
+    processedLastStep += RunPhase(0, quotas);
+    processedLastStep += RunPhase(1, quotas);
+}
+
+int FluidSimulator::GetActiveCellCount() const {
+    int total = 0;
+    for (const ChunkFluid& fluid : chunkFluids) {
+        total += (int)fluid.active.size();
+    }
+    return total;
+}
@@ -0,0 +1,259 @@
+#include "../include/icon_atlas.h"
+#include "../include/inventory.h"
+#include "../include/texture_manager.h"
+#include "../include/voxel.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+    // Isometric cube in 16x16 icon units, each face a parallelogram origin + u*a + v*b
+    // with (u, v) being the texture coordinates across the face
+    struct IsoFace {
+        Vector2 origin, a, b;
+        float shade;
+        int face;
+    };
+
+    const IsoFace ISO_FACES[3] = {
+        {{0, 4}, {8, -4}, {8, 4}, 1.0f, FACE_TOP},
+        {{0, 4}, {8, 4}, {0, 8}, 0.8f, FACE_FRONT},
+        {{8, 8}, {8, -4}, {0, 8}, 0.6f, FACE_RIGHT},
+    };
+
+    // Decoded RGBA texels of a source image
+    struct SourceImage {
+        std::vector<Color> pixels;
+        int width = 0, height = 0;
+
+        Color Sample(float u, float v) const {
+            int x = std::min((int)(u * width), width - 1);
+            int y = std::min((int)(v * height), height - 1);
+            return pixels[y * width + x];
+        }
+    };
+
+    bool LoadSourceImage(const std::string& path, SourceImage& out) {
+        if (path.empty()) return false;
+        Image image = LoadImage(path.c_str());
+        Color* colors = image.data ? LoadImageColors(image) : nullptr;
+        if (colors) {
+            out.width = image.width;
+            out.height = image.height;
+            out.pixels.assign(colors, colors + image.width * image.height);
+            UnloadImageColors(colors);
+        }
+        UnloadImage(image);
+        return !out.pixels.empty();
+    }
+
+    void Blit(std::vector<Color>& dst, int dstWidth, const SourceImage& src,
+              int srcX, int srcY, int width, int height, int dstX, int dstY) {
+        for (int y = 0; y < height && srcY + y < src.height; y++) {
+            for (int x = 0; x < width && srcX + x < src.width; x++) {
+                dst[(dstY + y) * dstWidth + dstX + x] = src.pixels[(srcY + y) * src.width + srcX + x];
+            }
+        }
+    }
+}
+
+IconAtlas::IconAtlas() : texture({0}), hasIcon(MAX_ICONS, false), uiRow(0) {
+}
+
+IconAtlas::~IconAtlas() {
+    Unload();
+}
+
+Rectangle IconAtlas::IconRect(int itemId) const {
+    return {(float)((itemId % ICON_COLUMNS) * ICON_SIZE), (float)((itemId / ICON_COLUMNS) * ICON_SIZE),
+            ICON_SIZE, ICON_SIZE};
+}
+
+Rectangle IconAtlas::DigitRect(int digit) const {
+    return {(float)(HOTBAR_WIDTH + SELECTION_SIZE + digit * DIGIT_WIDTH), (float)uiRow, DIGIT_WIDTH, DIGIT_HEIGHT};
+}
+
+bool IconAtlas::HasIcon(int itemId) const {
+    return itemId > 0 && itemId < MAX_ICONS && hasIcon[itemId];
+}
+
+void IconAtlas::Generate(const TextureManager* textureManager, std::vector<Color>& pixels) {
+    std::unordered_map<std::string, SourceImage> sources;
+    auto getSource = [&](const std::string& name) -> const SourceImage* {
+        auto it = sources.find(name);
+        if (it == sources.end()) {
+            it = sources.emplace(name, SourceImage()).first;
+            LoadSourceImage(textureManager->GetTexturePath(name), it->second);
+        }
+        return it->second.pixels.empty() ? nullptr : &it->second;
+    };
+
+    // Inverse-map every icon pixel onto the cube face covering it
+    const float unitsPerPixel = 16.0f / ICON_SIZE;
+    for (int id = 1; id < MAX_ICONS; id++) {
+        if (!hasIcon[id]) continue;
+        const BlockData* block = textureManager->GetBlockData(id);
+        Rectangle cell = IconRect(id);
+
+        for (const IsoFace& face : ISO_FACES) {
+            const SourceImage* source = getSource(textureManager->GetTextureNameForVoxel(id, face.face));
+            if (!source) continue;
+            float det = face.a.x * face.b.y - face.a.y * face.b.x;
+
+            for (int py = 0; py < ICON_SIZE; py++) {
+                for (int px = 0; px < ICON_SIZE; px++) {
+                    float dx = (px + 0.5f) * unitsPerPixel - face.origin.x;
+                    float dy = (py + 0.5f) * unitsPerPixel - face.origin.y;
+                    float u = (dx * face.b.y - dy * face.b.x) / det;
+                    float v = (face.a.x * dy - face.a.y * dx) / det;
+                    if (u < 0.0f || u >= 1.0f || v < 0.0f || v >= 1.0f) continue;
+
+                    Color texel = source->Sample(u, v);
+                    if (texel.a == 0) continue;
+                    float r = texel.r * face.shade * block->tintColor.r / 255.0f;
+                    float g = texel.g * face.shade * block->tintColor.g / 255.0f;
+                    float b = texel.b * face.shade * block->tintColor.b / 255.0f;
+                    pixels[((int)cell.y + py) * ATLAS_WIDTH + (int)cell.x + px] =
+                        {(unsigned char)r, (unsigned char)g, (unsigned char)b, texel.a};
+                }
+            }
+        }
+    }
+
+    // Hotbar frame and selection box from widgets.png
+    SourceImage widgets;
+    if (LoadSourceImage(textureManager->GetTexturePath("widgets"), widgets)) {
+        Blit(pixels, ATLAS_WIDTH, widgets, 0, 0, HOTBAR_WIDTH, HOTBAR_HEIGHT, 0, uiRow);
+        Blit(pixels, ATLAS_WIDTH, widgets, 0, HOTBAR_HEIGHT, SELECTION_SIZE, SELECTION_SIZE, HOTBAR_WIDTH, uiRow);
+    }
+
+    // Stack count digits in the default font, white so they can be tinted for the shadow
+    for (int digit = 0; digit < 10; digit++) {
+        Image glyph = ImageText(TextFormat("%d", digit), DIGIT_HEIGHT, WHITE);
+        SourceImage glyphPixels;
+        Color* colors = glyph.data ? LoadImageColors(glyph) : nullptr;
+        if (colors) {
+            glyphPixels.width = glyph.width;
+            glyphPixels.height = glyph.height;
+            glyphPixels.pixels.assign(colors, colors + glyph.width * glyph.height);
+            UnloadImageColors(colors);
+            Rectangle rect = DigitRect(digit);
+            Blit(pixels, ATLAS_WIDTH, glyphPixels, 0, 0, DIGIT_WIDTH, DIGIT_HEIGHT, (int)rect.x, uiRow);
+        }
+        UnloadImage(glyph);
+    }
+}
+
+bool IconAtlas::Load(const TextureManager* textureManager, const std::string& cachePath,
+                     const std::string& blockDataPath) {
+    Unload();
+
+    int highestId = 0;
+    for (int id = 1; id < MAX_ICONS; id++) {
+        hasIcon[id] = textureManager->GetBlockData(id) != nullptr;
+        if (hasIcon[id]) highestId = id;
+    }
+    uiRow = (highestId / ICON_COLUMNS + 1) * ICON_SIZE;
+    int atlasHeight = uiRow + SELECTION_SIZE;
+
+    // The cache is stale if any input is newer than it
+    long newestSource = GetFileModTime(blockDataPath.c_str());
+    std::vector<std::string> sourcePaths = {textureManager->GetTexturePath("widgets")};
+    for (int id = 1; id <= highestId; id++) {
+        if (!hasIcon[id]) continue;
+        sourcePaths.push_back(textureManager->GetTexturePath(textureManager->GetTextureNameForVoxel(id, FACE_TOP)));
+        sourcePaths.push_back(textureManager->GetTexturePath(textureManager->GetTextureNameForVoxel(id, FACE_FRONT)));
+    }
+    for (const std::string& path : sourcePaths) {
+        if (!path.empty()) newestSource = std::max(newestSource, GetFileModTime(path.c_str()));
+    }
+
+    Image atlas = {0};
+    if (FileExists(cachePath.c_str()) && GetFileModTime(cachePath.c_str()) >= newestSource) {
+        atlas = LoadImage(cachePath.c_str());
+        if (atlas.width != ATLAS_WIDTH || atlas.height != atlasHeight) {
+            UnloadImage(atlas);  // Block ids changed since it was written
+            atlas = {0};
+        }
+    }
+
+    if (!atlas.data) {
+        std::vector<Color> pixels(ATLAS_WIDTH * atlasHeight, BLANK);
+        Generate(textureManager, pixels);
+
+        atlas = GenImageColor(ATLAS_WIDTH, atlasHeight, BLANK);
+        if (!atlas.data) return false;
+        std::copy(pixels.begin(), pixels.end(), (Color*)atlas.data);
+
+        std::string directory = GetDirectoryPath(cachePath.c_str());
+        if (!directory.empty() && !DirectoryExists(directory.c_str())) {
+            MakeDirectory(directory.c_str());
+        }
+        if (ExportImage(atlas, cachePath.c_str())) {
+            std::cout << "Generated icon atlas: " << cachePath << std::endl;
+        }
+    }
+
+    texture = LoadTextureFromImage(atlas);
+    UnloadImage(atlas);
+    return texture.id != 0;
+}
+
+void IconAtlas::Unload() {
+    if (texture.id != 0) {
+        UnloadTexture(texture);
+        texture = {0};
+    }
+}
+
+void IconAtlas::DrawIcon(int itemId, Rectangle dest, Color tint) const {
+    if (!HasIcon(itemId)) return;
+    DrawTexturePro(texture, IconRect(itemId), dest, {0, 0}, 0.0f, tint);
+}
+
+void IconAtlas::DrawCount(int count, float right, float bottom, float scale) const {
+    // Right-aligned, with a one-pixel drop shadow like the original UI
+    char text[12];
+    int length = snprintf(text, sizeof(text), "%d", count);
+    float width = DIGIT_WIDTH * scale;
+    float x = right - length * width;
+    float y = bottom - DIGIT_HEIGHT * scale;
+
+    for (int i = 0; i < length; i++) {
+        Rectangle source = DigitRect(text[i] - '0');
+        DrawTexturePro(texture, source, {x + i * width + scale, y + scale, width, DIGIT_HEIGHT * scale},
+                       {0, 0}, 0.0f, DARKGRAY);
+        DrawTexturePro(texture, source, {x + i * width, y, width, DIGIT_HEIGHT * scale}, {0, 0}, 0.0f, WHITE);
+    }
+}
+
+void IconAtlas::DrawHotbar(const Inventory& inventory, int centerX, int y, int selectedSlot) const {
+    if (!IsLoaded()) return;
+
+    const float SCALE = 2.0f;
+    const float SLOT_SIZE = 20 * SCALE;
+    const float ICON_DRAW_SIZE = 16 * SCALE;
+    float startX = centerX - Inventory::HOTBAR_SLOTS * SLOT_SIZE / 2;
+
+    // Every call below samples the same texture, so raylib keeps them in one batch
+    DrawTexturePro(texture, HotbarRect(), {startX - 4, (float)y, HOTBAR_WIDTH * SCALE, HOTBAR_HEIGHT * SCALE},
+                   {0, 0}, 0.0f, WHITE);
+
+    for (int i = 0; i < Inventory::HOTBAR_SLOTS; i++) {
+        const ItemStack& stack = inventory.GetSlot(i);
+        if (stack.IsEmpty()) continue;
+
+        float slotX = startX + i * SLOT_SIZE;
+        float iconX = slotX + (SLOT_SIZE - ICON_DRAW_SIZE) / 2 - 2;
+        float iconY = y + (HOTBAR_HEIGHT * SCALE - ICON_DRAW_SIZE) / 2;
+        DrawIcon(stack.itemId, {iconX, iconY, ICON_DRAW_SIZE, ICON_DRAW_SIZE});
+        if (stack.count > 1) {
+            DrawCount(stack.count, iconX + ICON_DRAW_SIZE + 2, iconY + ICON_DRAW_SIZE + 2, SCALE);
+        }
+    }
+
+    float highlightX = startX + selectedSlot * SLOT_SIZE - 2;
+    DrawTexturePro(texture, SelectionRect(), {highlightX, (float)(y - 2), SELECTION_SIZE * SCALE, SELECTION_SIZE * SCALE},
+                   {0, 0}, 0.0f, WHITE);
+}
@@ -0,0 +1,69 @@
+#include "../include/inventory.h"
+#include <algorithm>
+
+Inventory::Inventory() : slots(SLOT_COUNT), selectedSlot(0) {
+}
+
+void Inventory::AdjustTotal(int itemId, int delta) {
+    if (delta == 0) return;
+
+    int& total = totals[itemId];
+    total += delta;
+    if (changeListener) {
+        changeListener(itemId, total);
+    }
+}
+
+int Inventory::Add(int itemId, int count, uint8_t metadata) {
+    if (itemId == 0 || count <= 0) return count;
+    int remaining = count;
+
+    // Top up matching stacks first, then fill empty slots (hotbar first)
+    for (int pass = 0; pass < 2 && remaining > 0; pass++) {
+        for (ItemStack& stack : slots) {
+            bool matches = pass == 0 ? (!stack.IsEmpty() && stack.itemId == itemId && stack.metadata == metadata)
+                                     : stack.IsEmpty();
+            if (!matches) continue;
+
+            if (pass == 1) stack = ItemStack(itemId, 0, metadata);
+            int moved = std::min(remaining, MAX_STACK - stack.count);
+            stack.count += moved;
+            remaining -= moved;
+            if (remaining == 0) break;
+        }
+    }
+
+    AdjustTotal(itemId, count - remaining);
+    return remaining;
+}
+
+int Inventory::Remove(int itemId, int count) {
+    int removed = 0;
+
+    // Take from the back so the hotbar is emptied last
+    for (int i = SLOT_COUNT - 1; i >= 0 && removed < count; i--) {
+        ItemStack& stack = slots[i];
+        if (stack.IsEmpty() || stack.itemId != itemId) continue;
+
+        int taken = std::min(count - removed, stack.count);
+        stack.count -= taken;
+        removed += taken;
+        if (stack.count == 0) stack = ItemStack();
+    }
+
+    AdjustTotal(itemId, -removed);
+    return removed;
+}
+
+void Inventory::SetSlot(int slot, const ItemStack& stack) {
+    ItemStack old = slots[slot];
+    slots[slot] = stack.IsEmpty() ? ItemStack() : stack;
+
+    if (!old.IsEmpty()) AdjustTotal(old.itemId, -old.count);
+    if (!stack.IsEmpty()) AdjustTotal(stack.itemId, stack.count);
+}
+
+int Inventory::GetTotal(int itemId) const {
+    auto it = totals.find(itemId);
+    return it != totals.end() ? it->second : 0;
+}
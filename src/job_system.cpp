@@ -0,0 +1,236 @@
+#include "../include/job_system.h"
+#include <algorithm>
+
+namespace {
+    // Which worker of which system the current thread is, so submissions from
+    // inside a job go on that worker's own deque
+    thread_local const JobSystem* currentSystem = nullptr;
+    thread_local int currentWorker = -1;
+}
+
+bool JobCounter::IsDone() const {
+    if (pending.load(std::memory_order_acquire) != 0) return false;
+    // The last Release holds the lock while it finishes with the counter, so once
+    // this returns true the owner may destroy it
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem(int workerCount)
+    : queuedTasks(0), nextQueue(0), sleepingWorkers(0), shuttingDown(false), mainThreadId(std::this_thread::get_id()),
+      mainThreadTasks(MAIN_THREAD_QUEUE_CAPACITY) {
+    if (workerCount <= 0) {
+        int hardwareThreads = (int)std::thread::hardware_concurrency();
+        workerCount = std::max(1, hardwareThreads - 1);
+    }
+
+    // All queues exist before any worker starts stealing from them
+    for (int i = 0; i < workerCount; i++) {
+        queues.emplace_back(new WorkerQueue());
+    }
+    workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        shuttingDown = true;
+    }
+    workAvailable.notify_all();
+
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+JobSystem& JobSystem::Get() {
+    static JobSystem instance;
+    return instance;
+}
+
+void JobSystem::Enqueue(Task task, JobPriority priority) {
+    int target = (currentSystem == this) ? currentWorker : (int)(nextQueue.fetch_add(1) % queues.size());
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks[priority].push_back(std::move(task));
+    }
+    // Sequentially consistent with the sleeper count: either a worker going to
+    // sleep sees this task, or we see it sleeping and wake it
+    queuedTasks.fetch_add(1);
+    if (sleepingWorkers.load() > 0) {
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        workAvailable.notify_one();
+    }
+}
+
+void JobSystem::EnqueueMainThread(Task task) {
+    // Full means the main thread is behind; wait for it, or catch up if we are it
+    while (!mainThreadTasks.TryPush(task)) {
+        if (IsMainThread()) {
+            RunMainThreadJobs();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::Submit(Job job, JobPriority priority, JobCounter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    Enqueue(Task{std::move(job), counter}, priority);
+}
+
+void JobSystem::SubmitMainThreadAfter(JobCounter& dependency, Job job, JobCounter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.pending.load(std::memory_order_acquire) != 0) {
+            dependency.continuations.push_back(JobCounter::Continuation{std::move(job), counter});
+            return;
+        }
+    }
+    EnqueueMainThread(Task{std::move(job), counter});
+}
+
+void JobSystem::Release(JobCounter* counter) {
+    if (!counter) return;
+
+    // Decrements that can't be the last one skip the lock
+    int value = counter->pending.load(std::memory_order_relaxed);
+    while (value > 1) {
+        if (counter->pending.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel)) return;
+    }
+
+    // Probably the last: under the lock, so IsDone can't report zero while we still use the counter
+    std::vector<JobCounter::Continuation> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->continuations);
+        }
+    }
+
+    // The counter may be gone by now; only the moved-out continuations are used
+    for (JobCounter::Continuation& continuation : ready) {
+        EnqueueMainThread(Task{std::move(continuation.job), continuation.counter});
+    }
+}
+
+void JobSystem::Run(Task& task) {
+    task.job();
+    Release(task.counter);
+}
+
+bool JobSystem::TryTakeTask(Task& task, JobPriority lowestPriority) {
+    if (queuedTasks.load(std::memory_order_acquire) == 0) return false;
+
+    int self = (currentSystem == this) ? currentWorker : -1;
+    int queueCount = (int)queues.size();
+    for (int priority = 0; priority <= lowestPriority; priority++) {
+        // Own deque newest first
+        if (self >= 0) {
+            WorkerQueue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            std::deque<Task>& tasks = own.tasks[priority];
+            if (!tasks.empty()) {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        // Then steal the oldest, starting past ourselves so thieves spread out
+        for (int i = 1; i <= queueCount; i++) {
+            int victim = (self + i + queueCount) % queueCount;
+            if (victim == self) continue;
+            WorkerQueue& other = *queues[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            std::deque<Task>& tasks = other.tasks[priority];
+            if (!tasks.empty()) {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void JobSystem::WorkerLoop(int workerIndex) {
+    currentSystem = this;
+    currentWorker = workerIndex;
+
+    while (true) {
+        Task task;
+        if (TryTakeTask(task)) {
+            Run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1);
+        workAvailable.wait(lock, [this] { return shuttingDown || queuedTasks.load() > 0; });
+        sleepingWorkers.fetch_sub(1);
+        if (shuttingDown && queuedTasks.load() == 0) return;
+    }
+}
+
+int JobSystem::RunMainThreadJobs() {
+    std::vector<Task> tasks;
+    mainThreadTasks.PopBatch(tasks, mainThreadTasks.GetCapacity());
+    for (Task& task : tasks) {
+        Run(task);
+    }
+    return (int)tasks.size();
+}
+
+void JobSystem::Wait(JobCounter& counter, JobPriority helpWith) {
+    bool mainThread = IsMainThread();
+    while (!counter.IsDone()) {
+        Task task;
+        if (TryTakeTask(task, helpWith)) {
+            Run(task);
+        } else if (!mainThread || RunMainThreadJobs() == 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(int count, int batchSize, const std::function<void(int begin, int end)>& fn) {
+    if (count <= 0) return;
+    if (batchSize <= 0) batchSize = 1;
+
+    int batchCount = (count + batchSize - 1) / batchSize;
+
+    // Not worth the hand-off for a single batch
+    if (batchCount == 1 || workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    // The caller is waiting, so the batches jump ahead of background work
+    JobCounter batches;
+    for (int batch = 1; batch < batchCount; batch++) {
+        int begin = batch * batchSize;
+        int end = std::min(count, begin + batchSize);
+        Submit([&fn, begin, end]() { fn(begin, end); }, JOB_HIGH, &batches);
+    }
+
+    // The calling thread takes the first batch, then helps with the rest. Only
+    // with HIGH jobs: a long background job picked up here would stall the caller.
+    fn(0, std::min(count, batchSize));
+    while (!batches.IsDone()) {
+        Task task;
+        if (TryTakeTask(task, JOB_HIGH)) {
+            Run(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,464 @@
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/ring_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// Load tester: N simulated players against a server, with a report of how it held up.
+//
+// By default the server runs in this process on its own thread at the normal tick
+// rate, and the bots connect over loopback or local TCP, so a whole run fits on
+// one machine and the server's tick times can be measured. With --connect the
+// bots join an external server instead and only client-side numbers are reported.
+//
+// Each bot walks a random or circular path, reports its position every tick and
+// places and breaks blocks near itself at the given rates. Action latency is the
+// time from sending a request to seeing the change in the bot's copy of the world,
+// i.e. what a player would feel. Bots keep a client world each (32 KB per
+// resident chunk, a few hundred bytes once cold and compressed), so very large
+// worlds x many bots need memory to match.
+//
+// Nothing opens a window or links raylib, so it runs on a headless Linux box too:
+// see the "build load test (linux)" task.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        int bots = 16;
+        float seconds = 30.0f;
+        std::string transport = "loopback";  // loopback | tcp
+        std::string connectHost;             // Non-empty: external server
+        int port = DEFAULT_SERVER_PORT;
+        int width = 16, depth = 16;
+        int viewDistance = 8;
+        std::string path = "random";         // random | circle
+        float speed = 5.0f;                  // Blocks per second
+        float placeRate = 0.5f;              // Per bot per second
+        float breakRate = 0.5f;
+        int bandwidthLimit = GameServer::DEFAULT_BANDWIDTH_LIMIT;  // Bytes per second per TCP client
+        uint32_t seed = 1;
+        float coldSeconds = VoxelWorld::DEFAULT_COLD_CHUNK_SECONDS;  // Server and bot worlds, 0 = off
+        std::string reportPath;
+    };
+
+    // An action whose result hasn't shown up yet
+    struct PendingAction {
+        int x, y, z;
+        VoxelType expected;
+        Clock::time_point sentAt;
+    };
+
+    struct Bot {
+        GameClient client;
+        Vector3 position;
+        Vector3 origin;      // Center of the circle path
+        float heading;
+        uint32_t rngState;
+        std::vector<PendingAction> pending;
+        std::vector<float> latenciesMs;
+        int actionsSent = 0;
+        int actionsLost = 0;  // Rejected or overwritten before we saw them
+
+        Bot() : position({0.0f, 0.0f, 0.0f}), origin({0.0f, 0.0f, 0.0f}), heading(0.0f), rngState(1) {}
+    };
+
+    const float ACTION_TIMEOUT = 5.0f;  // Seconds before a pending action counts as lost
+    const float FLY_HEIGHT = VoxelChunk::CHUNK_HEIGHT + 2.0f;
+    const int ACTION_REACH = 4;         // Blocks from the bot
+
+    std::atomic<bool> running(true);
+
+    void HandleSignal(int) {
+        running = false;
+    }
+
+    // xorshift32, as the entities use
+    uint32_t NextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float RandomFloat(uint32_t& state) {
+        return (NextRandom(state) & 0xFFFFFF) / (float)0x1000000;
+    }
+
+    float Percentile(std::vector<float> values, float fraction) {
+        if (values.empty()) return 0.0f;
+        size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    float Mean(const std::vector<float>& values) {
+        if (values.empty()) return 0.0f;
+        double sum = 0.0;
+        for (float value : values) sum += value;
+        return (float)(sum / values.size());
+    }
+
+    void PrintUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --bots N            simulated players (16)\n"
+                  << "  --seconds S         run length (30)\n"
+                  << "  --transport T       loopback | tcp, for the in-process server (loopback)\n"
+                  << "  --connect HOST      use an external server instead\n"
+                  << "  --port P            TCP port (" << DEFAULT_SERVER_PORT << ")\n"
+                  << "  --world WxD         in-process world size in chunks (16x16)\n"
+                  << "  --view N            bot view distance in chunks (8)\n"
+                  << "  --path P            random | circle (random)\n"
+                  << "  --speed V           blocks per second (5)\n"
+                  << "  --place-rate R      placements per bot per second (0.5)\n"
+                  << "  --break-rate R      breaks per bot per second (0.5)\n"
+                  << "  --bandwidth B       in-process per-client limit for TCP, bytes/s, 0 = none\n"
+                  << "  --seed S            bot randomness (1)\n"
+                  << "  --cold-seconds S    compress chunks untouched this long, 0 = never ("
+                  << VoxelWorld::DEFAULT_COLD_CHUNK_SECONDS << ")\n"
+                  << "  --report FILE       also write the report here" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) return false;
+            std::string value = argv[++i];
+
+            if (name == "--bots") options.bots = atoi(value.c_str());
+            else if (name == "--seconds") options.seconds = (float)atof(value.c_str());
+            else if (name == "--transport") options.transport = value;
+            else if (name == "--connect") options.connectHost = value;
+            else if (name == "--port") options.port = atoi(value.c_str());
+            else if (name == "--world") {
+                if (sscanf(value.c_str(), "%dx%d", &options.width, &options.depth) != 2) return false;
+            }
+            else if (name == "--view") options.viewDistance = atoi(value.c_str());
+            else if (name == "--path") options.path = value;
+            else if (name == "--speed") options.speed = (float)atof(value.c_str());
+            else if (name == "--place-rate") options.placeRate = (float)atof(value.c_str());
+            else if (name == "--break-rate") options.breakRate = (float)atof(value.c_str());
+            else if (name == "--bandwidth") options.bandwidthLimit = atoi(value.c_str());
+            else if (name == "--seed") options.seed = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+            else if (name == "--cold-seconds") options.coldSeconds = (float)atof(value.c_str());
+            else if (name == "--report") options.reportPath = value;
+            else return false;
+        }
+        return options.bots > 0 && options.seconds > 0.0f && options.width > 0 && options.depth > 0 &&
+               (options.transport == "loopback" || options.transport == "tcp") &&
+               (options.path == "random" || options.path == "circle");
+    }
+
+    void MoveBot(Bot& bot, const Options& options, float worldWidth, float worldDepth) {
+        float step = options.speed * GameServer::TICK_INTERVAL;
+        if (options.path == "circle") {
+            // Radius 32 blocks, so the view set keeps changing
+            bot.heading += step / 32.0f;
+            bot.position.x = bot.origin.x + cosf(bot.heading) * 32.0f;
+            bot.position.z = bot.origin.z + sinf(bot.heading) * 32.0f;
+        } else {
+            bot.heading += (RandomFloat(bot.rngState) - 0.5f) * 0.4f;
+            bot.position.x += cosf(bot.heading) * step;
+            bot.position.z += sinf(bot.heading) * step;
+        }
+
+        // Turn back at the world's edge
+        if (bot.position.x < 1.0f || bot.position.x > worldWidth - 1.0f) {
+            bot.position.x = std::max(1.0f, std::min(bot.position.x, worldWidth - 1.0f));
+            bot.heading = PI - bot.heading;
+        }
+        if (bot.position.z < 1.0f || bot.position.z > worldDepth - 1.0f) {
+            bot.position.z = std::max(1.0f, std::min(bot.position.z, worldDepth - 1.0f));
+            bot.heading = -bot.heading;
+        }
+    }
+
+    // Places on or breaks the top block of a random column within reach
+    void Act(Bot& bot, bool place) {
+        VoxelWorld& world = *bot.client.GetWorld();
+        int x = (int)floorf(bot.position.x) + (int)(NextRandom(bot.rngState) % (2 * ACTION_REACH + 1)) - ACTION_REACH;
+        int z = (int)floorf(bot.position.z) + (int)(NextRandom(bot.rngState) % (2 * ACTION_REACH + 1)) - ACTION_REACH;
+        if (x < 0 || z < 0 || x >= world.GetWidth() * VoxelChunk::CHUNK_SIZE || z >= world.GetDepth() * VoxelChunk::CHUNK_SIZE) return;
+
+        int top = VoxelChunk::CHUNK_HEIGHT - 1;
+        while (top >= 0 && !world.GetVoxel(x, top, z).isActive) top--;
+
+        PendingAction action;
+        if (place) {
+            if (top + 1 >= VoxelChunk::CHUNK_HEIGHT) return;
+            action = {x, top + 1, z, VOXEL_STONE, Clock::now()};
+        } else {
+            if (top < 0 || !BlockRegistry::Get().HasFlag(world.GetVoxel(x, top, z).type, BLOCK_BREAKABLE)) return;
+            action = {x, top, z, VOXEL_AIR, Clock::now()};
+        }
+        bot.client.RequestSetBlock(action.x, action.y, action.z, action.expected);
+        bot.pending.push_back(action);
+        bot.actionsSent++;
+    }
+
+    void CheckActions(Bot& bot) {
+        VoxelWorld* world = bot.client.GetWorld();
+        if (!world) return;
+
+        Clock::time_point now = Clock::now();
+        for (size_t i = 0; i < bot.pending.size();) {
+            const PendingAction& action = bot.pending[i];
+            float ageMs = std::chrono::duration<float, std::milli>(now - action.sentAt).count();
+            if (world->GetVoxel(action.x, action.y, action.z).type == action.expected) {
+                bot.latenciesMs.push_back(ageMs);
+            } else if (ageMs > ACTION_TIMEOUT * 1000.0f) {
+                bot.actionsLost++;
+            } else {
+                i++;
+                continue;
+            }
+            bot.pending[i] = bot.pending.back();
+            bot.pending.pop_back();
+        }
+    }
+
+    // The in-process server at the normal tick rate, handing every tick's duration
+    // to the bot thread
+    void RunServer(GameServer& server, std::atomic<bool>& stop, SpscRingQueue<float>& tickMs) {
+        const auto tickLength = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<float>(GameServer::TICK_INTERVAL));
+        auto nextTick = Clock::now();
+        while (!stop) {
+            server.Tick();
+            tickMs.TryPush(server.GetLastTickMs());  // Drained every few ms; a full queue only loses samples
+
+            nextTick += tickLength;
+            auto now = Clock::now();
+            if (nextTick < now) nextTick = now;
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, HandleSignal);
+    signal(SIGTERM, HandleSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Bots need block flags for their world copies even without a local server
+    BlockRegistry::Get().LoadModels();
+    BlockRegistry::Get().LoadFromJson();
+
+    std::unique_ptr<GameServer> server;
+    if (options.connectHost.empty()) {
+        server.reset(new GameServer(options.width, options.depth));
+        server->SetBandwidthLimit(options.bandwidthLimit);
+        server->GetWorld().SetColdChunkSeconds(options.coldSeconds);
+        if (options.transport == "tcp" && !server->Listen(options.port)) return 1;
+    }
+
+    // Bots start spread over the world; the server is ticked by hand until they
+    // have joined so its thread doesn't race the connects
+    std::vector<std::unique_ptr<Bot>> bots;
+    uint32_t seedState = options.seed ? options.seed : 1;
+    for (int i = 0; i < options.bots; i++) {
+        std::unique_ptr<Bot> bot(new Bot());
+        bot->rngState = NextRandom(seedState) | 1;
+        float spanX = options.width * VoxelChunk::CHUNK_SIZE, spanZ = options.depth * VoxelChunk::CHUNK_SIZE;
+        bot->position = {RandomFloat(bot->rngState) * spanX, FLY_HEIGHT, RandomFloat(bot->rngState) * spanZ};
+        bot->origin = bot->position;
+        bot->heading = RandomFloat(bot->rngState) * 2.0f * PI;
+
+        std::unique_ptr<Connection> connection;
+        if (!options.connectHost.empty()) {
+            connection = TcpConnection::Connect(options.connectHost, options.port);
+        } else if (options.transport == "tcp") {
+            connection = TcpConnection::Connect("127.0.0.1", options.port);
+            server->Tick();  // Accept
+        } else {
+            connection = server->ConnectLoopback();
+        }
+        if (!connection) return 1;
+        bot->client.Connect(std::move(connection), "bot" + std::to_string(i), bot->position, options.viewDistance);
+        bots.push_back(std::move(bot));
+    }
+
+    auto joinStart = Clock::now();
+    for (bool joined = false; !joined && running;) {
+        if (server) server->Tick(); else std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        joined = true;
+        for (auto& bot : bots) {
+            bot->client.Poll();
+            if (!bot->client.GetWorld() && bot->client.IsConnected()) joined = false;
+        }
+        if (Clock::now() - joinStart > std::chrono::seconds(30)) {
+            std::cout << "Bots could not join within 30 s" << std::endl;
+            return 1;
+        }
+    }
+    float joinMs = std::chrono::duration<float, std::milli>(Clock::now() - joinStart).count();
+    for (auto& bot : bots) {
+        if (bot->client.GetWorld()) bot->client.GetWorld()->SetColdChunkSeconds(options.coldSeconds);
+    }
+
+    // The measured run
+    std::atomic<bool> stopServer(false);
+    std::vector<float> tickMs;
+    tickMs.reserve((size_t)(options.seconds / GameServer::TICK_INTERVAL) + 64);
+    SpscRingQueue<float> tickQueue(1024);
+    std::thread serverThread;
+    if (server) serverThread = std::thread(RunServer, std::ref(*server), std::ref(stopServer), std::ref(tickQueue));
+
+    std::vector<uint64_t> startReceived, startSent;
+    for (auto& bot : bots) {
+        startReceived.push_back(bot->client.GetConnection()->GetBytesReceived());
+        startSent.push_back(bot->client.GetConnection()->GetBytesSent());
+    }
+
+    // Bots act once per tick but poll more often, so latency isn't rounded to ticks
+    const auto pollInterval = std::chrono::milliseconds(5);
+    const auto tickLength = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(GameServer::TICK_INTERVAL));
+    float placeChance = options.placeRate * GameServer::TICK_INTERVAL;
+    float breakChance = options.breakRate * GameServer::TICK_INTERVAL;
+    auto start = Clock::now();
+    auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(options.seconds));
+    auto nextBotTick = start;
+    while (running && Clock::now() < end) {
+        bool botTick = Clock::now() >= nextBotTick;
+        if (botTick) nextBotTick += tickLength;
+
+        for (auto& bot : bots) {
+            bot->client.Poll();
+            CheckActions(*bot);
+            if (!botTick || !bot->client.GetWorld() || !bot->client.IsConnected()) continue;
+
+            VoxelWorld& world = *bot->client.GetWorld();
+            MoveBot(*bot, options, (float)world.GetWidth() * VoxelChunk::CHUNK_SIZE,
+                    (float)world.GetDepth() * VoxelChunk::CHUNK_SIZE);
+            bot->client.SendPosition(bot->position);
+            if (RandomFloat(bot->rngState) < placeChance) Act(*bot, true);
+            if (RandomFloat(bot->rngState) < breakChance) Act(*bot, false);
+            world.CompressColdChunks(GameServer::TICK_INTERVAL);
+        }
+        tickQueue.PopBatch(tickMs, tickQueue.GetCapacity());
+        std::this_thread::sleep_for(pollInterval);
+    }
+    float elapsed = std::chrono::duration<float>(Clock::now() - start).count();
+
+    stopServer = true;
+    if (serverThread.joinable()) serverThread.join();
+    tickQueue.PopBatch(tickMs, tickQueue.GetCapacity());
+
+    // Report: one "key: value" per line, so runs can be diffed across versions
+    std::vector<float> latencies;
+    std::vector<float> downloadKBps, uploadKBps;
+    int actionsSent = 0, actionsLost = 0, disconnected = 0;
+    VoxelWorld::CompressionStats botCompression;
+    for (size_t i = 0; i < bots.size(); i++) {
+        Bot& bot = *bots[i];
+        if (const VoxelWorld* world = bot.client.GetWorld()) {
+            const VoxelWorld::CompressionStats& stats = world->GetCompressionStats();
+            botCompression.compressedChunks += stats.compressedChunks;
+            botCompression.bytesSaved += stats.bytesSaved;
+            botCompression.decompressions += stats.decompressions;
+            botCompression.accesses += stats.accesses;
+        }
+        latencies.insert(latencies.end(), bot.latenciesMs.begin(), bot.latenciesMs.end());
+        actionsSent += bot.actionsSent;
+        actionsLost += bot.actionsLost;
+        if (!bot.client.IsConnected()) disconnected++;
+        const Connection* connection = bot.client.GetConnection();
+        downloadKBps.push_back((connection->GetBytesReceived() - startReceived[i]) / 1024.0f / elapsed);
+        uploadKBps.push_back((connection->GetBytesSent() - startSent[i]) / 1024.0f / elapsed);
+    }
+
+    // With --connect the world size is only known from a bot that got one;
+    // bots that were dropped or never joined have none
+    int worldWidth = 0, worldDepth = 0;
+    if (server) {
+        worldWidth = server->GetWorld().GetWidth();
+        worldDepth = server->GetWorld().GetDepth();
+    } else {
+        for (auto& bot : bots) {
+            if (const VoxelWorld* world = bot->client.GetWorld()) {
+                worldWidth = world->GetWidth();
+                worldDepth = world->GetDepth();
+                break;
+            }
+        }
+    }
+
+    std::ostringstream report;
+    report.setf(std::ios::fixed);
+    report.precision(2);
+    report << "protocol_version: " << PROTOCOL_VERSION << "\n"
+           << "server: " << (server ? "in-process" : options.connectHost + ":" + std::to_string(options.port)) << "\n"
+           << "transport: " << (server ? options.transport : "tcp") << "\n"
+           << "bots: " << options.bots << "\n"
+           << "seconds: " << elapsed << "\n"
+           << "world: " << worldWidth << "x" << worldDepth << "\n"
+           << "view_distance: " << options.viewDistance << "\n"
+           << "path: " << options.path << " at " << options.speed << " blocks/s\n"
+           << "place_rate: " << options.placeRate << "\n"
+           << "break_rate: " << options.breakRate << "\n"
+           << "join_ms: " << joinMs << "\n";
+    if (server) {
+        int overruns = (int)std::count_if(tickMs.begin(), tickMs.end(), [](float ms) {
+            return ms > GameServer::TICK_INTERVAL * 1000.0f;
+        });
+        report << "ticks: " << tickMs.size() << "\n"
+               << "tick_ms_mean: " << Mean(tickMs) << "\n"
+               << "tick_ms_p50: " << Percentile(tickMs, 0.50f) << "\n"
+               << "tick_ms_p95: " << Percentile(tickMs, 0.95f) << "\n"
+               << "tick_ms_p99: " << Percentile(tickMs, 0.99f) << "\n"
+               << "tick_ms_max: " << (tickMs.empty() ? 0.0f : *std::max_element(tickMs.begin(), tickMs.end())) << "\n"
+               << "tick_overruns: " << overruns << "\n"
+               << "chunks_sent: " << server->GetChunksSent() << "\n"
+               << "chunks_from_cache: " << server->GetCachedChunksUsed() << "\n"
+               << "delta_updates: " << server->GetDeltaUpdatesSent() << "\n"
+               << "full_updates: " << server->GetFullUpdatesSent() << "\n";
+        const VoxelWorld::CompressionStats& compression = server->GetWorld().GetCompressionStats();
+        report << "server_compressed_chunks: " << compression.compressedChunks << "\n"
+               << "server_compression_saved_kb: " << compression.bytesSaved / 1024.0f << "\n"
+               << "server_compression_hit_rate: " << compression.GetHitRate() << "\n";
+    }
+    report << "actions_sent: " << actionsSent << "\n"
+           << "actions_confirmed: " << latencies.size() << "\n"
+           << "actions_lost: " << actionsLost << "\n"
+           << "latency_ms_mean: " << Mean(latencies) << "\n"
+           << "latency_ms_p50: " << Percentile(latencies, 0.50f) << "\n"
+           << "latency_ms_p95: " << Percentile(latencies, 0.95f) << "\n"
+           << "latency_ms_p99: " << Percentile(latencies, 0.99f) << "\n"
+           << "latency_ms_max: " << (latencies.empty() ? 0.0f : *std::max_element(latencies.begin(), latencies.end())) << "\n"
+           << "download_kbps_per_client_mean: " << Mean(downloadKBps) << "\n"
+           << "download_kbps_per_client_max: " << *std::max_element(downloadKBps.begin(), downloadKBps.end()) << "\n"
+           << "upload_kbps_per_client_mean: " << Mean(uploadKBps) << "\n"
+           << "download_kbps_total: " << Mean(downloadKBps) * bots.size() << "\n"
+           << "disconnected_bots: " << disconnected << "\n"
+           << "cold_seconds: " << options.coldSeconds << "\n"
+           << "bot_compressed_chunks_mean: " << (float)botCompression.compressedChunks / bots.size() << "\n"
+           << "bot_compression_saved_kb_total: " << botCompression.bytesSaved / 1024.0f << "\n"
+           << "bot_compression_hit_rate: " << botCompression.GetHitRate() << "\n";
+
+    std::cout << report.str();
+    if (!options.reportPath.empty()) {
+        std::ofstream file(options.reportPath);
+        file << report.str();
+        if (!file) {
+            std::cout << "Could not write " << options.reportPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -3,11 +3,31 @@
 #include "rlgl.h"
 #include "../include/voxel.h"
 #include "../include/texture_manager.h"
+#include "../include/entity.h"
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/navigation.h"
+#include "../include/particles.h"
+#include "../include/crafting.h"
+#include "../include/inventory.h"
+#include "../include/icon_atlas.h"
+#include "../include/job_system.h"
+#include "../include/memory_budget.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
 
-int main() {
+// rayCave              singleplayer
+// rayCave host [port]  join a server
+int main(int argc, char* argv[]) {
     // Initialize window
     InitWindow(800, 600, "rayCave - 3D World");
     
+    // Workers start here, so this thread is the job system's main thread
+    JobSystem::Get();
+    
     // Define the camera to look into our 3d world
     Camera3D camera = { 0 };
     camera.position = (Vector3){ 10.0f, 8.0f, 10.0f };    // Camera position
@@ -23,10 +43,109 @@ int main() {
     // Initialize texture manager
     TextureManager textureManager;
     
-    // Create voxel world (4x4 chunks)
-    VoxelWorld world(4, 4);
-    world.SetTextureManager(&textureManager);
-    world.GenerateTestTerrain();
+    // Singleplayer runs the simulation in an in-process server (4x4 chunks);
+    // the game is a client of it over a loopback connection
+    std::unique_ptr<GameServer> server;
+    GameClient client(&textureManager);
+    if (argc > 1) {
+        std::string host = argv[1];
+        int port = argc > 2 ? atoi(argv[2]) : DEFAULT_SERVER_PORT;
+        client.EnableChunkCache("cache/" + host + "_" + std::to_string(port));
+        client.Connect(TcpConnection::Connect(host, port), "Player", camera.position);
+    } else {
+        server.reset(new GameServer(4, 4));
+        client.Connect(server->ConnectLoopback(), "Player", camera.position);
+    }
+    while (client.IsConnected() && !client.GetWorld()) {
+        if (server) server->Tick(); else WaitTime(0.01);
+        client.Poll();
+    }
+    if (!client.GetWorld()) {
+        CloseWindow();
+        return 1;
+    }
+    VoxelWorld& world = *client.GetWorld();
+    
+    // Crafting recipes refer to blocks by name
+    RecipeBook recipes;
+    recipes.LoadFromJson([&textureManager](const std::string& name) {
+        return textureManager.FindBlockId(name);
+    });
+    CraftableSet craftable(&recipes);
+    
+    // Player inventory; the recipe book follows its item totals
+    Inventory inventory;
+    inventory.SetChangeListener([&craftable](int itemId, int total) {
+        craftable.SetItemCount(itemId, total);
+    });
+    for (const char* name : {"grass", "dirt", "stone", "cobblestone", "wood", "leaves"}) {
+        int id = textureManager.FindBlockId(name);
+        if (id > 0) inventory.Add(id, Inventory::MAX_STACK);
+    }
+    
+    // Hotbar icons, rendered once from the block textures and cached on disk
+    IconAtlas icons;
+    icons.Load(&textureManager);
+    
+    // Chunk storage and meshes stay within the default budgets. Chunks shed last are
+    // swapped out through the client, which gets them back from its cache or the server.
+    MemoryBudget memoryBudget(&world);
+    memoryBudget.SetSwapHandlers(
+        [&client](int chunkX, int chunkZ) { return client.SwapOutChunk(chunkX, chunkZ); },
+        [&client](int chunkX, int chunkZ) { return client.SwapInChunk(chunkX, chunkZ); });
+    
+    // The server ticks at a fixed rate; navigation follows the client's copy of the world
+    NavigationSystem navigation(&world);
+    const float TICK_INTERVAL = GameServer::TICK_INTERVAL;
+    float tickAccumulator = 0.0f;
+    
+    // Entities (mobs, dropped items, projectiles)
+    EntityWorld entities;
+    ParticleSystem particles;
+    
+    // Mobs head for the ground below the camera along paths searched in the background
+    struct MobPath {
+        EntityId mob;
+        std::vector<Vector3> waypoints;
+        size_t next;
+        float timeLeft;  // Gives up on a path the mob got stuck on
+    };
+    std::vector<MobPath> mobPaths;
+    std::unordered_map<int, size_t> pathRequests;  // Request id -> mobPaths index
+    std::vector<NavigationSystem::PathResult> pathResults;
+    float repathTimer = 0.0f;
+    const float REPATH_INTERVAL = 3.0f;
+    for (int i = 0; i < 32; i++) {
+        float x = (float)GetRandomValue(2, 4 * VoxelChunk::CHUNK_SIZE - 2);
+        float z = (float)GetRandomValue(2, 4 * VoxelChunk::CHUNK_SIZE - 2);
+        mobPaths.push_back({entities.SpawnMob((Vector3){x, 12.0f, z}), {}, 0, 0.0f});
+    }
+    
+    // Walking mobs kick up dust from the block under them about once a block
+    std::vector<Vector3> lastFootsteps(mobPaths.size(), (Vector3){0.0f, 0.0f, 0.0f});
+    const float FOOTSTEP_STRIDE = 1.0f;
+    
+    // Resting items sleep until a block next to them changes
+    world.AddEditListener([&entities](int, int, const std::vector<BlockEdit>& edits) {
+        entities.WakeItemsNear(edits);
+    });
+    
+    // About a quarter of the blocks an explosion destroys drop, flung away from the center
+    client.SetExplosionListener([&](Vector3 center, const std::vector<BlockEdit>& destroyed) {
+        std::vector<ItemDrop> drops;
+        for (const BlockEdit& block : destroyed) {
+            if (GetRandomValue(0, 3) != 0) continue;
+            Vector3 position = {(float)block.x, (float)block.y, (float)block.z};
+            Vector3 velocity = Vector3Scale(Vector3Normalize(Vector3Subtract(position, center)), 4.0f);
+            velocity.y += 3.0f;
+            drops.push_back({position, velocity, (int)block.type, 1});
+        }
+        entities.SpawnItems(drops);
+        
+        for (const BlockEdit& block : destroyed) {
+            particles.SpawnBlockBreak(block.x, block.y, block.z, block.type, &textureManager);
+        }
+    });
     
     // Lock cursor initially
     DisableCursor();
@@ -64,6 +183,13 @@ int main() {
             else if (IsKeyPressed(KEY_EIGHT)) selectedHotbarSlot = 7;
             else if (IsKeyPressed(KEY_NINE)) selectedHotbarSlot = 8;
             
+            // Detonate a test explosion a few blocks ahead of the camera
+            if (IsKeyPressed(KEY_X)) {
+                Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+                Vector3 center = Vector3Add(camera.position, Vector3Scale(forward, 8.0f));
+                client.RequestExplosion(center, 4.0f);
+            }
+            
             // Handle mouse wheel for hotbar selection
             float wheelMove = GetMouseWheelMove();
             if (wheelMove != 0) {
@@ -71,10 +197,105 @@ int main() {
                 if (selectedHotbarSlot < 0) selectedHotbarSlot = 8;
                 if (selectedHotbarSlot > 8) selectedHotbarSlot = 0;
             }
+            inventory.SetSelectedSlot(selectedHotbarSlot);
         }
         
+        // Run world ticks
+        if (!isPaused) {
+            tickAccumulator += GetFrameTime();
+            while (tickAccumulator >= TICK_INTERVAL) {
+                client.SendPosition(camera.position);
+                if (server) server->Tick();
+                navigation.Update();
+                tickAccumulator -= TICK_INTERVAL;
+            }
+        }
+        
+        // Apply the server's block updates to our copy of the world
+        client.Poll();
+        
+        // Work that background jobs handed back to the main thread
+        JobSystem::Get().RunMainThreadJobs();
+        
         // Update voxel world
         world.Update();
+        memoryBudget.Update(camera.position);
+        world.CompressColdChunks(GetFrameTime());
+        
+        // Update entities
+        if (!isPaused) {
+            // Ask for fresh paths every few seconds; the goal is the first open cell with
+            // ground under it below the camera, if the camera is over the world at all
+            repathTimer -= GetFrameTime();
+            if (repathTimer <= 0.0f && pathRequests.empty()) {
+                repathTimer = REPATH_INTERVAL;
+                int goalX = (int)floorf(camera.position.x + 0.5f);
+                int goalZ = (int)floorf(camera.position.z + 0.5f);
+                int goalY = std::min((int)floorf(camera.position.y + 0.5f), VoxelChunk::CHUNK_HEIGHT - 1);
+                while (goalY > 0 && !(world.IsSolid(goalX, goalY - 1, goalZ) && !world.IsSolid(goalX, goalY, goalZ))) {
+                    goalY--;
+                }
+                if (goalY > 0) {
+                    Vector3 goal = {(float)goalX, goalY - 0.5f, (float)goalZ};
+                    for (size_t i = 0; i < mobPaths.size(); i++) {
+                        if (!entities.IsAlive(mobPaths[i].mob)) continue;
+                        pathRequests[navigation.RequestPath(entities.GetPosition(mobPaths[i].mob), goal)] = i;
+                    }
+                }
+            }
+            
+            pathResults.clear();
+            navigation.PollResults(pathResults);
+            for (NavigationSystem::PathResult& result : pathResults) {
+                auto it = pathRequests.find(result.requestId);
+                if (it == pathRequests.end()) continue;
+                MobPath& path = mobPaths[it->second];
+                pathRequests.erase(it);
+                if (!result.found) continue;
+                path.waypoints = std::move(result.waypoints);
+                path.next = 0;
+                path.timeLeft = 2.0f + path.waypoints.size() * 1.5f;  // About twice the walk, plus slack
+            }
+            
+            // Steer towards the next waypoint; a mob without a path wanders
+            for (MobPath& path : mobPaths) {
+                if (path.next >= path.waypoints.size()) continue;
+                path.timeLeft -= GetFrameTime();
+                if (path.timeLeft <= 0.0f || !entities.IsAlive(path.mob)) {
+                    path.waypoints.clear();
+                    continue;
+                }
+                Vector3 position = entities.GetPosition(path.mob);
+                while (path.next < path.waypoints.size()) {
+                    const Vector3& waypoint = path.waypoints[path.next];
+                    float dx = waypoint.x - position.x, dz = waypoint.z - position.z;
+                    if (dx * dx + dz * dz > 0.3f * 0.3f) {
+                        entities.SteerMob(path.mob, atan2f(dz, dx), 0.5f);
+                        break;
+                    }
+                    path.next++;
+                }
+            }
+            
+            entities.Update(GetFrameTime(), &world);
+            
+            for (size_t i = 0; i < mobPaths.size(); i++) {
+                if (!entities.IsAlive(mobPaths[i].mob)) continue;
+                Vector3 feet = entities.GetPosition(mobPaths[i].mob);
+                float dx = feet.x - lastFootsteps[i].x, dz = feet.z - lastFootsteps[i].z;
+                if (dx * dx + dz * dz < FOOTSTEP_STRIDE * FOOTSTEP_STRIDE) continue;
+                
+                // Physics rests feet exactly on top of the ground voxel
+                int groundX = (int)floorf(feet.x + 0.5f);
+                int groundY = (int)floorf(feet.y);
+                int groundZ = (int)floorf(feet.z + 0.5f);
+                if (feet.y - (groundY + 0.5f) > 0.01f || !world.IsSolid(groundX, groundY, groundZ)) continue;
+                
+                particles.SpawnFootstep(feet, world.GetVoxel(groundX, groundY, groundZ).type, &textureManager);
+                lastFootsteps[i] = feet;
+            }
+            particles.Update(GetFrameTime(), &world);
+        }
         
         // Begin drawing
         BeginDrawing();
@@ -84,7 +305,11 @@ int main() {
         BeginMode3D(camera);
         
         // Draw voxel world
-        world.Draw();
+        world.Draw(camera.position);
+        
+        // Draw entities and particles
+        entities.Draw();
+        particles.Draw(camera);
         
         // Draw a grid for reference
         DrawGrid(20, 1.0f);
@@ -234,13 +459,18 @@ int main() {
             
             // Draw hotbar at bottom center
             int hotbarY = GetScreenHeight() - 80; // 80 pixels from bottom
-            textureManager.DrawHotbar(centerX, hotbarY, selectedHotbarSlot);
+            if (icons.IsLoaded()) {
+                icons.DrawHotbar(inventory, centerX, hotbarY, selectedHotbarSlot);
+            } else {
+                textureManager.DrawHotbar(centerX, hotbarY, selectedHotbarSlot);
+            }
         }
         
         EndDrawing();
     }
     
     // Close window and unload resources
+    client.Disconnect();
     CloseWindow();
     
     return 0;
@@ -0,0 +1,157 @@
+#include "../include/memory_budget.h"
+#include <algorithm>
+#include <cmath>
+
+MemoryBudget::MemoryBudget(VoxelWorld* world)
+    : world(world), ramBudget(DEFAULT_RAM_BUDGET), vramBudget(DEFAULT_VRAM_BUDGET),
+      swappedOut(world->GetWidth() * world->GetDepth(), 0) {
+}
+
+void MemoryBudget::SetBudgets(size_t ramBytes, size_t vramBytes) {
+    ramBudget = ramBytes;
+    vramBudget = vramBytes;
+}
+
+void MemoryBudget::SetSwapHandlers(SwapHandler out, SwapHandler in) {
+    swapOut = std::move(out);
+    swapIn = std::move(in);
+}
+
+void MemoryBudget::Measure() {
+    stats.voxelBytes = 0;
+    stats.meshBytes = 0;
+    for (int chunkX = 0; chunkX < world->GetWidth(); chunkX++) {
+        for (int chunkZ = 0; chunkZ < world->GetDepth(); chunkZ++) {
+            const VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+            stats.voxelBytes += chunk->GetVoxelMemory();
+            stats.meshBytes += chunk->GetMeshMemory();
+        }
+    }
+}
+
+float MemoryBudget::DistanceTo(int chunkX, int chunkZ, Vector3 viewPosition) const {
+    const float halfChunk = VoxelChunk::CHUNK_SIZE * 0.5f;
+    float dx = chunkX * VoxelChunk::CHUNK_SIZE + halfChunk - viewPosition.x;
+    float dz = chunkZ * VoxelChunk::CHUNK_SIZE + halfChunk - viewPosition.z;
+    return sqrtf(dx * dx + dz * dz);
+}
+
+void MemoryBudget::Update(Vector3 viewPosition) {
+    Measure();
+    if (IsOverBudget()) {
+        Shed(viewPosition);
+    } else if (GetRamUsage() < ramBudget * RESTORE_FRACTION && GetVramUsage() < vramBudget * RESTORE_FRACTION) {
+        Restore(viewPosition);
+    }
+}
+
+bool MemoryBudget::DrawnWithin(const Candidate& candidate, uint32_t frames) const {
+    // Frame 0 means never drawn
+    return candidate.lastVisible != 0 && world->GetDrawFrame() - candidate.lastVisible < frames;
+}
+
+void MemoryBudget::EvictMeshes(const std::vector<Candidate>& candidates, uint32_t keepFrames) {
+    for (const Candidate& candidate : candidates) {
+        if (!IsOverBudget()) return;
+        if (DrawnWithin(candidate, keepFrames)) continue;
+        VoxelChunk* chunk = world->GetChunk(candidate.chunkX, candidate.chunkZ);
+        size_t bytes = chunk->GetMeshMemory();
+        if (bytes == 0) continue;
+        chunk->EvictMesh();
+        stats.meshBytes -= bytes;
+        stats.meshesEvicted++;
+    }
+}
+
+void MemoryBudget::Shed(Vector3 viewPosition) {
+    // Loaded chunks no job is using, coldest first
+    std::vector<Candidate> candidates;
+    for (int chunkX = 0; chunkX < world->GetWidth(); chunkX++) {
+        for (int chunkZ = 0; chunkZ < world->GetDepth(); chunkZ++) {
+            const VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+            ChunkState state = chunk->GetState();
+            if (state < CHUNK_GENERATED || state == CHUNK_UNLOADING || chunk->GetReferenceCount() > 0) continue;
+            candidates.push_back({chunkX, chunkZ, chunk->GetLastVisibleFrame(), DistanceTo(chunkX, chunkZ, viewPosition)});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.lastVisible != b.lastVisible) return a.lastVisible < b.lastVisible;
+        return a.distance > b.distance;
+    });
+
+    // Meshes that haven't been on screen for a while first: they are rebuilt from the
+    // voxels whenever they're wanted back
+    EvictMeshes(candidates, RECENTLY_VISIBLE_FRAMES);
+    if (!IsOverBudget()) return;
+
+    // Then voxel data, which stays readable
+    for (const Candidate& candidate : candidates) {
+        if (GetRamUsage() <= ramBudget) break;
+        VoxelChunk* chunk = world->GetChunk(candidate.chunkX, candidate.chunkZ);
+        size_t before = chunk->GetVoxelMemory();
+        if (!chunk->CompressVoxels()) continue;
+        stats.voxelBytes -= before - chunk->GetVoxelMemory();
+        stats.chunksCompressed++;
+    }
+
+    // Then meshes seen recently, but never the ones on screen now
+    EvictMeshes(candidates, 1);
+
+    // Last, whole chunks off screen. The memory is freed once the unload is collected,
+    // but it is counted as gone now so this doesn't shed more than needed meanwhile.
+    if (!swapOut) return;
+    for (const Candidate& candidate : candidates) {
+        if (GetRamUsage() <= ramBudget) return;
+        if (DrawnWithin(candidate, 1)) continue;
+        VoxelChunk* chunk = world->GetChunk(candidate.chunkX, candidate.chunkZ);
+        size_t voxelBytes = chunk->GetVoxelMemory();
+        size_t meshBytes = chunk->GetMeshMemory();
+        if (!swapOut(candidate.chunkX, candidate.chunkZ)) continue;
+        swappedOut[candidate.chunkX * world->GetDepth() + candidate.chunkZ] = 1;
+        stats.voxelBytes -= voxelBytes;
+        stats.meshBytes -= meshBytes;
+        stats.chunksSwappedOut++;
+    }
+}
+
+void MemoryBudget::Restore(Vector3 viewPosition) {
+    // Chunks we shed, nearest first
+    std::vector<Candidate> candidates;
+    for (int chunkX = 0; chunkX < world->GetWidth(); chunkX++) {
+        for (int chunkZ = 0; chunkZ < world->GetDepth(); chunkZ++) {
+            const VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+            bool swapped = swappedOut[chunkX * world->GetDepth() + chunkZ] != 0;
+            bool evicted = chunk->IsMeshEvicted() && chunk->GetState() == CHUNK_LIT && !chunk->NeedsMeshUpdate();
+            if (!swapped && !evicted) continue;
+            candidates.push_back({chunkX, chunkZ, chunk->GetLastVisibleFrame(), DistanceTo(chunkX, chunkZ, viewPosition)});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.distance < b.distance;
+    });
+
+    // Bring back only what still fits under the restore line, by the size it had
+    size_t ramLimit = (size_t)(ramBudget * RESTORE_FRACTION);
+    size_t vramLimit = (size_t)(vramBudget * RESTORE_FRACTION);
+    int restored = 0;
+    for (const Candidate& candidate : candidates) {
+        if (restored >= MAX_RESTORES_PER_UPDATE) return;
+        VoxelChunk* chunk = world->GetChunk(candidate.chunkX, candidate.chunkZ);
+        uint8_t& swapped = swappedOut[candidate.chunkX * world->GetDepth() + candidate.chunkZ];
+
+        if (swapped) {
+            size_t estimate = sizeof(Voxel) * VoxelChunk::CHUNK_VOLUME + chunk->GetLastMeshMemory();
+            if (GetRamUsage() + estimate > ramLimit) return;
+            swapped = 0;
+            if (!swapIn || !swapIn(candidate.chunkX, candidate.chunkZ)) continue;  // Reloaded some other way meanwhile
+            stats.voxelBytes += sizeof(Voxel) * VoxelChunk::CHUNK_VOLUME;
+        } else {
+            size_t estimate = chunk->GetLastMeshMemory();
+            if (GetRamUsage() + estimate > ramLimit || GetVramUsage() + estimate > vramLimit) return;
+            chunk->MarkForUpdate();
+            stats.meshBytes += estimate;
+        }
+        stats.chunksRestored++;
+        restored++;
+    }
+}
@@ -0,0 +1,501 @@
+#include "../include/navigation.h"
+#include "../include/job_system.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <thread>
+
+static const int CHUNK_SIZE = VoxelChunk::CHUNK_SIZE;
+static const int CHUNK_HEIGHT = VoxelChunk::CHUNK_HEIGHT;
+static const uint16_t UNREACHED = 0xFFFF;
+
+static const int HORIZONTAL_OFFSETS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+static uint64_t PackCell(int x, int y, int z) {
+    return ((uint64_t)(uint32_t)x << 32) | ((uint64_t)(uint16_t)y << 16) | (uint16_t)z;
+}
+
+NavigationSystem::NavigationSystem(VoxelWorld* world)
+    : world(world), width(world->GetWidth()), depth(world->GetDepth()), listenerId(-1),
+      cacheVersion(0), completedResults(RESULT_QUEUE_CAPACITY), nextRequestId(0), pendingRequests(0) {
+    std::shared_ptr<Graph> initial = std::make_shared<Graph>();
+    initial->clusters.resize(width * depth);
+    initial->bordersX.resize(width * depth);
+    initial->bordersZ.resize(width * depth);
+    graph = initial;
+    dirtyClusters.assign(width * depth, 1);
+    builtLoaded.assign(width * depth, 0);
+
+    listenerId = world->AddEditListener([this](int chunkX, int chunkZ, const std::vector<BlockEdit>&) {
+        dirtyClusters[chunkX * depth + chunkZ] = 1;
+    });
+
+    Update();
+}
+
+NavigationSystem::~NavigationSystem() {
+    world->RemoveEditListener(listenerId);
+
+    // Queued queries still reference this object
+    while (pendingRequests.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+bool NavigationSystem::IsWalkable(const Cluster& cluster, int x, int y, int z) {
+    if (x < 0 || x >= CHUNK_SIZE || y < 0 || y >= CHUNK_HEIGHT || z < 0 || z >= CHUNK_SIZE) {
+        return false;
+    }
+    return (cluster.walkable[y][z] >> x) & 1;
+}
+
+void NavigationSystem::RebuildWalkable(Cluster& cluster, const VoxelChunk* chunk) {
+    // A cell is walkable when it and the cell above are open and the cell below is solid.
+    // The bottom layer has nothing to stand on; above the top layer is open sky.
+    for (int z = 0; z < CHUNK_SIZE; z++) {
+        cluster.walkable[0][z] = 0;
+        for (int y = 1; y < CHUNK_HEIGHT; y++) {
+            if (!chunk) {
+                cluster.walkable[y][z] = 0;
+                continue;
+            }
+            uint16_t below = chunk->GetSolidRow(y - 1, z);
+            uint16_t self = chunk->GetSolidRow(y, z);
+            uint16_t above = y + 1 < CHUNK_HEIGHT ? chunk->GetSolidRow(y + 1, z) : 0;
+            cluster.walkable[y][z] = (uint16_t)(below & ~self & ~above);
+        }
+    }
+}
+
+void NavigationSystem::RebuildBorderX(Graph& next, int clusterIndex) const {
+    std::vector<BorderLink>& links = next.bordersX[clusterIndex];
+    links.clear();
+    if (clusterIndex / depth + 1 >= width) return;
+
+    const Cluster& a = *next.clusters[clusterIndex];
+    const Cluster& b = *next.clusters[clusterIndex + depth];
+
+    // Contiguous crossings at the same height collapse into one portal at their middle
+    for (int y = 0; y < CHUNK_HEIGHT; y++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            int runStart = -1;
+            for (int z = 0; z <= CHUNK_SIZE; z++) {
+                bool open = z < CHUNK_SIZE && IsWalkable(a, CHUNK_SIZE - 1, y, z) && IsWalkable(b, 0, y + dy, z);
+                if (open && runStart < 0) runStart = z;
+                if (!open && runStart >= 0) {
+                    int mid = (runStart + z - 1) / 2;
+                    links.push_back({(uint16_t)VoxelChunk::CellIndex(CHUNK_SIZE - 1, y, mid),
+                                     (uint16_t)VoxelChunk::CellIndex(0, y + dy, mid)});
+                    runStart = -1;
+                }
+            }
+        }
+    }
+}
+
+void NavigationSystem::RebuildBorderZ(Graph& next, int clusterIndex) const {
+    std::vector<BorderLink>& links = next.bordersZ[clusterIndex];
+    links.clear();
+    if (clusterIndex % depth + 1 >= depth) return;
+
+    const Cluster& a = *next.clusters[clusterIndex];
+    const Cluster& b = *next.clusters[clusterIndex + 1];
+
+    for (int y = 0; y < CHUNK_HEIGHT; y++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            int runStart = -1;
+            for (int x = 0; x <= CHUNK_SIZE; x++) {
+                bool open = x < CHUNK_SIZE && IsWalkable(a, x, y, CHUNK_SIZE - 1) && IsWalkable(b, x, y + dy, 0);
+                if (open && runStart < 0) runStart = x;
+                if (!open && runStart >= 0) {
+                    int mid = (runStart + x - 1) / 2;
+                    links.push_back({(uint16_t)VoxelChunk::CellIndex(mid, y, CHUNK_SIZE - 1),
+                                     (uint16_t)VoxelChunk::CellIndex(mid, y + dy, 0)});
+                    runStart = -1;
+                }
+            }
+        }
+    }
+}
+
+void NavigationSystem::RebuildPortals(const Graph& next, Cluster& cluster, int clusterIndex) const {
+    int chunkX = clusterIndex / depth;
+    int chunkZ = clusterIndex % depth;
+
+    cluster.portals.clear();
+    cluster.portalOfCell.assign(VoxelChunk::CHUNK_VOLUME, -1);
+
+    auto addPortal = [&cluster](uint16_t cell) {
+        if (cluster.portalOfCell[cell] < 0) {
+            cluster.portalOfCell[cell] = (int16_t)cluster.portals.size();
+            cluster.portals.push_back(cell);
+        }
+    };
+
+    for (const BorderLink& link : next.bordersX[clusterIndex]) addPortal(link.cellA);
+    for (const BorderLink& link : next.bordersZ[clusterIndex]) addPortal(link.cellA);
+    if (chunkX > 0) {
+        for (const BorderLink& link : next.bordersX[clusterIndex - depth]) addPortal(link.cellB);
+    }
+    if (chunkZ > 0) {
+        for (const BorderLink& link : next.bordersZ[clusterIndex - 1]) addPortal(link.cellB);
+    }
+
+    // One flood per portal gives its distance to every other portal in the chunk
+    cluster.intraEdges.assign(cluster.portals.size(), std::vector<Edge>());
+    std::vector<uint16_t> distance;
+    for (size_t p = 0; p < cluster.portals.size(); p++) {
+        BfsInCluster(cluster, cluster.portals[p], distance, nullptr);
+        for (size_t q = 0; q < cluster.portals.size(); q++) {
+            if (q != p && distance[cluster.portals[q]] != UNREACHED) {
+                cluster.intraEdges[p].push_back({(int)q, distance[cluster.portals[q]]});
+            }
+        }
+    }
+}
+
+void NavigationSystem::RebuildAbstractGraph(Graph& next) const {
+    const std::vector<std::shared_ptr<const Cluster>>& clusters = next.clusters;
+    next.nodeOffset.assign(clusters.size(), 0);
+    next.nodeCluster.clear();
+    next.nodeCell.clear();
+
+    for (size_t i = 0; i < clusters.size(); i++) {
+        next.nodeOffset[i] = (int)next.nodeCell.size();
+        for (uint16_t cell : clusters[i]->portals) {
+            next.nodeCluster.push_back((int)i);
+            next.nodeCell.push_back(cell);
+        }
+    }
+
+    next.abstractEdges.assign(next.nodeCell.size(), std::vector<Edge>());
+    for (size_t i = 0; i < clusters.size(); i++) {
+        const Cluster& cluster = *clusters[i];
+        int offset = next.nodeOffset[i];
+        for (size_t p = 0; p < cluster.intraEdges.size(); p++) {
+            for (const Edge& edge : cluster.intraEdges[p]) {
+                next.abstractEdges[offset + p].push_back({offset + edge.target, edge.cost});
+            }
+        }
+
+        auto connect = [&](const std::vector<BorderLink>& links, int neighborIndex) {
+            for (const BorderLink& link : links) {
+                int a = offset + cluster.portalOfCell[link.cellA];
+                int b = next.nodeOffset[neighborIndex] + clusters[neighborIndex]->portalOfCell[link.cellB];
+                next.abstractEdges[a].push_back({b, 1});
+                next.abstractEdges[b].push_back({a, 1});
+            }
+        };
+        connect(next.bordersX[i], (int)i + depth);
+        connect(next.bordersZ[i], (int)i + 1);
+    }
+}
+
+void NavigationSystem::Update() {
+    // Loading and unloading don't go through the edit listener
+    std::vector<int> dirty;
+    for (int i = 0; i < (int)dirtyClusters.size(); i++) {
+        ChunkState state = world->GetChunkState(i / depth, i % depth);
+        bool loaded = state >= CHUNK_GENERATED && state != CHUNK_UNLOADING;
+        if (dirtyClusters[i] || loaded != (bool)builtLoaded[i]) dirty.push_back(i);
+    }
+    if (dirty.empty()) return;
+
+    // Build the next graph without holding the lock: queries keep running on the current
+    // one meanwhile, and path jobs waiting on the lock can't stall the ParallelFor below.
+    // Only this thread ever publishes a graph, so reading it here needs no lock either.
+    std::shared_ptr<Graph> next = std::make_shared<Graph>(*graph);
+    next->version = graph->version + 1;
+
+    // Walkability only depends on the chunk itself; the borders and portal lists
+    // also depend on the neighbors, so those are redone for the ring around each edit
+    std::vector<std::shared_ptr<Cluster>> rebuilt(next->clusters.size());
+    auto editable = [&](int index) -> Cluster& {
+        if (!rebuilt[index]) {
+            const std::shared_ptr<const Cluster>& current = next->clusters[index];
+            rebuilt[index] = current ? std::make_shared<Cluster>(*current) : std::make_shared<Cluster>();
+            next->clusters[index] = rebuilt[index];
+        }
+        return *rebuilt[index];
+    };
+    // Read through a handle, so the chunk can't be cleared halfway; one that isn't
+    // loaded has nowhere to walk
+    for (int index : dirty) {
+        ChunkHandle chunk = world->AcquireChunk(index / depth, index % depth);
+        RebuildWalkable(editable(index), chunk.Get());
+        builtLoaded[index] = chunk ? 1 : 0;
+        dirtyClusters[index] = 0;
+    }
+    for (int index : dirty) {
+        int chunkX = index / depth;
+        int chunkZ = index % depth;
+        if (chunkX > 0) editable(index - depth);
+        if (chunkX + 1 < width) editable(index + depth);
+        if (chunkZ > 0) editable(index - 1);
+        if (chunkZ + 1 < depth) editable(index + 1);
+    }
+    for (int index : dirty) {
+        int chunkX = index / depth;
+        int chunkZ = index % depth;
+        RebuildBorderX(*next, index);
+        RebuildBorderZ(*next, index);
+        if (chunkX > 0) RebuildBorderX(*next, index - depth);
+        if (chunkZ > 0) RebuildBorderZ(*next, index - 1);
+    }
+
+    std::vector<int> rebuild;
+    for (int i = 0; i < (int)rebuilt.size(); i++) {
+        if (rebuilt[i]) rebuild.push_back(i);
+    }
+    const Graph& staging = *next;
+    JobSystem::Get().ParallelFor((int)rebuild.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            RebuildPortals(staging, *rebuilt[rebuild[i]], rebuild[i]);
+        }
+    });
+
+    RebuildAbstractGraph(*next);
+
+    std::shared_ptr<const Graph> previous;
+    {
+        std::unique_lock<std::shared_mutex> lock(graphMutex);
+        previous = std::move(graph);
+        graph = std::move(next);
+    }
+    // The old graph is freed here, or by the last query still searching it
+}
+
+std::shared_ptr<const NavigationSystem::Graph> NavigationSystem::GetGraph() const {
+    std::shared_lock<std::shared_mutex> lock(graphMutex);
+    return graph;
+}
+
+void NavigationSystem::BfsInCluster(const Cluster& cluster, int startCell, std::vector<uint16_t>& distance,
+                                    std::vector<int>* parent) {
+    distance.assign(VoxelChunk::CHUNK_VOLUME, UNREACHED);
+    if (parent) parent->assign(VoxelChunk::CHUNK_VOLUME, -1);
+
+    std::vector<uint16_t> queue;
+    queue.reserve(VoxelChunk::CHUNK_VOLUME);
+    queue.push_back((uint16_t)startCell);
+    distance[startCell] = 0;
+
+    // Steps go one cell sideways and at most one up or down
+    for (size_t head = 0; head < queue.size(); head++) {
+        int cell = queue[head];
+        int x, y, z;
+        VoxelChunk::CellCoords(cell, x, y, z);
+
+        for (int i = 0; i < 4; i++) {
+            int nx = x + HORIZONTAL_OFFSETS[i][0];
+            int nz = z + HORIZONTAL_OFFSETS[i][1];
+            for (int dy = -1; dy <= 1; dy++) {
+                if (!IsWalkable(cluster, nx, y + dy, nz)) continue;
+                int next = VoxelChunk::CellIndex(nx, y + dy, nz);
+                if (distance[next] != UNREACHED) continue;
+                distance[next] = (uint16_t)(distance[cell] + 1);
+                if (parent) (*parent)[next] = cell;
+                queue.push_back((uint16_t)next);
+            }
+        }
+    }
+}
+
+Vector3 NavigationSystem::CellToWaypoint(int clusterIndex, int cell) const {
+    int x, y, z;
+    VoxelChunk::CellCoords(cell, x, y, z);
+    return {(float)((clusterIndex / depth) * CHUNK_SIZE + x), (float)y - 0.5f,
+            (float)((clusterIndex % depth) * CHUNK_SIZE + z)};
+}
+
+bool NavigationSystem::CellPathInCluster(const Graph& g, int clusterIndex, int fromCell, int toCell,
+                                         std::vector<Vector3>& out) const {
+    std::vector<uint16_t> distance;
+    std::vector<int> parent;
+    BfsInCluster(*g.clusters[clusterIndex], fromCell, distance, &parent);
+    if (distance[toCell] == UNREACHED) return false;
+
+    // Appends the cells after fromCell, ending with toCell
+    size_t first = out.size();
+    for (int cell = toCell; cell != fromCell; cell = parent[cell]) {
+        out.push_back(CellToWaypoint(clusterIndex, cell));
+    }
+    std::reverse(out.begin() + first, out.end());
+    return true;
+}
+
+bool NavigationSystem::LocateCell(const Graph& g, int x, int y, int z, int& clusterIndex, int& cell) const {
+    if (x < 0 || z < 0 || y < 0 || y >= CHUNK_HEIGHT) return false;
+    int chunkX = x / CHUNK_SIZE;
+    int chunkZ = z / CHUNK_SIZE;
+    if (chunkX >= width || chunkZ >= depth) return false;
+
+    clusterIndex = chunkX * depth + chunkZ;
+    cell = VoxelChunk::CellIndex(x % CHUNK_SIZE, y, z % CHUNK_SIZE);
+    return IsWalkable(*g.clusters[clusterIndex], x % CHUNK_SIZE, y, z % CHUNK_SIZE);
+}
+
+bool NavigationSystem::FindPathInGraph(const Graph& g, int sx, int sy, int sz, int gx, int gy, int gz,
+                                       std::vector<Vector3>& out) const {
+    int startCluster, startCell, goalCluster, goalCell;
+    if (!LocateCell(g, sx, sy, sz, startCluster, startCell)) return false;
+    if (!LocateCell(g, gx, gy, gz, goalCluster, goalCell)) return false;
+
+    out.clear();
+    out.push_back(CellToWaypoint(startCluster, startCell));
+    if (startCluster == goalCluster && startCell == goalCell) return true;
+
+    // Same chunk: try a plain flood first, the route may still have to leave the chunk
+    if (startCluster == goalCluster && CellPathInCluster(g, startCluster, startCell, goalCell, out)) {
+        return true;
+    }
+
+    // Connect start and goal to the portals of their own chunks
+    const Cluster& startC = *g.clusters[startCluster];
+    const Cluster& goalC = *g.clusters[goalCluster];
+    const std::vector<int>& nodeOffset = g.nodeOffset;
+    const std::vector<int>& nodeCluster = g.nodeCluster;
+    const std::vector<uint16_t>& nodeCell = g.nodeCell;
+    std::vector<uint16_t> startDistance, goalDistance;
+    BfsInCluster(startC, startCell, startDistance, nullptr);
+    BfsInCluster(goalC, goalCell, goalDistance, nullptr);
+
+    auto heuristic = [&](int node) {
+        int x, y, z;
+        VoxelChunk::CellCoords(nodeCell[node], x, y, z);
+        x += (nodeCluster[node] / depth) * CHUNK_SIZE;
+        z += (nodeCluster[node] % depth) * CHUNK_SIZE;
+        return std::abs(x - gx) + std::abs(z - gz);
+    };
+
+    // A* over the portal graph; the goal is reached through any goal-chunk portal
+    const int INF = 0x7FFFFFFF;
+    std::vector<int> cost(nodeCell.size(), INF);
+    std::vector<int> cameFrom(nodeCell.size(), -1);
+    typedef std::pair<int, int> QueueEntry;  // (estimate, node)
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+
+    for (size_t p = 0; p < startC.portals.size(); p++) {
+        uint16_t d = startDistance[startC.portals[p]];
+        if (d == UNREACHED) continue;
+        int node = nodeOffset[startCluster] + (int)p;
+        cost[node] = d;
+        open.push({d + heuristic(node), node});
+    }
+
+    int bestTotal = INF;
+    int bestNode = -1;
+    while (!open.empty()) {
+        QueueEntry top = open.top();
+        open.pop();
+        if (top.first >= bestTotal) break;
+
+        int node = top.second;
+        if (top.first - heuristic(node) > cost[node]) continue;
+
+        if (nodeCluster[node] == goalCluster) {
+            uint16_t d = goalDistance[nodeCell[node]];
+            if (d != UNREACHED && cost[node] + d < bestTotal) {
+                bestTotal = cost[node] + d;
+                bestNode = node;
+            }
+        }
+
+        for (const Edge& edge : g.abstractEdges[node]) {
+            int next = cost[node] + edge.cost;
+            if (next < cost[edge.target]) {
+                cost[edge.target] = next;
+                cameFrom[edge.target] = node;
+                open.push({next + heuristic(edge.target), edge.target});
+            }
+        }
+    }
+    if (bestNode < 0) return false;
+
+    std::vector<int> route;
+    for (int node = bestNode; node >= 0; node = cameFrom[node]) {
+        route.push_back(node);
+    }
+    std::reverse(route.begin(), route.end());
+
+    // Refine each hop back into cells: in-chunk hops by flood, border hops are one step
+    int currentCluster = startCluster;
+    int currentCell = startCell;
+    for (int node : route) {
+        int cluster = nodeCluster[node];
+        int cell = nodeCell[node];
+        if (cluster == currentCluster) {
+            if (cell != currentCell && !CellPathInCluster(g, cluster, currentCell, cell, out)) return false;
+        } else {
+            out.push_back(CellToWaypoint(cluster, cell));
+        }
+        currentCluster = cluster;
+        currentCell = cell;
+    }
+    if (currentCell != goalCell) {
+        return CellPathInCluster(g, goalCluster, currentCell, goalCell, out);
+    }
+    return true;
+}
+
+bool NavigationSystem::FindPath(Vector3 from, Vector3 to, std::vector<Vector3>& waypoints) const {
+    // Feet rest half a block below the center of the cell they stand in
+    int sx = (int)floorf(from.x + 0.5f), sy = (int)floorf(from.y + 0.5f + 0.01f), sz = (int)floorf(from.z + 0.5f);
+    int gx = (int)floorf(to.x + 0.5f), gy = (int)floorf(to.y + 0.5f + 0.01f), gz = (int)floorf(to.z + 0.5f);
+
+    std::shared_ptr<const Graph> g = GetGraph();
+
+    std::pair<uint64_t, uint64_t> key(PackCell(sx, sy, sz), PackCell(gx, gy, gz));
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        if (cacheVersion < g->version) {
+            pathCache.clear();
+            cacheVersion = g->version;
+        }
+        auto it = pathCache.find(key);
+        if (it != pathCache.end()) {
+            waypoints = it->second;
+            return !waypoints.empty();
+        }
+    }
+
+    bool found = FindPathInGraph(*g, sx, sy, sz, gx, gy, gz, waypoints);
+    if (!found) waypoints.clear();
+
+    // A query that started on an older graph doesn't get to fill the new cache
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    if (cacheVersion != g->version) return found;
+    if ((int)pathCache.size() >= MAX_CACHED_PATHS) {
+        pathCache.clear();
+    }
+    pathCache[key] = waypoints;
+    return found;
+}
+
+int NavigationSystem::RequestPath(Vector3 from, Vector3 to) {
+    int requestId = nextRequestId++;
+    pendingRequests++;
+
+    // Background work; results are picked up by PollResults whenever they're ready
+    JobSystem::Get().Submit([this, requestId, from, to]() {
+        PathResult result;
+        result.requestId = requestId;
+        result.found = FindPath(from, to, result.waypoints);
+        if (!completedResults.TryPush(result)) {
+            std::lock_guard<std::mutex> lock(overflowMutex);
+            overflowResults.push_back(std::move(result));
+        }
+        pendingRequests--;
+    }, JOB_LOW);
+    return requestId;
+}
+
+void NavigationSystem::PollResults(std::vector<PathResult>& results) {
+    completedResults.PopBatch(results, completedResults.GetCapacity());
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    for (PathResult& result : overflowResults) {
+        results.push_back(std::move(result));
+    }
+    overflowResults.clear();
+}
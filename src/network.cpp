@@ -0,0 +1,346 @@
+#include "../include/network.h"
+#include "../include/chunk_codec.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // macOS uses SO_NOSIGPIPE on the socket instead
+#endif
+
+// PacketWriter
+
+void PacketWriter::WriteU16(uint16_t value) {
+    data.push_back((uint8_t)value);
+    data.push_back((uint8_t)(value >> 8));
+}
+
+void PacketWriter::WriteU32(uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        data.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+void PacketWriter::WriteU64(uint64_t value) {
+    WriteU32((uint32_t)value);
+    WriteU32((uint32_t)(value >> 32));
+}
+
+void PacketWriter::WriteF32(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(bits);
+}
+
+void PacketWriter::WriteString(const std::string& value) {
+    size_t length = value.size() < 0xFFFF ? value.size() : 0xFFFF;
+    WriteU16((uint16_t)length);
+    WriteBytes((const uint8_t*)value.data(), length);
+}
+
+// PacketReader
+
+PacketReader::PacketReader(const std::vector<uint8_t>& packet)
+    : data(packet.data()), size(packet.size()), position(1), valid(!packet.empty()) {
+    if (size == 0) position = 0;
+}
+
+bool PacketReader::Require(size_t count) {
+    if (!valid || size - position < count) {
+        valid = false;
+        return false;
+    }
+    return true;
+}
+
+uint8_t PacketReader::ReadU8() {
+    if (!Require(1)) return 0;
+    return data[position++];
+}
+
+uint16_t PacketReader::ReadU16() {
+    if (!Require(2)) return 0;
+    uint16_t value = (uint16_t)(data[position] | (data[position + 1] << 8));
+    position += 2;
+    return value;
+}
+
+uint32_t PacketReader::ReadU32() {
+    if (!Require(4)) return 0;
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)data[position + i] << (i * 8);
+    }
+    position += 4;
+    return value;
+}
+
+uint64_t PacketReader::ReadU64() {
+    uint64_t low = ReadU32();
+    uint64_t high = ReadU32();
+    return low | (high << 32);
+}
+
+float PacketReader::ReadF32() {
+    uint32_t bits = ReadU32();
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string PacketReader::ReadString() {
+    uint16_t length = ReadU16();
+    const uint8_t* bytes = ReadBytes(length);
+    return bytes ? std::string((const char*)bytes, length) : std::string();
+}
+
+const uint8_t* PacketReader::ReadBytes(size_t count) {
+    if (!Require(count)) return nullptr;
+    const uint8_t* bytes = data + position;
+    position += count;
+    return bytes;
+}
+
+// Chunk data
+
+void WriteChunkData(PacketWriter& writer, const VoxelChunk& chunk) {
+    std::vector<uint8_t> encoded;
+    ChunkCodec::Encode(chunk, encoded);
+    WriteChunkData(writer, encoded);
+}
+
+void WriteChunkData(PacketWriter& writer, const std::vector<uint8_t>& encoded) {
+    writer.WriteU32((uint32_t)encoded.size());
+    writer.WriteBytes(encoded.data(), encoded.size());
+}
+
+bool ReadChunkData(PacketReader& reader, Voxel cells[VoxelChunk::CHUNK_VOLUME]) {
+    uint32_t length = reader.ReadU32();
+    const uint8_t* bytes = reader.ReadBytes(length);
+    return bytes && ChunkCodec::Decode(bytes, length, cells);
+}
+
+// LoopbackConnection
+
+void LoopbackConnection::CreatePair(std::unique_ptr<Connection>& first, std::unique_ptr<Connection>& second) {
+    auto channel = std::make_shared<LoopbackChannel>();
+    first.reset(new LoopbackConnection(channel, 0));
+    second.reset(new LoopbackConnection(channel, 1));
+}
+
+void LoopbackConnection::Send(std::vector<uint8_t> packet) {
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    if (channel->closed) return;
+    bytesSent += packet.size();
+    channel->queues[side ^ 1].push_back(std::move(packet));
+}
+
+void LoopbackConnection::Poll(std::vector<std::vector<uint8_t>>& packets) {
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    std::deque<std::vector<uint8_t>>& queue = channel->queues[side];
+    while (!queue.empty()) {
+        bytesReceived += queue.front().size();
+        packets.push_back(std::move(queue.front()));
+        queue.pop_front();
+    }
+}
+
+bool LoopbackConnection::IsOpen() const {
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    return !channel->closed;
+}
+
+void LoopbackConnection::Close() {
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    channel->closed = true;
+}
+
+// TcpConnection
+
+namespace {
+    void ConfigureSocket(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+        // Block updates are small and latency matters more than packet count
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+#ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+    }
+}
+
+TcpConnection::TcpConnection(int socketFd, const std::string& peer)
+    : socketFd(socketFd), peer(peer), sendOffset(0) {
+    ConfigureSocket(socketFd);
+}
+
+std::unique_ptr<Connection> TcpConnection::Connect(const std::string& host, int port) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* results = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &results) != 0) {
+        std::cout << "Could not resolve " << host << std::endl;
+        return nullptr;
+    }
+
+    int fd = -1;
+    for (addrinfo* address = results; address && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(results);
+
+    if (fd < 0) {
+        std::cout << "Could not connect to " << host << ":" << port << std::endl;
+        return nullptr;
+    }
+    return std::unique_ptr<Connection>(new TcpConnection(fd, host + ":" + service));
+}
+
+void TcpConnection::Send(std::vector<uint8_t> packet) {
+    if (socketFd < 0) return;
+
+    uint32_t length = (uint32_t)packet.size();
+    for (int i = 0; i < 4; i++) {
+        sendBuffer.push_back((uint8_t)(length >> (i * 8)));
+    }
+    sendBuffer.insert(sendBuffer.end(), packet.begin(), packet.end());
+    bytesSent += packet.size() + 4;
+    Flush();
+}
+
+void TcpConnection::Flush() {
+    while (socketFd >= 0 && sendOffset < sendBuffer.size()) {
+        ssize_t written = send(socketFd, sendBuffer.data() + sendOffset, sendBuffer.size() - sendOffset, MSG_NOSIGNAL);
+        if (written > 0) {
+            sendOffset += (size_t)written;
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;  // Socket buffer full; the rest goes out on a later Poll
+        } else if (written < 0 && errno == EINTR) {
+            continue;
+        } else {
+            Close();
+        }
+    }
+
+    if (sendOffset == sendBuffer.size()) {
+        sendBuffer.clear();
+        sendOffset = 0;
+    } else if (sendOffset >= sendBuffer.size() / 2) {
+        // A slow peer never drains the buffer completely; drop the sent front once
+        // it's most of it, so the buffer doesn't keep growing and moves stay amortized
+        sendBuffer.erase(sendBuffer.begin(), sendBuffer.begin() + sendOffset);
+        sendOffset = 0;
+    }
+}
+
+void TcpConnection::Poll(std::vector<std::vector<uint8_t>>& packets) {
+    Flush();
+
+    uint8_t chunk[16384];
+    while (socketFd >= 0) {
+        ssize_t received = recv(socketFd, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            receiveBuffer.insert(receiveBuffer.end(), chunk, chunk + received);
+            bytesReceived += (uint64_t)received;
+        } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (received < 0 && errno == EINTR) {
+            continue;
+        } else {
+            Close();  // Orderly shutdown or a hard error
+        }
+    }
+
+    // Split the stream into packets; a partial packet stays buffered
+    size_t offset = 0;
+    while (receiveBuffer.size() - offset >= 4) {
+        uint32_t length = 0;
+        for (int i = 0; i < 4; i++) {
+            length |= (uint32_t)receiveBuffer[offset + i] << (i * 8);
+        }
+        if (length > MAX_PACKET_SIZE) {
+            std::cout << "Dropping " << peer << ": oversized packet (" << length << " bytes)" << std::endl;
+            Close();
+            break;
+        }
+        if (receiveBuffer.size() - offset - 4 < length) break;
+
+        packets.emplace_back(receiveBuffer.begin() + offset + 4, receiveBuffer.begin() + offset + 4 + length);
+        offset += 4 + length;
+    }
+    receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + offset);
+}
+
+void TcpConnection::Close() {
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+}
+
+// TcpListener
+
+bool TcpListener::Listen(int port) {
+    Close();
+
+    socketFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (socketFd < 0) return false;
+
+    int enable = 1;
+    setsockopt(socketFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t)port);
+
+    if (bind(socketFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(socketFd, 16) != 0) {
+        std::cout << "Could not listen on port " << port << ": " << strerror(errno) << std::endl;
+        Close();
+        return false;
+    }
+
+    int flags = fcntl(socketFd, F_GETFL, 0);
+    fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+    return true;
+}
+
+std::unique_ptr<Connection> TcpListener::Accept() {
+    if (socketFd < 0) return nullptr;
+
+    sockaddr_in address;
+    socklen_t addressLength = sizeof(address);
+    int fd = accept(socketFd, (sockaddr*)&address, &addressLength);
+    if (fd < 0) return nullptr;
+
+    char host[INET_ADDRSTRLEN] = "?";
+    inet_ntop(AF_INET, &address.sin_addr, host, sizeof(host));
+    std::string peer = std::string(host) + ":" + std::to_string(ntohs(address.sin_port));
+    return std::unique_ptr<Connection>(new TcpConnection(fd, peer));
+}
+
+void TcpListener::Close() {
+    if (socketFd >= 0) {
+        close(socketFd);
+        socketFd = -1;
+    }
+}
@@ -0,0 +1,348 @@
+#include "../include/particles.h"
+#include "../include/texture_manager.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const float PARTICLE_GRAVITY = -16.0f;
+    const float GROUND_FRICTION = 0.5f;
+
+    // Collision looks cells up this many particles at a time
+    const int COLLISION_BLOCK = 256;
+
+    const int CHUNK_SHIFT = 4;
+    static_assert(VoxelChunk::CHUNK_SIZE == 1 << CHUNK_SHIFT, "chunk lookup assumes 16-voxel chunks");
+
+    inline int VoxelCoord(float v) {
+        // Voxels are centered on integer coordinates
+        return (int)floorf(v + 0.5f);
+    }
+
+#if defined(__GNUC__)
+    // Four lanes through the compiler's generic vectors: SSE on x86, NEON on ARM.
+    // Written out rather than left to the auto-vectorizer, which skips these loops at
+    // -O2 because the arrays could alias.
+    #define PARTICLES_SIMD 1
+    typedef float Float4 __attribute__((vector_size(16)));
+    typedef int Int4 __attribute__((vector_size(16)));
+
+    inline Float4 Splat4(float v) { return Float4{v, v, v, v}; }
+    inline Float4 Load4(const float* p) { Float4 v; memcpy(&v, p, sizeof(v)); return v; }
+    inline void Store4(float* p, Float4 v) { memcpy(p, &v, sizeof(v)); }
+    inline void Store4(int* p, Int4 v) { memcpy(p, &v, sizeof(v)); }
+
+    typedef uint32_t UInt4 __attribute__((vector_size(16)));
+
+    // xorshift32 on every lane
+    inline UInt4 XorShift4(UInt4& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Same split as ParticleSystem::RandomFloats, per lane
+    inline void UnpackRandom4(UInt4 r, Float4& a, Float4& b, Float4& c) {
+        const Float4 scale = Splat4(1.0f / 1024.0f);
+        a = __builtin_convertvector((Int4)(r & 0x3FFu), Float4) * scale;
+        b = __builtin_convertvector((Int4)((r >> 10) & 0x3FFu), Float4) * scale;
+        c = __builtin_convertvector((Int4)((r >> 20) & 0x3FFu), Float4) * scale;
+    }
+
+    inline Int4 VoxelCoord4(Float4 v) {
+        v += Splat4(0.5f);
+        // Truncate, then step down where that rounded a negative value up; true
+        // comparison lanes are -1
+        Int4 cell = __builtin_convertvector(v, Int4);
+        return cell + (Int4)(__builtin_convertvector(cell, Float4) > v);
+    }
+#endif
+}
+
+ParticleSystem::ParticleSystem(int capacity) : capacity(capacity), count(0) {
+    for (int lane = 0; lane < RANDOM_LANES; lane++) {
+        rngState[lane] = 0x9E3779B9u * (lane + 1);
+    }
+    posX.resize(capacity); posY.resize(capacity); posZ.resize(capacity);
+    velX.resize(capacity); velY.resize(capacity); velZ.resize(capacity);
+    life.resize(capacity);
+    size.resize(capacity);
+    color.resize(capacity);
+}
+
+uint32_t ParticleSystem::NextRandom(int lane) {
+    // xorshift32
+    uint32_t& state = rngState[lane];
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void ParticleSystem::RandomFloats(int lane, float& a, float& b, float& c) {
+    // Three 10-bit values in [0, 1) from one draw - plenty for visual jitter
+    uint32_t r = NextRandom(lane);
+    const float scale = 1.0f / 1024.0f;
+    a = (r & 0x3FF) * scale;
+    b = ((r >> 10) & 0x3FF) * scale;
+    c = ((r >> 20) & 0x3FF) * scale;
+}
+
+Color ParticleSystem::GetBlockColor(VoxelType type, const TextureManager* textureManager) const {
+    if (!textureManager) return GRAY;
+
+    Color base = textureManager->GetAverageColor(textureManager->GetTextureNameForVoxel(type));
+    Color tint = BlockRegistry::Get().tint[type];
+    base.r = (unsigned char)(base.r * tint.r / 255);
+    base.g = (unsigned char)(base.g * tint.g / 255);
+    base.b = (unsigned char)(base.b * tint.b / 255);
+    return base;
+}
+
+void ParticleSystem::Spawn(Vector3 position, Vector3 velocity, float lifetime, float particleSize, Color tint) {
+    if (count >= capacity) return;
+
+    int i = count++;
+    posX[i] = position.x;
+    posY[i] = position.y;
+    posZ[i] = position.z;
+    velX[i] = velocity.x;
+    velY[i] = velocity.y;
+    velZ[i] = velocity.z;
+    life[i] = lifetime;
+    size[i] = particleSize;
+    color[i] = tint;
+}
+
+void ParticleSystem::SpawnBlockBreak(int x, int y, int z, VoxelType type, const TextureManager* textureManager) {
+    const int N = BLOCK_BREAK_PARTICLES;
+    static_assert(N % RANDOM_LANES == 0, "bursts are worked out one particle per lane");
+
+    int spawned = std::min(N, capacity - count);
+    if (spawned <= 0) return;
+    Color base = GetBlockColor(type, textureManager);
+
+    // The whole burst is worked out on the stack, then the slots that fit are copied in
+    float burstX[N], burstY[N], burstZ[N];
+    float burstVelX[N], burstVelY[N], burstVelZ[N];
+    float burstLife[N], burstSize[N];
+    Color burstColor[N];
+
+#ifdef PARTICLES_SIMD
+    UInt4 lanes;
+    memcpy(&lanes, rngState, sizeof(lanes));
+    for (int n = 0; n < N; n += 4) {
+        // Scatter through the block volume and fly outwards from its center
+        Float4 ox, oy, oz, up, shade, span;
+        UnpackRandom4(XorShift4(lanes), ox, oy, oz);
+        UnpackRandom4(XorShift4(lanes), up, shade, span);
+        ox -= Splat4(0.5f); oy -= Splat4(0.5f); oz -= Splat4(0.5f);
+
+        Store4(burstX + n, Splat4((float)x) + ox);
+        Store4(burstY + n, Splat4((float)y) + oy);
+        Store4(burstZ + n, Splat4((float)z) + oz);
+        Store4(burstVelX + n, ox * Splat4(4.0f));
+        Store4(burstVelY + n, Splat4(2.0f) + up * Splat4(2.0f));
+        Store4(burstVelZ + n, oz * Splat4(4.0f));
+        Store4(burstLife + n, Splat4(0.6f) + span * Splat4(0.6f));
+        Store4(burstSize + n, Splat4(0.08f) + shade * Splat4(0.06f));
+
+        // Slight darkening jitter so the debris doesn't look flat
+        Float4 brightness = Splat4(0.75f) + shade * Splat4(0.25f);
+        Int4 r = __builtin_convertvector(Splat4(base.r) * brightness, Int4);
+        Int4 g = __builtin_convertvector(Splat4(base.g) * brightness, Int4);
+        Int4 b = __builtin_convertvector(Splat4(base.b) * brightness, Int4);
+        for (int lane = 0; lane < 4; lane++) {
+            burstColor[n + lane] = {(unsigned char)r[lane], (unsigned char)g[lane], (unsigned char)b[lane], 255};
+        }
+    }
+    memcpy(rngState, &lanes, sizeof(lanes));
+#else
+    for (int n = 0; n < N; n++) {
+        float ox, oy, oz, up, shade, span;
+        int lane = n % RANDOM_LANES;
+        RandomFloats(lane, ox, oy, oz);
+        RandomFloats(lane, up, shade, span);
+        ox -= 0.5f; oy -= 0.5f; oz -= 0.5f;
+
+        burstX[n] = x + ox;
+        burstY[n] = y + oy;
+        burstZ[n] = z + oz;
+        burstVelX[n] = ox * 4.0f;
+        burstVelY[n] = 2.0f + up * 2.0f;
+        burstVelZ[n] = oz * 4.0f;
+        burstLife[n] = 0.6f + span * 0.6f;
+        burstSize[n] = 0.08f + shade * 0.06f;
+
+        float brightness = 0.75f + shade * 0.25f;
+        burstColor[n] = {(unsigned char)(base.r * brightness), (unsigned char)(base.g * brightness),
+                         (unsigned char)(base.b * brightness), 255};
+    }
+#endif
+
+    int first = count;
+    count += spawned;
+    size_t bytes = spawned * sizeof(float);
+    memcpy(&posX[first], burstX, bytes);
+    memcpy(&posY[first], burstY, bytes);
+    memcpy(&posZ[first], burstZ, bytes);
+    memcpy(&velX[first], burstVelX, bytes);
+    memcpy(&velY[first], burstVelY, bytes);
+    memcpy(&velZ[first], burstVelZ, bytes);
+    memcpy(&life[first], burstLife, bytes);
+    memcpy(&size[first], burstSize, bytes);
+    memcpy(&color[first], burstColor, spawned * sizeof(Color));
+}
+
+void ParticleSystem::SpawnFootstep(Vector3 feet, VoxelType groundType, const TextureManager* textureManager) {
+    Color base = GetBlockColor(groundType, textureManager);
+
+    for (int n = 0; n < FOOTSTEP_PARTICLES; n++) {
+        float ox, oz, up;
+        RandomFloats(n % RANDOM_LANES, ox, oz, up);
+        ox -= 0.5f; oz -= 0.5f;
+        Spawn({feet.x + ox * 0.4f, feet.y + 0.05f, feet.z + oz * 0.4f}, {ox, 1.0f + up, oz},
+              0.3f + up * 0.2f, 0.05f, base);
+    }
+}
+
+void ParticleSystem::Update(float deltaTime, const VoxelWorld* world) {
+    Integrate(deltaTime);
+    if (world) Collide(world);
+
+    // Swap-remove expired particles to keep the live range dense
+    for (int i = 0; i < count;) {
+        if (life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        int last = --count;
+        posX[i] = posX[last]; posY[i] = posY[last]; posZ[i] = posZ[last];
+        velX[i] = velX[last]; velY[i] = velY[last]; velZ[i] = velZ[last];
+        life[i] = life[last];
+        size[i] = size[last];
+        color[i] = color[last];
+    }
+}
+
+void ParticleSystem::Integrate(float deltaTime) {
+    float* px = posX.data();
+    float* py = posY.data();
+    float* pz = posZ.data();
+    float* vx = velX.data();
+    float* vy = velY.data();
+    float* vz = velZ.data();
+    float* lf = life.data();
+    const int n = count;
+    const float gravityStep = PARTICLE_GRAVITY * deltaTime;
+
+    int i = 0;
+#ifdef PARTICLES_SIMD
+    const Float4 dt = Splat4(deltaTime);
+    const Float4 gravity = Splat4(gravityStep);
+    for (; i + 4 <= n; i += 4) {
+        Float4 fall = Load4(vy + i) + gravity;
+        Store4(vy + i, fall);
+        Store4(px + i, Load4(px + i) + Load4(vx + i) * dt);
+        Store4(py + i, Load4(py + i) + fall * dt);
+        Store4(pz + i, Load4(pz + i) + Load4(vz + i) * dt);
+        Store4(lf + i, Load4(lf + i) - dt);
+    }
+#endif
+    for (; i < n; i++) {
+        vy[i] += gravityStep;
+        px[i] += vx[i] * deltaTime;
+        py[i] += vy[i] * deltaTime;
+        pz[i] += vz[i] * deltaTime;
+        lf[i] -= deltaTime;
+    }
+}
+
+void ParticleSystem::Collide(const VoxelWorld* world) {
+    float* px = posX.data();
+    float* py = posY.data();
+    float* pz = posZ.data();
+    float* vx = velX.data();
+    float* vy = velY.data();
+    float* vz = velZ.data();
+    const int n = count;
+
+    // Swap-removal leaves neighbors in the arrays scattered across the world, so
+    // resolve every chunk once up front rather than per particle
+    const int width = world->GetWidth();
+    const int depth = world->GetDepth();
+    chunkTable.resize((size_t)width * depth);
+    for (int x = 0; x < width; x++) {
+        for (int z = 0; z < depth; z++) {
+            chunkTable[x * depth + z] = world->GetChunk(x, z);
+        }
+    }
+
+    int cellX[COLLISION_BLOCK], cellY[COLLISION_BLOCK], cellZ[COLLISION_BLOCK];
+
+    for (int base = 0; base < n; base += COLLISION_BLOCK) {
+        const int blockSize = std::min(COLLISION_BLOCK, n - base);
+
+        int j = 0;
+#ifdef PARTICLES_SIMD
+        for (; j + 4 <= blockSize; j += 4) {
+            Store4(cellX + j, VoxelCoord4(Load4(px + base + j)));
+            Store4(cellY + j, VoxelCoord4(Load4(py + base + j)));
+            Store4(cellZ + j, VoxelCoord4(Load4(pz + base + j)));
+        }
+#endif
+        for (; j < blockSize; j++) {
+            cellX[j] = VoxelCoord(px[base + j]);
+            cellY[j] = VoxelCoord(py[base + j]);
+            cellZ[j] = VoxelCoord(pz[base + j]);
+        }
+
+        // Particles that fell into a solid voxel come to rest on top of it
+        for (j = 0; j < blockSize; j++) {
+            int i = base + j;
+            int y = cellY[j];
+            if (vy[i] >= 0.0f || y < 0 || y >= VoxelChunk::CHUNK_HEIGHT) continue;
+
+            int x = cellX[j], z = cellZ[j];
+            int chunkX = x >> CHUNK_SHIFT, chunkZ = z >> CHUNK_SHIFT;
+            if (chunkX < 0 || chunkX >= width || chunkZ < 0 || chunkZ >= depth) continue;
+
+            const VoxelChunk* chunk = chunkTable[chunkX * depth + chunkZ];
+            const int localMask = VoxelChunk::CHUNK_SIZE - 1;
+            if ((chunk->GetSolidRow(y, z & localMask) >> (x & localMask)) & 1u) {
+                py[i] = y + 0.5f;
+                vy[i] = 0.0f;
+                vx[i] *= GROUND_FRICTION;
+                vz[i] *= GROUND_FRICTION;
+            }
+        }
+    }
+}
+
+void ParticleSystem::Draw(const Camera3D& camera) const {
+    if (count == 0) return;
+
+    // Billboard axes are shared by every particle
+    Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+    Vector3 up = Vector3CrossProduct(right, forward);
+
+    rlSetTexture(0);
+    rlBegin(RL_QUADS);
+    for (int i = 0; i < count; i++) {
+        float half = size[i] * 0.5f;
+        Vector3 r = Vector3Scale(right, half);
+        Vector3 u = Vector3Scale(up, half);
+        Vector3 center = {posX[i], posY[i], posZ[i]};
+
+        rlColor4ub(color[i].r, color[i].g, color[i].b, color[i].a);
+        rlVertex3f(center.x - r.x - u.x, center.y - r.y - u.y, center.z - r.z - u.z);
+        rlVertex3f(center.x + r.x - u.x, center.y + r.y - u.y, center.z + r.z - u.z);
+        rlVertex3f(center.x + r.x + u.x, center.y + r.y + u.y, center.z + r.z + u.z);
+        rlVertex3f(center.x - r.x + u.x, center.y - r.y + u.y, center.z - r.z + u.z);
+    }
+    rlEnd();
+}
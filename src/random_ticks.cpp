@@ -0,0 +1,137 @@
+#include "../include/random_ticks.h"
+#include "../include/job_system.h"
+#include <functional>
+#include <thread>
+
+static const VoxelType TICKABLE_TYPES[] = {VOXEL_GRASS, VOXEL_LEAVES, VOXEL_FIRE};
+
+static const int NEIGHBOR_OFFSETS[6][3] = {
+    {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+};
+
+RandomTickScheduler::RandomTickScheduler(VoxelWorld* world, int cellsPerSection)
+    : world(world), cellsPerSection(cellsPerSection), sectionsTickedLastTick(0), cellsTickedLastTick(0) {
+}
+
+uint32_t RandomTickScheduler::ThreadRandom() {
+    // xorshift32 with one state per thread - no locking, no shared cache lines
+    static thread_local uint32_t state = 0;
+    if (state == 0) {
+        state = (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id()) | 1u;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+bool RandomTickScheduler::HasTickableBlocks(const VoxelChunk* chunk) const {
+    for (VoxelType type : TICKABLE_TYPES) {
+        if (chunk->GetBlockCount(type) > 0) return true;
+    }
+    return false;
+}
+
+bool RandomTickScheduler::IsFlammable(VoxelType type) const {
+    return BlockRegistry::Get().HasFlag(type, BLOCK_FLAMMABLE);
+}
+
+void RandomTickScheduler::TickGrass(int x, int y, int z, std::vector<BlockEdit>& edits) const {
+    // Covered grass dies back to dirt
+    if (IsSolidType(world->GetVoxel(x, y + 1, z).type)) {
+        edits.emplace_back(x, y, z, VOXEL_DIRT);
+        return;
+    }
+
+    // Otherwise try to spread onto one nearby uncovered dirt block
+    uint32_t r = ThreadRandom();
+    int tx = x + (int)(r % 3) - 1;
+    int ty = y + (int)((r >> 2) % 5) - 3;
+    int tz = z + (int)((r >> 5) % 3) - 1;
+    if (world->GetVoxel(tx, ty, tz).type == VOXEL_DIRT && !IsSolidType(world->GetVoxel(tx, ty + 1, tz).type)) {
+        edits.emplace_back(tx, ty, tz, VOXEL_GRASS);
+    }
+}
+
+void RandomTickScheduler::TickLeaves(int x, int y, int z, std::vector<BlockEdit>& edits) const {
+    // Leaves survive while a log is close enough to hold them up
+    for (int dx = -LEAF_DECAY_RADIUS; dx <= LEAF_DECAY_RADIUS; dx++) {
+        for (int dy = -LEAF_DECAY_RADIUS; dy <= LEAF_DECAY_RADIUS; dy++) {
+            for (int dz = -LEAF_DECAY_RADIUS; dz <= LEAF_DECAY_RADIUS; dz++) {
+                if (world->GetVoxel(x + dx, y + dy, z + dz).type == VOXEL_WOOD) {
+                    return;
+                }
+            }
+        }
+    }
+    edits.emplace_back(x, y, z, VOXEL_AIR);
+}
+
+void RandomTickScheduler::TickFire(int x, int y, int z, std::vector<BlockEdit>& edits) const {
+    bool hasFuel = false;
+    for (int i = 0; i < 6; i++) {
+        int nx = x + NEIGHBOR_OFFSETS[i][0];
+        int ny = y + NEIGHBOR_OFFSETS[i][1];
+        int nz = z + NEIGHBOR_OFFSETS[i][2];
+        if (!IsFlammable(world->GetVoxel(nx, ny, nz).type)) continue;
+
+        hasFuel = true;
+        if ((ThreadRandom() & 3) == 0) {
+            edits.emplace_back(nx, ny, nz, VOXEL_FIRE);
+        }
+    }
+
+    // Fire with nothing to burn goes out right away, otherwise eventually
+    if (!hasFuel || (ThreadRandom() & 3) == 0) {
+        edits.emplace_back(x, y, z, VOXEL_AIR);
+    }
+}
+
+void RandomTickScheduler::TickCell(int x, int y, int z, std::vector<BlockEdit>& edits) const {
+    switch (world->GetVoxel(x, y, z).type) {
+        case VOXEL_GRASS: TickGrass(x, y, z, edits); break;
+        case VOXEL_LEAVES: TickLeaves(x, y, z, edits); break;
+        case VOXEL_FIRE: TickFire(x, y, z, edits); break;
+        default: break;
+    }
+}
+
+void RandomTickScheduler::Tick() {
+    // The histogram check is the only per-section cost for sections without tickable
+    // blocks. Workers hold the section and the neighbors grass and fire spread into.
+    std::vector<int> sections;
+    std::vector<ChunkHandle> held;
+    for (int chunkX = 0; chunkX < world->GetWidth(); chunkX++) {
+        for (int chunkZ = 0; chunkZ < world->GetDepth(); chunkZ++) {
+            const VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+            if (chunk && HasTickableBlocks(chunk) && world->AcquireChunkArea(chunkX, chunkZ, held)) {
+                sections.push_back(chunkX * world->GetDepth() + chunkZ);
+            }
+        }
+    }
+
+    std::vector<std::vector<BlockEdit>> sectionEdits(sections.size());
+    int depth = world->GetDepth();
+
+    JobSystem::Get().ParallelFor((int)sections.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int baseX = (sections[i] / depth) * VoxelChunk::CHUNK_SIZE;
+            int baseZ = (sections[i] % depth) * VoxelChunk::CHUNK_SIZE;
+
+            for (int n = 0; n < cellsPerSection; n++) {
+                int localX, y, localZ;
+                VoxelChunk::CellCoords((int)(ThreadRandom() % VoxelChunk::CHUNK_VOLUME), localX, y, localZ);
+                TickCell(baseX + localX, y, baseZ + localZ, sectionEdits[i]);
+            }
+        }
+    });
+
+    std::vector<BlockEdit> edits;
+    for (const std::vector<BlockEdit>& sectionEdit : sectionEdits) {
+        edits.insert(edits.end(), sectionEdit.begin(), sectionEdit.end());
+    }
+    world->ApplyEdits(edits);
+
+    sectionsTickedLastTick = (int)sections.size();
+    cellsTickedLastTick = (int)sections.size() * cellsPerSection;
+}
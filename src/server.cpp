@@ -0,0 +1,480 @@
+#include "../include/server.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Little-endian, as PacketWriter writes; for update entries built outside a packet
+    void AppendU32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+}
+
+GameServer::GameServer(int widthInChunks, int depthInChunks)
+    : world(widthInChunks, depthInChunks), nextClientId(1), bandwidthLimit(DEFAULT_BANDWIDTH_LIMIT),
+      editListenerId(-1), tickCount(0), lastTickMs(0.0f), deltaUpdatesSent(0), fullUpdatesSent(0), chunksSent(0),
+      cachedChunksUsed(0) {
+    // The registry is shared with the renderer in singleplayer; registering again is harmless
+    BlockRegistry& registry = BlockRegistry::Get();
+    registry.LoadModels();
+    registry.LoadFromJson();
+
+    world.GenerateTestTerrain();
+    blockTicks.reset(new BlockTickScheduler(&world));
+    fluids.reset(new FluidSimulator(&world));
+    randomTicks.reset(new RandomTickScheduler(&world));
+
+    // Every edit, whatever caused it, is sent at the end of the tick.
+    // Only which cells changed is recorded; the values are read when sending.
+    changedCells.resize(widthInChunks * depthInChunks);
+    subscribers.resize(widthInChunks * depthInChunks);
+    chunkHashes.resize(widthInChunks * depthInChunks, 0);
+    editListenerId = world.AddEditListener([this](int chunkX, int chunkZ, const std::vector<BlockEdit>& edits) {
+        int chunkIndex = chunkX * world.GetDepth() + chunkZ;
+        ChunkCodec::CellMask& mask = changedCells[chunkIndex];
+        if (mask.none()) changedChunks.push_back(chunkIndex);
+        chunkHashes[chunkIndex] = 0;
+        for (const BlockEdit& edit : edits) {
+            mask.set(VoxelChunk::CellIndex(edit.x - chunkX * VoxelChunk::CHUNK_SIZE, edit.y,
+                                           edit.z - chunkZ * VoxelChunk::CHUNK_SIZE));
+        }
+    });
+}
+
+GameServer::~GameServer() {
+    for (auto& client : clients) {
+        PacketWriter writer(PACKET_DISCONNECT);
+        writer.WriteString("Server closed");
+        client->connection->Send(writer);
+    }
+    world.RemoveEditListener(editListenerId);
+}
+
+bool GameServer::Listen(int port) {
+    if (!listener.Listen(port)) return false;
+    std::cout << "Server listening on port " << port << std::endl;
+    return true;
+}
+
+int GameServer::AddClient(std::unique_ptr<Connection> connection, int bytesPerSecond) {
+    std::unique_ptr<ClientSession> client(new ClientSession());
+    client->id = nextClientId++;
+    client->connection = std::move(connection);
+    client->chunkInterest.assign(world.GetWidth() * world.GetDepth(), INTEREST_NONE);
+    client->bytesPerTick = (int)(bytesPerSecond * TICK_INTERVAL);
+    std::cout << "Client " << client->id << " connected from " << client->connection->GetDescription() << std::endl;
+    clients.push_back(std::move(client));
+    return clients.back()->id;
+}
+
+std::unique_ptr<Connection> GameServer::ConnectLoopback() {
+    std::unique_ptr<Connection> serverEnd, clientEnd;
+    LoopbackConnection::CreatePair(serverEnd, clientEnd);
+    AddClient(std::move(serverEnd), 0);
+    return clientEnd;
+}
+
+void GameServer::AcceptClients() {
+    while (std::unique_ptr<Connection> connection = listener.Accept()) {
+        AddClient(std::move(connection));
+    }
+}
+
+void GameServer::Tick() {
+    auto start = std::chrono::steady_clock::now();
+
+    AcceptClients();
+
+    std::vector<std::vector<uint8_t>> packets;
+    for (auto& client : clients) {
+        packets.clear();
+        client->connection->Poll(packets);
+        for (const std::vector<uint8_t>& packet : packets) {
+            HandlePacket(*client, packet);
+        }
+    }
+
+    // Player edits first, so this tick's simulation reacts to them
+    if (!requestedEdits.empty()) {
+        world.ApplyEdits(requestedEdits);
+        requestedEdits.clear();
+    }
+
+    blockTicks->Tick();
+    fluids->Tick();
+    randomTicks->Tick();
+
+    // Updates to chunks clients already have go first; new chunks are sent with
+    // their current contents and only get updates from the next tick on
+    BroadcastChunkUpdates();
+    for (auto& client : clients) {
+        if (!client->joined) continue;
+        FlushClientUpdates(*client);
+        SendQueuedChunks(*client);
+    }
+    DropClosedClients();
+
+    // Chunks no player or simulation touched for a while
+    world.CompressColdChunks(TICK_INTERVAL);
+
+    tickCount++;
+    lastTickMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void GameServer::HandlePacket(ClientSession& client, const std::vector<uint8_t>& packet) {
+    PacketReader reader(packet);
+    PacketType type = reader.GetType();
+
+    // Nothing but HELLO is accepted before the client has joined
+    if (!client.joined && type != PACKET_HELLO) return;
+
+    switch (type) {
+        case PACKET_HELLO: {
+            uint32_t version = reader.ReadU32();
+            std::string name = reader.ReadString();
+            Vector3 position = {reader.ReadF32(), reader.ReadF32(), reader.ReadF32()};
+            int viewDistance = reader.ReadU8();
+            bool hasCache = reader.ReadU8() != 0;
+            uint32_t cachedCount = reader.ReadU32();
+            if (!reader.IsValid() || version != PROTOCOL_VERSION || cachedCount > reader.GetRemaining() / 16) {
+                PacketWriter writer(PACKET_DISCONNECT);
+                writer.WriteString("Protocol version mismatch");
+                client.connection->Send(writer);
+                client.connection->Close();
+                return;
+            }
+            if (client.joined) break;
+
+            if (hasCache) client.cachedHashes.assign(world.GetWidth() * world.GetDepth(), 0);
+            for (uint32_t i = 0; i < cachedCount; i++) {
+                int chunkX = reader.ReadI32(), chunkZ = reader.ReadI32();
+                uint64_t hash = reader.ReadU64();
+                if (hasCache && chunkX >= 0 && chunkZ >= 0 && chunkX < world.GetWidth() && chunkZ < world.GetDepth()) {
+                    client.cachedHashes[chunkX * world.GetDepth() + chunkZ] = hash;
+                }
+            }
+            Join(client, name, position, viewDistance);
+            break;
+        }
+        case PACKET_PLAYER_MOVE: {
+            Vector3 position = {reader.ReadF32(), reader.ReadF32(), reader.ReadF32()};
+            if (reader.IsValid()) MoveClient(client, position);
+            break;
+        }
+        case PACKET_SET_BLOCK: {
+            int x = reader.ReadI32(), y = reader.ReadI32(), z = reader.ReadI32();
+            int blockType = reader.ReadU8();
+            if (!reader.IsValid() || !BlockRegistry::Get().IsDefined(blockType)) return;
+            if (x < 0 || z < 0 || x >= world.GetWidth() * VoxelChunk::CHUNK_SIZE ||
+                z >= world.GetDepth() * VoxelChunk::CHUNK_SIZE || y < 0 || y >= VoxelChunk::CHUNK_HEIGHT) return;
+
+            // Unbreakable blocks stay put, whoever asks
+            Voxel current = world.GetVoxel(x, y, z);
+            if (current.isActive && !BlockRegistry::Get().HasFlag(current.type, BLOCK_BREAKABLE)) return;
+            requestedEdits.emplace_back(x, y, z, (VoxelType)blockType);
+            break;
+        }
+        case PACKET_EXPLODE: {
+            Vector3 center = {reader.ReadF32(), reader.ReadF32(), reader.ReadF32()};
+            float power = reader.ReadF32();
+            if (reader.IsValid() && power > 0.0f && power <= 16.0f) HandleExplode(center, power);
+            break;
+        }
+        case PACKET_REQUEST_CHUNK: {
+            int chunkX = reader.ReadI32(), chunkZ = reader.ReadI32();
+            if (reader.IsValid()) ResendChunk(client, chunkX, chunkZ);
+            break;
+        }
+        case PACKET_DISCONNECT:
+            client.connection->Close();
+            break;
+        default:
+            break;
+    }
+}
+
+void GameServer::Join(ClientSession& client, const std::string& name, Vector3 position, int viewDistance) {
+    client.name = name;
+    client.joined = true;
+    client.position = position;
+    client.viewDistance = viewDistance > 0 ? std::min(viewDistance, (int)MAX_VIEW_DISTANCE) : DEFAULT_VIEW_DISTANCE;
+
+    PacketWriter welcome(PACKET_WELCOME);
+    welcome.WriteU32((uint32_t)client.id);
+    welcome.WriteU16((uint16_t)world.GetWidth());
+    welcome.WriteU16((uint16_t)world.GetDepth());
+    client.connection->Send(welcome);
+
+    UpdateView(client);
+    std::cout << "Client " << client.id << " joined as " << name << std::endl;
+}
+
+void GameServer::MoveClient(ClientSession& client, Vector3 position) {
+    float dx = position.x - client.position.x;
+    float dz = position.z - client.position.z;
+    float distance = sqrtf(dx * dx + dz * dz);
+    if (distance > 0.01f) {
+        client.travel = {dx / distance, 0.0f, dz / distance};
+        client.queueNeedsSort = !client.sendQueue.empty();
+    }
+    client.position = position;
+
+    int chunkX, chunkZ;
+    ChunkIndexAt(position, chunkX, chunkZ);
+    if (chunkX != client.viewChunkX || chunkZ != client.viewChunkZ) UpdateView(client);
+}
+
+void GameServer::HandleExplode(const Vector3& center, float power) {
+    std::vector<BlockEdit> destroyed;
+    world.Explode(center, power, &destroyed);
+    if (destroyed.empty()) return;
+
+    // The removed blocks go out with the tick's updates; this packet is for the effects
+    PacketWriter writer(PACKET_EXPLOSION);
+    writer.WriteF32(center.x);
+    writer.WriteF32(center.y);
+    writer.WriteF32(center.z);
+    writer.WriteU32((uint32_t)destroyed.size());
+    for (const BlockEdit& block : destroyed) {
+        writer.WriteI32(block.x);
+        writer.WriteI32(block.y);
+        writer.WriteI32(block.z);
+        writer.WriteU8((uint8_t)block.type);
+    }
+
+    int chunkX, chunkZ;
+    int chunkIndex = ChunkIndexAt(center, chunkX, chunkZ);
+    if (chunkIndex >= 0) pendingEffects.emplace_back(chunkIndex, std::move(writer.GetData()));
+}
+
+void GameServer::ResendChunk(ClientSession& client, int chunkX, int chunkZ) {
+    if (chunkX < 0 || chunkZ < 0 || chunkX >= world.GetWidth() || chunkZ >= world.GetDepth()) return;
+    int chunkIndex = chunkX * world.GetDepth() + chunkZ;
+    if (client.chunkInterest[chunkIndex] != INTEREST_SUBSCRIBED) return;
+
+    // Back to the queue, this time without trusting the cache
+    Unsubscribe(client, chunkIndex, false);
+    if (!client.cachedHashes.empty()) client.cachedHashes[chunkIndex] = 0;
+    client.chunkInterest[chunkIndex] = INTEREST_QUEUED;
+    client.sendQueue.push_back(chunkIndex);
+    client.queueNeedsSort = true;
+}
+
+uint64_t GameServer::GetChunkHash(int chunkIndex) {
+    uint64_t& hash = chunkHashes[chunkIndex];
+    if (hash == 0) hash = ChunkCodec::Hash(*world.GetChunk(chunkIndex / world.GetDepth(), chunkIndex % world.GetDepth()));
+    return hash;
+}
+
+// Interest management
+
+int GameServer::ChunkIndexAt(Vector3 position, int& chunkX, int& chunkZ) const {
+    chunkX = (int)floorf(position.x / VoxelChunk::CHUNK_SIZE);
+    chunkZ = (int)floorf(position.z / VoxelChunk::CHUNK_SIZE);
+    if (chunkX < 0 || chunkZ < 0 || chunkX >= world.GetWidth() || chunkZ >= world.GetDepth()) return -1;
+    return chunkX * world.GetDepth() + chunkZ;
+}
+
+void GameServer::UpdateView(ClientSession& client) {
+    int centerX, centerZ;
+    ChunkIndexAt(client.position, centerX, centerZ);
+    int oldX = client.viewChunkX, oldZ = client.viewChunkZ;
+    client.viewChunkX = centerX;
+    client.viewChunkZ = centerZ;
+
+    // Only the squares around the old and new centers are visited, so moving
+    // costs the view area whatever the size of the world
+    int keepRadius = client.viewDistance + UNSUBSCRIBE_MARGIN;
+    for (int x = std::max(0, oldX - keepRadius); x <= std::min(world.GetWidth() - 1, oldX + keepRadius); x++) {
+        for (int z = std::max(0, oldZ - keepRadius); z <= std::min(world.GetDepth() - 1, oldZ + keepRadius); z++) {
+            int dx = x - centerX, dz = z - centerZ;
+            if (dx * dx + dz * dz > keepRadius * keepRadius) {
+                Unsubscribe(client, x * world.GetDepth() + z, true);
+            }
+        }
+    }
+
+    int radius = client.viewDistance;
+    for (int x = std::max(0, centerX - radius); x <= std::min(world.GetWidth() - 1, centerX + radius); x++) {
+        for (int z = std::max(0, centerZ - radius); z <= std::min(world.GetDepth() - 1, centerZ + radius); z++) {
+            int dx = x - centerX, dz = z - centerZ;
+            int chunkIndex = x * world.GetDepth() + z;
+            if (dx * dx + dz * dz <= radius * radius && client.chunkInterest[chunkIndex] == INTEREST_NONE) {
+                client.chunkInterest[chunkIndex] = INTEREST_QUEUED;
+                client.sendQueue.push_back(chunkIndex);
+            }
+        }
+    }
+
+    // Queued chunks that left view before being sent
+    client.sendQueue.erase(std::remove_if(client.sendQueue.begin(), client.sendQueue.end(),
+                                          [&client](int chunkIndex) {
+                                              return client.chunkInterest[chunkIndex] != INTEREST_QUEUED;
+                                          }),
+                           client.sendQueue.end());
+    client.queueNeedsSort = !client.sendQueue.empty();
+}
+
+void GameServer::Unsubscribe(ClientSession& client, int chunkIndex, bool notify) {
+    uint8_t interest = client.chunkInterest[chunkIndex];
+    client.chunkInterest[chunkIndex] = INTEREST_NONE;
+    if (interest != INTEREST_SUBSCRIBED) return;
+
+    std::vector<ClientSession*>& chunkSubscribers = subscribers[chunkIndex];
+    chunkSubscribers.erase(std::remove(chunkSubscribers.begin(), chunkSubscribers.end(), &client), chunkSubscribers.end());
+
+    if (notify) {
+        // The client caches what it has now, which is current unless this tick
+        // already changed the chunk (an explosion during packet handling)
+        if (!client.cachedHashes.empty()) {
+            client.cachedHashes[chunkIndex] = changedCells[chunkIndex].none() ? GetChunkHash(chunkIndex) : 0;
+        }
+
+        PacketWriter writer(PACKET_CHUNK_UNLOAD);
+        writer.WriteI32(chunkIndex / world.GetDepth());
+        writer.WriteI32(chunkIndex % world.GetDepth());
+        client.connection->Send(writer);
+    }
+}
+
+void GameServer::SortSendQueue(ClientSession& client) {
+    // Lower is sooner: distance from the player, shortened for chunks in the
+    // direction of travel so the world ahead arrives first
+    auto priority = [this, &client](int chunkIndex) {
+        float centerX = (chunkIndex / world.GetDepth() + 0.5f) * VoxelChunk::CHUNK_SIZE;
+        float centerZ = (chunkIndex % world.GetDepth() + 0.5f) * VoxelChunk::CHUNK_SIZE;
+        float dx = centerX - client.position.x;
+        float dz = centerZ - client.position.z;
+        float distance = sqrtf(dx * dx + dz * dz);
+        if (distance < 0.001f) return 0.0f;
+        float alignment = (dx * client.travel.x + dz * client.travel.z) / distance;
+        return distance * (1.0f - TRAVEL_PRIORITY_WEIGHT * alignment);
+    };
+
+    std::vector<std::pair<float, int>> scored;
+    scored.reserve(client.sendQueue.size());
+    for (int chunkIndex : client.sendQueue) {
+        scored.emplace_back(priority(chunkIndex), chunkIndex);
+    }
+    std::sort(scored.begin(), scored.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+        return a.first > b.first;  // Best last, for pop_back
+    });
+    for (size_t i = 0; i < scored.size(); i++) {
+        client.sendQueue[i] = scored[i].second;
+    }
+    client.queueNeedsSort = false;
+}
+
+void GameServer::SendQueuedChunks(ClientSession& client) {
+    if (client.bytesPerTick > 0) {
+        // At most a second's worth of budget builds up while idle
+        client.sendBudget = std::min(client.sendBudget + client.bytesPerTick, client.bytesPerTick / TICK_INTERVAL);
+    }
+    if (client.sendQueue.empty()) return;
+    if (client.queueNeedsSort) SortSendQueue(client);
+
+    while (!client.sendQueue.empty() && (client.bytesPerTick == 0 || client.sendBudget > 0.0f)) {
+        int chunkIndex = client.sendQueue.back();
+        client.sendQueue.pop_back();
+
+        int chunkX = chunkIndex / world.GetDepth();
+        int chunkZ = chunkIndex % world.GetDepth();
+        bool cached = !client.cachedHashes.empty() && client.cachedHashes[chunkIndex] != 0 &&
+                      client.cachedHashes[chunkIndex] == GetChunkHash(chunkIndex);
+        PacketWriter writer(cached ? PACKET_CHUNK_CACHED : PACKET_CHUNK_DATA);
+        writer.WriteI32(chunkX);
+        writer.WriteI32(chunkZ);
+        if (cached) {
+            cachedChunksUsed++;
+        } else {
+            WriteChunkData(writer, *world.GetChunk(chunkX, chunkZ));
+        }
+        client.sendBudget -= writer.GetSize();
+        client.connection->Send(writer);
+
+        client.chunkInterest[chunkIndex] = INTEREST_SUBSCRIBED;
+        subscribers[chunkIndex].push_back(&client);
+        chunksSent++;
+    }
+}
+
+void GameServer::BroadcastChunkUpdates() {
+    std::vector<uint8_t> entry;
+    std::vector<uint8_t> encoded;
+    for (int chunkIndex : changedChunks) {
+        ChunkCodec::CellMask& mask = changedCells[chunkIndex];
+        if (subscribers[chunkIndex].empty()) {
+            mask.reset();
+            continue;
+        }
+
+        int chunkX = chunkIndex / world.GetDepth();
+        int chunkZ = chunkIndex % world.GetDepth();
+        const VoxelChunk& chunk = *world.GetChunk(chunkX, chunkZ);
+
+        // Big deltas (explosions, fills) can cost more than the whole chunk
+        encoded.clear();
+        size_t deltaSize = ChunkCodec::GetDeltaSize(mask);
+        if (deltaSize > FULL_RESEND_CHECK_BYTES) ChunkCodec::Encode(chunk, encoded);
+
+        // Encoded once, copied to every subscriber
+        entry.clear();
+        AppendU32(entry, (uint32_t)chunkX);
+        AppendU32(entry, (uint32_t)chunkZ);
+        if (!encoded.empty() && encoded.size() + 4 < deltaSize) {
+            entry.push_back(CHUNK_UPDATE_FULL);
+            AppendU32(entry, (uint32_t)encoded.size());
+            entry.insert(entry.end(), encoded.begin(), encoded.end());
+            fullUpdatesSent++;
+        } else {
+            entry.push_back(CHUNK_UPDATE_DELTA);
+            ChunkCodec::EncodeDelta(chunk, mask, entry);
+            deltaUpdatesSent++;
+        }
+        mask.reset();
+
+        for (ClientSession* client : subscribers[chunkIndex]) {
+            client->pendingUpdates.insert(client->pendingUpdates.end(), entry.begin(), entry.end());
+            client->pendingUpdateCount++;
+        }
+    }
+    changedChunks.clear();
+
+    for (const auto& effect : pendingEffects) {
+        for (ClientSession* client : subscribers[effect.first]) {
+            client->connection->Send(effect.second);
+        }
+    }
+    pendingEffects.clear();
+}
+
+void GameServer::FlushClientUpdates(ClientSession& client) {
+    if (client.pendingUpdateCount == 0) return;
+
+    PacketWriter writer(PACKET_CHUNK_UPDATES);
+    writer.WriteU16((uint16_t)client.pendingUpdateCount);
+    writer.WriteBytes(client.pendingUpdates.data(), client.pendingUpdates.size());
+    client.sendBudget -= writer.GetSize();
+    client.connection->Send(writer);
+
+    client.pendingUpdates.clear();
+    client.pendingUpdateCount = 0;
+}
+
+void GameServer::DropClosedClients() {
+    for (auto& client : clients) {
+        if (client->connection->IsOpen()) continue;
+        std::cout << "Client " << client->id << " disconnected" << std::endl;
+        for (int chunkIndex = 0; chunkIndex < (int)client->chunkInterest.size(); chunkIndex++) {
+            Unsubscribe(*client, chunkIndex, false);
+        }
+    }
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [](const std::unique_ptr<ClientSession>& client) {
+                                     return !client->connection->IsOpen();
+                                 }),
+                  clients.end());
+}
@@ -0,0 +1,58 @@
+#include "../include/server.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// Dedicated server: the simulation with no window, for headless machines.
+// Usage: rayCaveServer [port] [width in chunks] [depth in chunks]
+
+static std::atomic<bool> running(true);
+
+static void HandleSignal(int) {
+    running = false;
+}
+
+int main(int argc, char** argv) {
+    int port = argc > 1 ? atoi(argv[1]) : DEFAULT_SERVER_PORT;
+    int width = argc > 2 ? atoi(argv[2]) : 4;
+    int depth = argc > 3 ? atoi(argv[3]) : 4;
+    if (port <= 0 || width <= 0 || depth <= 0) {
+        std::cout << "Usage: " << argv[0] << " [port] [width in chunks] [depth in chunks]" << std::endl;
+        return 1;
+    }
+
+    signal(SIGINT, HandleSignal);
+    signal(SIGTERM, HandleSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    GameServer server(width, depth);
+    if (!server.Listen(port)) return 1;
+
+    // Fixed tick rate; a slow tick delays the next one instead of piling up
+    const auto tickLength = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>(GameServer::TICK_INTERVAL));
+    auto nextTick = std::chrono::steady_clock::now();
+    float worstTickMs = 0.0f;
+
+    while (running) {
+        server.Tick();
+        if (server.GetLastTickMs() > worstTickMs) worstTickMs = server.GetLastTickMs();
+
+        if (server.GetTickCount() % 200 == 0) {
+            std::cout << "Tick " << server.GetTickCount() << ": " << server.GetClientCount() << " clients, "
+                      << "last " << server.GetLastTickMs() << " ms, worst " << worstTickMs << " ms" << std::endl;
+            worstTickMs = 0.0f;
+        }
+
+        nextTick += tickLength;
+        auto now = std::chrono::steady_clock::now();
+        if (nextTick < now) nextTick = now;
+        std::this_thread::sleep_until(nextTick);
+    }
+
+    std::cout << "Server stopping" << std::endl;
+    return 0;
+}
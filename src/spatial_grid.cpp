@@ -0,0 +1,227 @@
+#include "../include/spatial_grid.h"
+#include "../include/voxel.h"
+#include <algorithm>
+#include <cmath>
+
+static_assert(SpatialGrid::CELL_SIZE * SpatialGrid::CELLS_PER_CHUNK == VoxelChunk::CHUNK_SIZE,
+              "Grid cells must tile chunks exactly");
+
+SpatialGrid::SpatialGrid() : bucketMask(0), maxRadius(0.0f) {
+    bucketStart.assign(2, 0);
+}
+
+int SpatialGrid::CellCoord(float v) {
+    // Voxels are centered on integer coordinates, so chunk/voxel boundaries sit at -0.5
+    return (int)floorf((v + 0.5f) / CELL_SIZE);
+}
+
+uint64_t SpatialGrid::PackCell(int cx, int cy, int cz) {
+    return ((uint64_t)(cx & 0x1FFFFF) << 42) | ((uint64_t)(cy & 0x1FFFFF) << 21) | (uint64_t)(cz & 0x1FFFFF);
+}
+
+uint32_t SpatialGrid::BucketForCell(int cx, int cy, int cz) const {
+    uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u ^ (uint32_t)cz * 83492791u;
+    return h & bucketMask;
+}
+
+void SpatialGrid::Clear() {
+    stagedIds.clear();
+    stagedX.clear();
+    stagedY.clear();
+    stagedZ.clear();
+    stagedRadius.clear();
+    maxRadius = 0.0f;
+}
+
+void SpatialGrid::Insert(EntityId id, Vector3 position, float radius) {
+    stagedIds.push_back(id);
+    stagedX.push_back(position.x);
+    stagedY.push_back(position.y);
+    stagedZ.push_back(position.z);
+    stagedRadius.push_back(radius);
+    if (radius > maxRadius) maxRadius = radius;
+}
+
+void SpatialGrid::Build() {
+    size_t count = stagedIds.size();
+
+    // Keep roughly one bucket per entry so chains stay short
+    uint32_t bucketCount = 1024;
+    while (bucketCount < count) bucketCount <<= 1;
+    bucketMask = bucketCount - 1;
+
+    stagedCell.resize(count);
+    stagedBucket.resize(count);
+    bucketStart.assign(bucketCount + 1, 0);
+
+    // Pass 1: bucket each entry and count
+    for (size_t i = 0; i < count; i++) {
+        int cx = CellCoord(stagedX[i]);
+        int cy = CellCoord(stagedY[i]);
+        int cz = CellCoord(stagedZ[i]);
+        stagedCell[i] = PackCell(cx, cy, cz);
+        stagedBucket[i] = BucketForCell(cx, cy, cz);
+        bucketStart[stagedBucket[i] + 1]++;
+    }
+
+    // Pass 2: prefix sum into bucket offsets
+    for (uint32_t b = 0; b < bucketCount; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // Pass 3: scatter into sorted arrays
+    sortedIds.resize(count);
+    sortedX.resize(count);
+    sortedY.resize(count);
+    sortedZ.resize(count);
+    sortedRadius.resize(count);
+    sortedCell.resize(count);
+
+    // bucketStart[b] doubles as the write cursor for bucket b
+    for (size_t i = 0; i < count; i++) {
+        uint32_t slot = bucketStart[stagedBucket[i]]++;
+        sortedIds[slot] = stagedIds[i];
+        sortedX[slot] = stagedX[i];
+        sortedY[slot] = stagedY[i];
+        sortedZ[slot] = stagedZ[i];
+        sortedRadius[slot] = stagedRadius[i];
+        sortedCell[slot] = stagedCell[i];
+    }
+
+    // The scatter advanced every start to its bucket's end; shift back
+    for (uint32_t b = bucketCount; b > 0; b--) {
+        bucketStart[b] = bucketStart[b - 1];
+    }
+    bucketStart[0] = 0;
+}
+
+template <typename Fn>
+void SpatialGrid::VisitCells(int minX, int minY, int minZ, int maxX, int maxY, int maxZ, Fn fn) const {
+    for (int cx = minX; cx <= maxX; cx++) {
+        for (int cy = minY; cy <= maxY; cy++) {
+            for (int cz = minZ; cz <= maxZ; cz++) {
+                uint64_t cell = PackCell(cx, cy, cz);
+                uint32_t bucket = BucketForCell(cx, cy, cz);
+
+                for (uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++) {
+                    // Buckets are shared between cells, skip entries from other cells
+                    if (sortedCell[i] == cell) {
+                        fn(i);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::QueryAABB(BoundingBox box, std::vector<EntityId>& results) const {
+    results.clear();
+    AppendAABB(box, results);
+}
+
+void SpatialGrid::QueryRadius(Vector3 center, float radius, std::vector<EntityId>& results) const {
+    results.clear();
+    AppendRadius(center, radius, results);
+}
+
+void SpatialGrid::AppendAABB(BoundingBox box, std::vector<EntityId>& results) const {
+    if (sortedIds.empty()) return;
+
+    // Entries are binned by center, so widen by the largest radius
+    VisitCells(CellCoord(box.min.x - maxRadius), CellCoord(box.min.y - maxRadius), CellCoord(box.min.z - maxRadius),
+               CellCoord(box.max.x + maxRadius), CellCoord(box.max.y + maxRadius), CellCoord(box.max.z + maxRadius),
+               [&](uint32_t i) {
+        float r = sortedRadius[i];
+        if (sortedX[i] + r >= box.min.x && sortedX[i] - r <= box.max.x &&
+            sortedY[i] + r >= box.min.y && sortedY[i] - r <= box.max.y &&
+            sortedZ[i] + r >= box.min.z && sortedZ[i] - r <= box.max.z) {
+            results.push_back(sortedIds[i]);
+        }
+    });
+}
+
+void SpatialGrid::AppendRadius(Vector3 center, float radius, std::vector<EntityId>& results) const {
+    if (sortedIds.empty()) return;
+
+    float reach = radius + maxRadius;
+    VisitCells(CellCoord(center.x - reach), CellCoord(center.y - reach), CellCoord(center.z - reach),
+               CellCoord(center.x + reach), CellCoord(center.y + reach), CellCoord(center.z + reach),
+               [&](uint32_t i) {
+        float dx = sortedX[i] - center.x;
+        float dy = sortedY[i] - center.y;
+        float dz = sortedZ[i] - center.z;
+        float limit = radius + sortedRadius[i];
+        if (dx * dx + dy * dy + dz * dz <= limit * limit) {
+            results.push_back(sortedIds[i]);
+        }
+    });
+}
+
+// Voxel range covered by [minV, maxV); touching a face doesn't count as overlap
+static void VoxelRange(float minV, float maxV, int& first, int& last) {
+    first = (int)floorf(minV + 0.5f);
+    last = (int)ceilf(maxV + 0.5f) - 1;
+}
+
+bool SpatialGrid::BoxHitsVoxels(const VoxelWorld* world, BoundingBox box) {
+    if (!world) return false;
+
+    int minX, maxX, minY, maxY, minZ, maxZ;
+    VoxelRange(box.min.x, box.max.x, minX, maxX);
+    VoxelRange(box.min.y, box.max.y, minY, maxY);
+    VoxelRange(box.min.z, box.max.z, minZ, maxZ);
+
+    // Nothing outside the world is solid
+    minX = std::max(minX, 0);
+    maxX = std::min(maxX, world->GetWidth() * VoxelChunk::CHUNK_SIZE - 1);
+    minY = std::max(minY, 0);
+    maxY = std::min(maxY, VoxelChunk::CHUNK_HEIGHT - 1);
+    minZ = std::max(minZ, 0);
+    maxZ = std::min(maxZ, world->GetDepth() * VoxelChunk::CHUNK_SIZE - 1);
+
+    // Walk chunk by chunk and test whole rows against the solid bitmask
+    for (int z = minZ; z <= maxZ; z++) {
+        int x = minX;
+        while (x <= maxX) {
+            int chunkX, chunkZ, localX, localZ;
+            world->WorldToChunkCoords(x, z, chunkX, chunkZ, localX, localZ);
+            int spanEnd = std::min(maxX, x + (VoxelChunk::CHUNK_SIZE - 1 - localX));
+
+            const VoxelChunk* chunk = world->GetChunk(chunkX, chunkZ);
+            if (chunk) {
+                int localEnd = localX + (spanEnd - x);
+                uint32_t bits = ((1u << (localEnd + 1)) - 1u) & ~((1u << localX) - 1u);
+                for (int y = minY; y <= maxY; y++) {
+                    if (chunk->GetSolidRow(y, localZ) & bits) {
+                        return true;
+                    }
+                }
+            }
+            x = spanEnd + 1;
+        }
+    }
+    return false;
+}
+
+void SpatialGrid::QueryVoxelBoxes(const VoxelWorld* world, BoundingBox box, std::vector<BoundingBox>& results) {
+    results.clear();
+    if (!world) return;
+
+    int minX, maxX, minY, maxY, minZ, maxZ;
+    VoxelRange(box.min.x, box.max.x, minX, maxX);
+    VoxelRange(box.min.y, box.max.y, minY, maxY);
+    VoxelRange(box.min.z, box.max.z, minZ, maxZ);
+
+    for (int x = minX; x <= maxX; x++) {
+        for (int y = minY; y <= maxY; y++) {
+            for (int z = minZ; z <= maxZ; z++) {
+                if (world->IsSolid(x, y, z)) {
+                    results.push_back((BoundingBox){
+                        (Vector3){x - 0.5f, y - 0.5f, z - 0.5f},
+                        (Vector3){x + 0.5f, y + 0.5f, z + 0.5f}
+                    });
+                }
+            }
+        }
+    }
+}
@@ -8,6 +8,9 @@ TextureManager::TextureManager(const std::string& basePath)
     : textureBasePath(basePath) {
     defaultMaterial = LoadMaterialDefault();
     
+    // Block models first so blocks.json can refer to them
+    BlockRegistry::Get().LoadModels();
+    
     // Try to load block data from JSON first
     if (LoadBlockData()) {
         LoadTexturesFromBlockData(); // Load textures based on block data
@@ -23,227 +26,7 @@ TextureManager::~TextureManager() {
 }
 
 bool TextureManager::LoadBlockData(const std::string& jsonFilePath) {
-    std::cout << "Attempting to load block data from: " << jsonFilePath << std::endl;
-    
-    std::ifstream file(jsonFilePath);
-    if (!file.is_open()) {
-        std::cout << "Failed to open blocks.json file: " << jsonFilePath << std::endl;
-        return false;
-    }
-    
-    // Read the entire file
-    std::string jsonContent((std::istreambuf_iterator<char>(file)),
-                           std::istreambuf_iterator<char>());
-    file.close();
-    
-    std::cout << "JSON file size: " << jsonContent.size() << " bytes" << std::endl;
-    
-    // Simple JSON parsing for our specific structure
-    try {
-        // Find the blocks array
-        size_t blocksStart = jsonContent.find("\"blocks\":");
-        if (blocksStart == std::string::npos) {
-            std::cout << "Could not find 'blocks' array in JSON" << std::endl;
-            return false;
-        }
-        
-        // Find the opening bracket of the blocks array
-        size_t arrayStart = jsonContent.find('[', blocksStart);
-        if (arrayStart == std::string::npos) {
-            std::cout << "Could not find opening bracket for blocks array" << std::endl;
-            return false;
-        }
-        
-        // Parse each block object
-        size_t pos = arrayStart + 1;
-        int blockCount = 0;
-        
-        while (pos < jsonContent.length()) {
-            // Skip whitespace
-            while (pos < jsonContent.length() && (jsonContent[pos] == ' ' || jsonContent[pos] == '\n' || jsonContent[pos] == '\t' || jsonContent[pos] == '\r')) {
-                pos++;
-            }
-            
-            // Check if we've reached the end of the array
-            if (pos >= jsonContent.length() || jsonContent[pos] == ']') {
-                break;
-            }
-            
-            // Find the start of the next block object
-            if (jsonContent[pos] == '{') {
-                // Find the end of this block object
-                size_t blockStart = pos;
-                int braceCount = 1;
-                pos++;
-                
-                while (pos < jsonContent.length() && braceCount > 0) {
-                    if (jsonContent[pos] == '{') braceCount++;
-                    else if (jsonContent[pos] == '}') braceCount--;
-                    pos++;
-                }
-                
-                // Extract the block JSON string
-                std::string blockJson = jsonContent.substr(blockStart, pos - blockStart);
-                
-                // Parse this block
-                BlockData block = ParseBlockFromJson(blockJson);
-                if (block.id >= 0) { // Valid block
-                    blockData[block.id] = block;
-                    blockCount++;
-                    std::cout << "Loaded block: " << block.name << " (ID: " << block.id << ")" << std::endl;
-                }
-            }
-            
-            // Skip comma and whitespace
-            while (pos < jsonContent.length() && (jsonContent[pos] == ',' || jsonContent[pos] == ' ' || jsonContent[pos] == '\n' || jsonContent[pos] == '\t' || jsonContent[pos] == '\r')) {
-                pos++;
-            }
-        }
-        
-        std::cout << "Successfully loaded " << blockCount << " blocks from JSON" << std::endl;
-        return blockCount > 0;
-        
-    } catch (const std::exception& e) {
-        std::cout << "JSON parsing error: " << e.what() << std::endl;
-        return false;
-    }
-}
-
-BlockData TextureManager::ParseBlockFromJson(const std::string& blockJson) {
-    BlockData block;
-    block.id = -1; // Invalid by default
-    
-    try {
-        // Helper function to extract string value
-        auto extractString = [&](const std::string& key) -> std::string {
-            std::string search = "\"" + key + "\":";
-            size_t keyPos = blockJson.find(search);
-            if (keyPos == std::string::npos) return "";
-            
-            size_t valueStart = blockJson.find("\"", keyPos + search.length());
-            if (valueStart == std::string::npos) return "";
-            valueStart++;
-            
-            size_t valueEnd = blockJson.find("\"", valueStart);
-            if (valueEnd == std::string::npos) return "";
-            
-            return blockJson.substr(valueStart, valueEnd - valueStart);
-        };
-        
-        // Helper function to extract integer value
-        auto extractInt = [&](const std::string& key) -> int {
-            std::string search = "\"" + key + "\":";
-            size_t keyPos = blockJson.find(search);
-            if (keyPos == std::string::npos) return 0;
-            
-            size_t valueStart = keyPos + search.length();
-            while (valueStart < blockJson.length() && (blockJson[valueStart] == ' ' || blockJson[valueStart] == '\t')) {
-                valueStart++;
-            }
-            
-            size_t valueEnd = valueStart;
-            while (valueEnd < blockJson.length() && (std::isdigit(blockJson[valueEnd]) || blockJson[valueEnd] == '-' || blockJson[valueEnd] == '.')) {
-                valueEnd++;
-            }
-            
-            if (valueEnd > valueStart) {
-                return std::stoi(blockJson.substr(valueStart, valueEnd - valueStart));
-            }
-            return 0;
-        };
-        
-        // Helper function to extract boolean value
-        auto extractBool = [&](const std::string& key) -> bool {
-            std::string search = "\"" + key + "\":";
-            size_t keyPos = blockJson.find(search);
-            if (keyPos == std::string::npos) return false;
-            
-            size_t valueStart = keyPos + search.length();
-            while (valueStart < blockJson.length() && (blockJson[valueStart] == ' ' || blockJson[valueStart] == '\t')) {
-                valueStart++;
-            }
-            
-            return blockJson.substr(valueStart, 4) == "true";
-        };
-        
-        // Helper function to extract float value
-        auto extractFloat = [&](const std::string& key) -> float {
-            std::string search = "\"" + key + "\":";
-            size_t keyPos = blockJson.find(search);
-            if (keyPos == std::string::npos) return 0.0f;
-            
-            size_t valueStart = keyPos + search.length();
-            while (valueStart < blockJson.length() && (blockJson[valueStart] == ' ' || blockJson[valueStart] == '\t')) {
-                valueStart++;
-            }
-            
-            size_t valueEnd = valueStart;
-            while (valueEnd < blockJson.length() && (std::isdigit(blockJson[valueEnd]) || blockJson[valueEnd] == '-' || blockJson[valueEnd] == '.')) {
-                valueEnd++;
-            }
-            
-            if (valueEnd > valueStart) {
-                return std::stof(blockJson.substr(valueStart, valueEnd - valueStart));
-            }
-            return 0.0f;
-        };
-        
-        // Parse basic properties
-        block.id = extractInt("id");
-        block.name = extractString("name");
-        block.displayName = extractString("displayName");
-        block.transparent = extractBool("transparent");
-        block.liquid = extractBool("liquid");
-        block.flammable = extractBool("flammable");
-        block.breakable = extractBool("breakable");
-        block.emitsLight = extractBool("emitsLight");
-        block.hardness = extractFloat("hardness");
-        block.lightLevel = extractInt("lightLevel");
-        block.soundGroup = extractString("soundGroup");
-        block.toolRequired = extractString("toolRequired");
-        
-        // Parse textures object
-        size_t texturesStart = blockJson.find("\"textures\":");
-        if (texturesStart != std::string::npos) {
-            size_t objStart = blockJson.find('{', texturesStart);
-            if (objStart != std::string::npos) {
-                size_t objEnd = blockJson.find('}', objStart);
-                if (objEnd != std::string::npos) {
-                    std::string texturesJson = blockJson.substr(objStart + 1, objEnd - objStart - 1);
-                    
-                    // Extract texture values
-                    auto extractTextureValue = [&](const std::string& texKey) -> std::string {
-                        std::string search = "\"" + texKey + "\":";
-                        size_t keyPos = texturesJson.find(search);
-                        if (keyPos == std::string::npos) return "";
-                        
-                        size_t valueStart = texturesJson.find("\"", keyPos + search.length());
-                        if (valueStart == std::string::npos) return "";
-                        valueStart++;
-                        
-                        size_t valueEnd = texturesJson.find("\"", valueStart);
-                        if (valueEnd == std::string::npos) return "";
-                        
-                        return texturesJson.substr(valueStart, valueEnd - valueStart);
-                    };
-                    
-                    block.allTexture = extractTextureValue("all");
-                    block.topTexture = extractTextureValue("top");
-                    block.bottomTexture = extractTextureValue("bottom");
-                    block.sideTexture = extractTextureValue("side");
-                }
-            }
-        }
-        
-        // Parse tint color (simple approach - just set to white for now)
-        block.tintColor = {255, 255, 255, 255};
-        
-    } catch (const std::exception& e) {
-        std::cout << "Error parsing block JSON: " << e.what() << std::endl;
-        block.id = -1; // Mark as invalid
-    }
-    
-    return block;
+    return BlockRegistry::Get().LoadFromJson(jsonFilePath);
 }
 
 bool TextureManager::LoadTexture(const std::string& name, const std::string& filename) {
@@ -254,13 +37,34 @@ bool TextureManager::LoadTexture(const std::string& name, const std::string& fil
         return true;
     }
     
-    Texture2D texture = ::LoadTexture(fullPath.c_str());
+    Image image = LoadImage(fullPath.c_str());
+    Texture2D texture = LoadTextureFromImage(image);
     if (texture.id == 0) {
         std::cout << "Failed to load texture: " << fullPath << std::endl;
+        UnloadImage(image);
         return false;
     }
     
+    // Average the opaque texels while the pixels are still on the CPU
+    Color* pixels = LoadImageColors(image);
+    if (pixels) {
+        unsigned long long r = 0, g = 0, b = 0, n = 0;
+        for (int i = 0; i < image.width * image.height; i++) {
+            if (pixels[i].a < 128) continue;
+            r += pixels[i].r;
+            g += pixels[i].g;
+            b += pixels[i].b;
+            n++;
+        }
+        if (n > 0) {
+            averageColors[name] = {(unsigned char)(r / n), (unsigned char)(g / n), (unsigned char)(b / n), 255};
+        }
+        UnloadImageColors(pixels);
+    }
+    UnloadImage(image);
+    
     textures[name] = texture;
+    texturePaths[name] = fullPath;
     std::cout << "Loaded texture: " << name << " from " << fullPath << std::endl;
     return true;
 }
@@ -281,6 +85,8 @@ void TextureManager::LoadCommonTextures() {
     LoadTexture("log_oak_top");
     LoadTexture("leaves_oak");
     LoadTexture("sand");
+    LoadTexture("water_still");
+    LoadTexture("fire_layer_0");
     LoadTexture("gravel");
     LoadTexture("bedrock");
     
@@ -306,8 +112,11 @@ void TextureManager::LoadTexturesFromBlockData() {
     // Load all unique textures referenced in block data
     std::set<std::string> uniqueTextures;
     
-    for (const auto& pair : blockData) {
-        const BlockData& block = pair.second;
+    const BlockRegistry& registry = BlockRegistry::Get();
+    for (int id = 0; id < registry.GetIdLimit(); id++) {
+        const BlockData* data = registry.GetBlockData(id);
+        if (!data) continue;
+        const BlockData& block = *data;
         
         if (!block.allTexture.empty()) {
             uniqueTextures.insert(block.allTexture);
@@ -365,19 +174,37 @@ bool TextureManager::HasTexture(const std::string& name) const {
     return textures.find(name) != textures.end();
 }
 
+Color TextureManager::GetAverageColor(const std::string& name) const {
+    auto it = averageColors.find(name);
+    if (it != averageColors.end()) {
+        return it->second;
+    }
+    return GRAY;
+}
+
+std::string TextureManager::GetTexturePath(const std::string& name) const {
+    auto it = texturePaths.find(name);
+    if (it != texturePaths.end()) {
+        return it->second;
+    }
+    return "";
+}
+
 void TextureManager::UnloadAll() {
     for (auto& pair : textures) {
         UnloadTexture(pair.second);
     }
     textures.clear();
+    averageColors.clear();
+    texturePaths.clear();
 }
 
 const BlockData* TextureManager::GetBlockData(int voxelType) const {
-    auto it = blockData.find(voxelType);
-    if (it != blockData.end()) {
-        return &it->second;
-    }
-    return nullptr;
+    return BlockRegistry::Get().GetBlockData(voxelType);
+}
+
+int TextureManager::FindBlockId(const std::string& name) const {
+    return BlockRegistry::Get().FindBlock(name);
 }
 
 std::string TextureManager::GetTextureNameForVoxel(int voxelType, int face) const {
@@ -386,20 +213,15 @@ std::string TextureManager::GetTextureNameForVoxel(int voxelType, int face) cons
         return "stone"; // Fallback texture
     }
     
-    // Use face-specific textures first, fall back to "all" texture if needed
+    // Face-specific textures are resolved once by the registry
     switch (face) {
         case FACE_TOP:
-            return !block->topTexture.empty() ? block->topTexture : 
-                   (!block->allTexture.empty() ? block->allTexture : "stone");
         case FACE_BOTTOM:
-            return !block->bottomTexture.empty() ? block->bottomTexture : 
-                   (!block->allTexture.empty() ? block->allTexture : "stone");
         case FACE_FRONT:
         case FACE_BACK:
         case FACE_LEFT:
         case FACE_RIGHT:
-            return !block->sideTexture.empty() ? block->sideTexture : 
-                   (!block->allTexture.empty() ? block->allTexture : "stone");
+            return BlockRegistry::Get().GetFaceTextureName(voxelType, face);
         default:
             // If no face specified or unknown face, prefer "all" texture, then "side", then fallback
             if (!block->allTexture.empty()) return block->allTexture;
@@ -1,222 +1,173 @@
 #include "../include/voxel.h"
-#include "../include/texture_manager.h"
-#include "rlgl.h"
+#include "../include/job_system.h"
+#include "../include/chunk_codec.h"
 #include <algorithm>
+#include <cmath>
 #include <map>
+#include <thread>
 
 // VoxelChunk Implementation
 VoxelChunk::VoxelChunk(Vector3 position) 
-    : chunkPosition(position), meshNeedsUpdate(true), meshGenerated(false) {
+    : voxelsCompressed(false), accessed(false), compressionCount(0), decompressionCount(0), meshNeedsUpdate(true), chunkPosition(position),
+      meshEvicted(false), meshBytes(0), lastMeshBytes(0), lastVisibleFrame(0),
+      state(CHUNK_UNLOADED), references(0) {
     
-    // Initialize all voxels as air
-    for (int x = 0; x < CHUNK_SIZE; x++) {
-        for (int y = 0; y < CHUNK_HEIGHT; y++) {
-            for (int z = 0; z < CHUNK_SIZE; z++) {
-                voxels[x][y][z] = Voxel(VOXEL_AIR);
-            }
+    // All air; voxel storage is only allocated by the first SetVoxel
+    for (int y = 0; y < CHUNK_HEIGHT; y++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            solidMask[y][z] = 0;
         }
     }
-}
-
-VoxelChunk::~VoxelChunk() {
-    // Clean up all material meshes
-    for (auto& pair : materialMeshes) {
-        if (pair.second.isGenerated) {
-            UnloadMesh(pair.second.mesh);
-        }
-        UnloadMaterial(pair.second.material);
+    
+    for (int i = 0; i < VOXEL_TYPE_LIMIT; i++) {
+        blockCounts[i] = 0;
     }
-    materialMeshes.clear();
+    blockCounts[VOXEL_AIR] = CHUNK_VOLUME;
 }
 
-void VoxelChunk::SetVoxel(int x, int y, int z, VoxelType type) {
-    if (IsValidPosition(x, y, z)) {
-        voxels[x][y][z] = Voxel(type);
-        meshNeedsUpdate = true;
-    }
+VoxelChunk::~VoxelChunk() {
+    FreeMeshes();
 }
 
-Voxel VoxelChunk::GetVoxel(int x, int y, int z) const {
-    if (IsValidPosition(x, y, z)) {
-        return voxels[x][y][z];
-    }
-    return Voxel(VOXEL_AIR);
+void VoxelChunk::FreeMeshes() {
+    // The deleters come from chunk_mesh.cpp, which made the meshes
+    meshes.reset();
+    pendingMeshes.reset();
+    meshBytes = 0;
 }
 
-bool VoxelChunk::IsValidPosition(int x, int y, int z) const {
-    return x >= 0 && x < CHUNK_SIZE && 
-           y >= 0 && y < CHUNK_HEIGHT && 
-           z >= 0 && z < CHUNK_SIZE;
+bool VoxelChunk::TransitionState(ChunkState from, ChunkState to) {
+    int expected = from;
+    return state.compare_exchange_strong(expected, to);
 }
 
-Vector3 VoxelChunk::GetWorldPosition(int x, int y, int z) const {
-    return Vector3Add(chunkPosition, (Vector3){(float)x, (float)y, (float)z});
+void VoxelChunk::Clear() {
+    FreeMeshes();
+    voxels.reset();
+    std::vector<uint8_t>().swap(compressedVoxels);
+    voxelsCompressed.store(false);
+    meshEvicted = false;
+    for (int y = 0; y < CHUNK_HEIGHT; y++) {
+        for (int z = 0; z < CHUNK_SIZE; z++) {
+            solidMask[y][z] = 0;
+        }
+    }
+    for (int i = 0; i < VOXEL_TYPE_LIMIT; i++) {
+        blockCounts[i] = 0;
+    }
+    blockCounts[VOXEL_AIR] = CHUNK_VOLUME;
+    meshNeedsUpdate = true;
 }
 
-void VoxelChunk::AddFaceToMesh(std::vector<Vector3>& vertices, std::vector<Vector3>& normals, 
-                               std::vector<Vector2>& texcoords, std::vector<Color>& colors,
-                               Vector3 position, FaceDirection face) const {
-    
-    Vector3 v1, v2, v3, v4;
-    Vector3 normal;
-    
-    // Define vertices and normal for each face (counter-clockwise winding)
-    switch (face) {
-        case FACE_TOP:
-            v1 = Vector3Add(position, (Vector3){-0.5f, 0.5f, -0.5f});
-            v2 = Vector3Add(position, (Vector3){-0.5f, 0.5f, 0.5f});
-            v3 = Vector3Add(position, (Vector3){0.5f, 0.5f, 0.5f});
-            v4 = Vector3Add(position, (Vector3){0.5f, 0.5f, -0.5f});
-            normal = (Vector3){0.0f, 1.0f, 0.0f};
-            break;
-        case FACE_BOTTOM:
-            v1 = Vector3Add(position, (Vector3){-0.5f, -0.5f, -0.5f});
-            v2 = Vector3Add(position, (Vector3){0.5f, -0.5f, -0.5f});
-            v3 = Vector3Add(position, (Vector3){0.5f, -0.5f, 0.5f});
-            v4 = Vector3Add(position, (Vector3){-0.5f, -0.5f, 0.5f});
-            normal = (Vector3){0.0f, -1.0f, 0.0f};
-            break;
-        case FACE_FRONT:
-            v1 = Vector3Add(position, (Vector3){-0.5f, -0.5f, 0.5f});
-            v2 = Vector3Add(position, (Vector3){0.5f, -0.5f, 0.5f});
-            v3 = Vector3Add(position, (Vector3){0.5f, 0.5f, 0.5f});
-            v4 = Vector3Add(position, (Vector3){-0.5f, 0.5f, 0.5f});
-            normal = (Vector3){0.0f, 0.0f, 1.0f};
-            break;
-        case FACE_BACK:
-            v1 = Vector3Add(position, (Vector3){0.5f, -0.5f, -0.5f});
-            v2 = Vector3Add(position, (Vector3){-0.5f, -0.5f, -0.5f});
-            v3 = Vector3Add(position, (Vector3){-0.5f, 0.5f, -0.5f});
-            v4 = Vector3Add(position, (Vector3){0.5f, 0.5f, -0.5f});
-            normal = (Vector3){0.0f, 0.0f, -1.0f};
-            break;
-        case FACE_RIGHT:
-            v1 = Vector3Add(position, (Vector3){0.5f, -0.5f, 0.5f});
-            v2 = Vector3Add(position, (Vector3){0.5f, -0.5f, -0.5f});
-            v3 = Vector3Add(position, (Vector3){0.5f, 0.5f, -0.5f});
-            v4 = Vector3Add(position, (Vector3){0.5f, 0.5f, 0.5f});
-            normal = (Vector3){1.0f, 0.0f, 0.0f};
-            break;
-        case FACE_LEFT:
-            v1 = Vector3Add(position, (Vector3){-0.5f, -0.5f, -0.5f});
-            v2 = Vector3Add(position, (Vector3){-0.5f, -0.5f, 0.5f});
-            v3 = Vector3Add(position, (Vector3){-0.5f, 0.5f, 0.5f});
-            v4 = Vector3Add(position, (Vector3){-0.5f, 0.5f, -0.5f});
-            normal = (Vector3){-1.0f, 0.0f, 0.0f};
-            break;
+bool VoxelChunk::LoadVoxels() const {
+    // Checked first so the hot path stays a read of an already-set flag
+    if (!accessed.load(std::memory_order_relaxed)) {
+        accessed.store(true, std::memory_order_relaxed);
     }
-    
-    // Get appropriate texture coordinates based on voxel type and face
-    Vector2 uv1 = {0.0f, 1.0f};
-    Vector2 uv2 = {1.0f, 1.0f};
-    Vector2 uv3 = {1.0f, 0.0f};
-    Vector2 uv4 = {0.0f, 0.0f};
-    
-    // Use white color for all vertices (texture will provide the color)
-    Color vertexColor = WHITE;
-    
-    // Add two triangles to form a quad
-    // Triangle 1: v1, v2, v3
-    vertices.push_back(v1);
-    vertices.push_back(v2);
-    vertices.push_back(v3);
-    normals.push_back(normal);
-    normals.push_back(normal);
-    normals.push_back(normal);
-    texcoords.push_back(uv1);
-    texcoords.push_back(uv2);
-    texcoords.push_back(uv3);
-    colors.push_back(vertexColor);
-    colors.push_back(vertexColor);
-    colors.push_back(vertexColor);
-    
-    // Triangle 2: v1, v3, v4
-    vertices.push_back(v1);
-    vertices.push_back(v3);
-    vertices.push_back(v4);
-    normals.push_back(normal);
-    normals.push_back(normal);
-    normals.push_back(normal);
-    texcoords.push_back(uv1);
-    texcoords.push_back(uv3);
-    texcoords.push_back(uv4);
-    colors.push_back(vertexColor);
-    colors.push_back(vertexColor);
-    colors.push_back(vertexColor);
-}
-
-bool VoxelChunk::IsFaceVisible(int x, int y, int z, FaceDirection face, VoxelWorld* world) const {
-    if (!voxels[x][y][z].isActive) return false;
-    
-    int nx = x, ny = y, nz = z;
-    
-    // Get neighbor coordinates based on face direction
-    switch (face) {
-        case FACE_TOP: ny++; break;
-        case FACE_BOTTOM: ny--; break;
-        case FACE_FRONT: nz++; break;
-        case FACE_BACK: nz--; break;
-        case FACE_RIGHT: nx++; break;
-        case FACE_LEFT: nx--; break;
+    if (voxelsCompressed.load(std::memory_order_acquire)) {
+        DecompressVoxels();
     }
+    return voxels != nullptr;
+}
+
+void VoxelChunk::DecompressVoxels() const {
+    std::lock_guard<std::mutex> lock(storageMutex);
+    if (!voxelsCompressed.load(std::memory_order_relaxed)) return;  // Another reader got here first
     
-    // Check if neighbor is within this chunk
-    if (IsValidPosition(nx, ny, nz)) {
-        // Neighbor is in same chunk - check directly
-        return !voxels[nx][ny][nz].isActive;
+    std::vector<Voxel> cells(CHUNK_VOLUME);
+    ChunkCodec::Decode(compressedVoxels.data(), compressedVoxels.size(), cells.data());
+    voxels.reset(new Voxel[CHUNK_SIZE][CHUNK_HEIGHT][CHUNK_SIZE]);
+    for (int cell = 0; cell < CHUNK_VOLUME; cell++) {
+        int x, y, z;
+        CellCoords(cell, x, y, z);
+        voxels[x][y][z] = cells[cell];
     }
+    std::vector<uint8_t>().swap(compressedVoxels);
+    decompressionCount.fetch_add(1, std::memory_order_relaxed);
+    voxelsCompressed.store(false, std::memory_order_release);
+}
+
+bool VoxelChunk::CompressVoxels() {
+    if (voxelsCompressed.load() || !voxels) return false;
     
-    // Neighbor is outside chunk bounds - check neighboring chunk if world is provided
-    if (world != nullptr) {
-        // Convert local coordinates to world coordinates
-        Vector3 worldPos = GetWorldPosition(x, y, z);
-        int worldX = (int)worldPos.x;
-        int worldY = (int)worldPos.y;
-        int worldZ = (int)worldPos.z;
-        
-        // Calculate neighbor world coordinates
-        int neighborWorldX = worldX, neighborWorldY = worldY, neighborWorldZ = worldZ;
-        switch (face) {
-            case FACE_TOP: neighborWorldY++; break;
-            case FACE_BOTTOM: neighborWorldY--; break;
-            case FACE_FRONT: neighborWorldZ++; break;
-            case FACE_BACK: neighborWorldZ--; break;
-            case FACE_RIGHT: neighborWorldX++; break;
-            case FACE_LEFT: neighborWorldX--; break;
-        }
-        
-        // Check if neighbor voxel exists in world
-        Voxel neighborVoxel = world->GetVoxel(neighborWorldX, neighborWorldY, neighborWorldZ);
-        return !neighborVoxel.isActive;
+    // Pure air needs no storage at all
+    if (blockCounts[VOXEL_AIR] == CHUNK_VOLUME) {
+        voxels.reset();
+        return true;
     }
     
-    // If no world provided and neighbor is outside chunk, render the face
+    std::vector<uint8_t> encoded;
+    ChunkCodec::Encode(*this, encoded);
+    if (encoded.size() >= sizeof(Voxel) * CHUNK_VOLUME) return false;
+    encoded.shrink_to_fit();
+    compressedVoxels.swap(encoded);
+    voxels.reset();
+    voxelsCompressed.store(true, std::memory_order_release);
+    compressionCount.fetch_add(1, std::memory_order_relaxed);
+    accessed.store(false, std::memory_order_relaxed);  // Encoding read every cell
     return true;
 }
 
-void VoxelChunk::GenerateMesh(VoxelWorld* world, TextureManager* textureManager) {
-    if (!meshNeedsUpdate) return;
-    
-    // Use greedy meshing for optimization
-    GenerateGreedyMesh(world, textureManager);
-    
+size_t VoxelChunk::GetVoxelMemory() const {
+    if (voxelsCompressed.load()) return compressedVoxels.capacity();
+    return voxels ? sizeof(Voxel) * CHUNK_VOLUME : 0;
+}
+
+void VoxelChunk::EvictMesh() {
+    FreeMeshes();
     meshNeedsUpdate = false;
-    meshGenerated = true;
+    meshEvicted = true;
+    if (!TransitionState(CHUNK_VISIBLE, CHUNK_LIT)) {
+        TransitionState(CHUNK_MESHED, CHUNK_LIT);
+    }
 }
 
-void VoxelChunk::Draw() {
-    if (meshGenerated) {
-        for (const auto& pair : materialMeshes) {
-            const MaterialMesh& matMesh = pair.second;
-            if (matMesh.isGenerated && matMesh.mesh.vertexCount > 0) {
-                DrawMesh(matMesh.mesh, matMesh.material, MatrixIdentity());
-            }
+void VoxelChunk::SetVoxel(int x, int y, int z, VoxelType type, uint8_t metadata) {
+    if (IsValidPosition(x, y, z)) {
+        if (!LoadVoxels()) {
+            if (type == VOXEL_AIR) return;  // Already air
+            voxels.reset(new Voxel[CHUNK_SIZE][CHUNK_HEIGHT][CHUNK_SIZE]);
         }
+        blockCounts[voxels[x][y][z].type]--;
+        blockCounts[type]++;
+        voxels[x][y][z] = Voxel(type, metadata);
+        if (IsSolidType(type)) {
+            solidMask[y][z] |= (uint16_t)(1u << x);
+        } else {
+            solidMask[y][z] &= (uint16_t)~(1u << x);
+        }
+        meshNeedsUpdate = true;
+    }
+}
+
+Voxel VoxelChunk::GetVoxel(int x, int y, int z) const {
+    if (IsValidPosition(x, y, z) && LoadVoxels()) {
+        return voxels[x][y][z];
     }
+    return Voxel(VOXEL_AIR);
+}
+
+bool VoxelChunk::IsSolid(int x, int y, int z) const {
+    if (!IsValidPosition(x, y, z)) return false;
+    return (solidMask[y][z] >> x) & 1u;
+}
+
+bool VoxelChunk::IsValidPosition(int x, int y, int z) const {
+    return x >= 0 && x < CHUNK_SIZE && 
+           y >= 0 && y < CHUNK_HEIGHT && 
+           z >= 0 && z < CHUNK_SIZE;
+}
+
+Vector3 VoxelChunk::GetWorldPosition(int x, int y, int z) const {
+    return Vector3Add(chunkPosition, (Vector3){(float)x, (float)y, (float)z});
 }
 
 // VoxelWorld Implementation
-VoxelWorld::VoxelWorld(int width, int depth) : worldWidth(width), worldDepth(depth), textureManager(nullptr) {
+VoxelWorld::VoxelWorld(int width, int depth)
+    : worldWidth(width), worldDepth(depth), textureManager(nullptr), nextListenerId(0),
+      meshUploadBudget(DEFAULT_MESH_UPLOAD_BUDGET), uploadCursor(0), drawFrame(0),
+      foliageDistance(DEFAULT_FOLIAGE_DISTANCE), coldChunkSeconds(DEFAULT_COLD_CHUNK_SECONDS),
+      idleSeconds(width * depth, 0.0f) {
     chunks.resize(worldWidth);
     for (int x = 0; x < worldWidth; x++) {
         chunks[x].resize(worldDepth);
@@ -234,6 +185,10 @@ VoxelWorld::VoxelWorld(int width, int depth) : worldWidth(width), worldDepth(dep
 VoxelWorld::~VoxelWorld() {
     for (int x = 0; x < worldWidth; x++) {
         for (int z = 0; z < worldDepth; z++) {
+            // Jobs still holding the chunk finish with it first
+            while (chunks[x][z]->GetReferenceCount() > 0) {
+                std::this_thread::yield();
+            }
             delete chunks[x][z];
         }
     }
@@ -245,12 +200,13 @@ void VoxelWorld::WorldToChunkCoords(int worldX, int worldZ, int& chunkX, int& ch
     localX = worldX % VoxelChunk::CHUNK_SIZE;
     localZ = worldZ % VoxelChunk::CHUNK_SIZE;
     
-    // Handle negative coordinates
-    if (worldX < 0) {
+    // Division truncates towards zero; round negative coordinates down instead, so
+    // local coordinates always stay in [0, CHUNK_SIZE) (-16 is chunk -1, local 0)
+    if (localX < 0) {
         chunkX--;
         localX += VoxelChunk::CHUNK_SIZE;
     }
-    if (worldZ < 0) {
+    if (localZ < 0) {
         chunkZ--;
         localZ += VoxelChunk::CHUNK_SIZE;
     }
@@ -263,332 +219,352 @@ VoxelChunk* VoxelWorld::GetChunk(int chunkX, int chunkZ) {
     return nullptr;
 }
 
-void VoxelWorld::SetVoxel(int worldX, int worldY, int worldZ, VoxelType type) {
-    int chunkX, chunkZ, localX, localZ;
-    WorldToChunkCoords(worldX, worldZ, chunkX, chunkZ, localX, localZ);
+const VoxelChunk* VoxelWorld::GetChunk(int chunkX, int chunkZ) const {
+    if (chunkX >= 0 && chunkX < worldWidth && chunkZ >= 0 && chunkZ < worldDepth) {
+        return chunks[chunkX][chunkZ];
+    }
+    return nullptr;
+}
+
+bool VoxelWorld::BeginChunkLoad(int chunkX, int chunkZ) {
+    VoxelChunk* chunk = GetChunk(chunkX, chunkZ);
+    if (!chunk) return false;
+    
+    // Reloading before the unload was collected just cancels it; the chunk was never cleared
+    return chunk->TransitionState(CHUNK_UNLOADED, CHUNK_GENERATING) ||
+           chunk->TransitionState(CHUNK_UNLOADING, CHUNK_GENERATING);
+}
+
+void VoxelWorld::FinishChunkLoad(int chunkX, int chunkZ) {
+    VoxelChunk* chunk = GetChunk(chunkX, chunkZ);
+    if (!chunk || !chunk->TransitionState(CHUNK_GENERATING, CHUNK_GENERATED)) return;
     
+    chunk->MarkForUpdate();
+    MarkNeighborsForUpdate(chunkX, chunkZ);
+}
+
+bool VoxelWorld::UnloadChunk(int chunkX, int chunkZ) {
     VoxelChunk* chunk = GetChunk(chunkX, chunkZ);
-    if (chunk) {
-        chunk->SetVoxel(localX, worldY, localZ, type);
+    if (!chunk) return false;
+    
+    while (true) {
+        ChunkState current = chunk->GetState();
+        if (current == CHUNK_UNLOADED || current == CHUNK_UNLOADING) return false;
+        if (chunk->TransitionState(current, CHUNK_UNLOADING)) return true;
     }
 }
 
-Voxel VoxelWorld::GetVoxel(int worldX, int worldY, int worldZ) const {
-    int chunkX, chunkZ, localX, localZ;
-    WorldToChunkCoords(worldX, worldZ, chunkX, chunkZ, localX, localZ);
+ChunkHandle VoxelWorld::AcquireChunk(int chunkX, int chunkZ) {
+    VoxelChunk* chunk = GetChunk(chunkX, chunkZ);
+    if (!chunk) return ChunkHandle();
     
-    if (chunkX >= 0 && chunkX < worldWidth && chunkZ >= 0 && chunkZ < worldDepth) {
-        return chunks[chunkX][chunkZ]->GetVoxel(localX, worldY, localZ);
+    // Reference first, then check: an unload either sees our reference and waits,
+    // or we see it unloading and back off
+    chunk->AddReference();
+    ChunkState current = chunk->GetState();
+    if (current < CHUNK_GENERATED || current == CHUNK_UNLOADING) {
+        chunk->ReleaseReference();
+        return ChunkHandle();
     }
-    return Voxel(VOXEL_AIR);
+    return ChunkHandle(chunk);
 }
 
-void VoxelWorld::Update() {
-    // Generate meshes for chunks that need updates
-    for (int x = 0; x < worldWidth; x++) {
-        for (int z = 0; z < worldDepth; z++) {
-            chunks[x][z]->GenerateMesh(this, textureManager);
+bool VoxelWorld::AcquireChunkArea(int chunkX, int chunkZ, std::vector<ChunkHandle>& handles) {
+    ChunkHandle center = AcquireChunk(chunkX, chunkZ);
+    if (!center) return false;
+    handles.push_back(std::move(center));
+    
+    // Neighbors still loading or already gone read as air, as at the world's edge
+    const int NEIGHBORS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (const auto& offset : NEIGHBORS) {
+        ChunkHandle neighbor = AcquireChunk(chunkX + offset[0], chunkZ + offset[1]);
+        if (neighbor) handles.push_back(std::move(neighbor));
+    }
+    return true;
+}
+
+ChunkState VoxelWorld::GetChunkState(int chunkX, int chunkZ) const {
+    const VoxelChunk* chunk = GetChunk(chunkX, chunkZ);
+    return chunk ? chunk->GetState() : CHUNK_UNLOADED;
+}
+
+void VoxelWorld::MarkNeighborsForUpdate(int chunkX, int chunkZ) {
+    // Border faces of the neighbors depend on this chunk too
+    const int NEIGHBORS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (const auto& offset : NEIGHBORS) {
+        if (VoxelChunk* neighbor = GetChunk(chunkX + offset[0], chunkZ + offset[1])) {
+            neighbor->MarkForUpdate();
         }
     }
 }
 
-void VoxelWorld::Draw() {
+void VoxelWorld::CollectUnloadedChunks() {
     for (int x = 0; x < worldWidth; x++) {
         for (int z = 0; z < worldDepth; z++) {
-            chunks[x][z]->Draw();
+            VoxelChunk* chunk = chunks[x][z];
+            if (chunk->GetState() != CHUNK_UNLOADING || chunk->GetReferenceCount() > 0) continue;
+            
+            // Held as GENERATING while clearing, so neither a load nor AcquireChunk
+            // can get at it halfway
+            if (!chunk->TransitionState(CHUNK_UNLOADING, CHUNK_GENERATING)) continue;
+            chunk->Clear();
+            chunk->TransitionState(CHUNK_GENERATING, CHUNK_UNLOADED);
+            MarkNeighborsForUpdate(x, z);
         }
     }
 }
 
-void VoxelWorld::GenerateTestTerrain() {
-    // Generate a simple test terrain
-    for (int x = 0; x < worldWidth * VoxelChunk::CHUNK_SIZE; x++) {
-        for (int z = 0; z < worldDepth * VoxelChunk::CHUNK_SIZE; z++) {
-            // Simple height map
-            int height = 4 + (int)(sin(x * 0.1f) * cos(z * 0.1f) * 3.0f);
+void VoxelWorld::CompressColdChunks(float deltaSeconds) {
+    CompressionStats stats;
+    stats.accesses = compressionStats.accesses;
+    for (int x = 0; x < worldWidth; x++) {
+        for (int z = 0; z < worldDepth; z++) {
+            VoxelChunk* chunk = chunks[x][z];
+            float& idle = idleSeconds[x * worldDepth + z];
+            if (chunk->TakeAccessed()) {
+                stats.accesses++;
+                idle = 0.0f;
+            } else {
+                idle += deltaSeconds;
+            }
             
-            for (int y = 0; y < height && y < VoxelChunk::CHUNK_HEIGHT; y++) {
-                VoxelType type = VOXEL_STONE;
-                if (y == height - 1) type = VOXEL_GRASS;
-                else if (y >= height - 3) type = VOXEL_DIRT;
-                
-                SetVoxel(x, y, z, type);
+            ChunkState current = chunk->GetState();
+            if (coldChunkSeconds > 0.0f && idle >= coldChunkSeconds && current >= CHUNK_GENERATED &&
+                current != CHUNK_UNLOADING && chunk->GetReferenceCount() == 0 && !chunk->IsCompressed()) {
+                chunk->CompressVoxels();
+                idle = 0.0f;  // One that didn't shrink isn't retried on every call
+            }
+            
+            if (chunk->IsCompressed()) {
+                stats.compressedChunks++;
+                stats.bytesSaved += sizeof(Voxel) * VoxelChunk::CHUNK_VOLUME - chunk->GetVoxelMemory();
             }
+            stats.compressions += chunk->GetCompressionCount();
+            stats.decompressions += chunk->GetDecompressionCount();
         }
     }
+    compressionStats = stats;
 }
 
-// Greedy Meshing Implementation
-void VoxelChunk::GenerateGreedyMesh(VoxelWorld* world, TextureManager* textureManager) {
-    // Clean up existing meshes
-    for (auto& pair : materialMeshes) {
-        if (pair.second.isGenerated) {
-            UnloadMesh(pair.second.mesh);
-        }
-        UnloadMaterial(pair.second.material);
+void VoxelWorld::SetVoxel(int worldX, int worldY, int worldZ, VoxelType type, uint8_t metadata) {
+    int chunkX, chunkZ, localX, localZ;
+    WorldToChunkCoords(worldX, worldZ, chunkX, chunkZ, localX, localZ);
+    
+    VoxelChunk* chunk = GetChunk(chunkX, chunkZ);
+    if (chunk) {
+        chunk->SetVoxel(localX, worldY, localZ, type, metadata);
+    }
+}
+
+Voxel VoxelWorld::GetVoxel(int worldX, int worldY, int worldZ) const {
+    int chunkX, chunkZ, localX, localZ;
+    WorldToChunkCoords(worldX, worldZ, chunkX, chunkZ, localX, localZ);
+    
+    if (chunkX >= 0 && chunkX < worldWidth && chunkZ >= 0 && chunkZ < worldDepth) {
+        return chunks[chunkX][chunkZ]->GetVoxel(localX, worldY, localZ);
     }
-    materialMeshes.clear();
+    return Voxel(VOXEL_AIR);
+}
+
+bool VoxelWorld::IsSolid(int worldX, int worldY, int worldZ) const {
+    int chunkX, chunkZ, localX, localZ;
+    WorldToChunkCoords(worldX, worldZ, chunkX, chunkZ, localX, localZ);
     
-    // Map to collect quads for each material
-    std::unordered_map<std::string, std::vector<QuadMesh>> materialQuads;
+    if (chunkX >= 0 && chunkX < worldWidth && chunkZ >= 0 && chunkZ < worldDepth) {
+        return chunks[chunkX][chunkZ]->IsSolid(localX, worldY, localZ);
+    }
+    return false;
+}
+
+void VoxelWorld::ApplyEdits(const std::vector<BlockEdit>& edits) {
+    if (edits.empty()) return;
     
-    // Process each face direction and each layer
-    for (int face = 0; face < FACE_COUNT; face++) {
-        FaceDirection faceDir = (FaceDirection)face;
-        
-        // For each face direction, process all layers
-        int maxLayer = GetMaxLayerForFace(faceDir);
-        for (int layer = 0; layer < maxLayer; layer++) {
-            FaceMask mask[CHUNK_SIZE][CHUNK_SIZE];
-            
-            // Extract face mask for this direction and layer
-            ExtractFaceMask(faceDir, layer, world, textureManager, mask);
-            
-            // Generate quads using greedy meshing
-            std::vector<QuadMesh> quads;
-            GreedyMeshFace(faceDir, layer, mask, quads);
-            
-            // Group quads by texture
-            for (const auto& quad : quads) {
-                materialQuads[quad.textureName].push_back(quad);
-            }
+    // Group edits by chunk so each chunk is touched once
+    std::map<std::pair<int, int>, std::vector<BlockEdit>> editsByChunk;
+    for (const BlockEdit& edit : edits) {
+        int chunkX, chunkZ, localX, localZ;
+        WorldToChunkCoords(edit.x, edit.z, chunkX, chunkZ, localX, localZ);
+        if (GetChunk(chunkX, chunkZ) && edit.y >= 0 && edit.y < VoxelChunk::CHUNK_HEIGHT) {
+            editsByChunk[std::make_pair(chunkX, chunkZ)].push_back(edit);
         }
     }
     
-    // Convert quads to meshes for each material
-    for (const auto& pair : materialQuads) {
-        const std::string& textureName = pair.first;
-        const std::vector<QuadMesh>& quads = pair.second;
+    for (auto& pair : editsByChunk) {
+        int chunkX = pair.first.first;
+        int chunkZ = pair.first.second;
+        VoxelChunk* chunk = chunks[chunkX][chunkZ];
         
-        if (quads.empty()) continue;
-        
-        std::vector<Vector3> vertices;
-        std::vector<Vector3> normals;
-        std::vector<Vector2> texcoords;
-        std::vector<Color> colors;
-        
-        // Convert each quad to mesh data using original face logic
-        for (const auto& quad : quads) {
-            AddQuadToMesh(vertices, normals, texcoords, colors, quad);
-        }
-        
-        // Create material mesh
-        MaterialMesh& matMesh = materialMeshes[textureName];
-        matMesh.textureName = textureName;
-        
-        // Initialize mesh
-        matMesh.mesh.vertexCount = vertices.size();
-        matMesh.mesh.triangleCount = vertices.size() / 3;
-        
-        // Allocate mesh data
-        matMesh.mesh.vertices = (float*)RL_MALLOC(vertices.size() * 3 * sizeof(float));
-        matMesh.mesh.normals = (float*)RL_MALLOC(vertices.size() * 3 * sizeof(float));
-        matMesh.mesh.texcoords = (float*)RL_MALLOC(vertices.size() * 2 * sizeof(float));
-        matMesh.mesh.colors = (unsigned char*)RL_MALLOC(vertices.size() * 4 * sizeof(unsigned char));
-        
-        // Copy data to mesh
-        for (size_t i = 0; i < vertices.size(); i++) {
-            matMesh.mesh.vertices[i * 3] = vertices[i].x;
-            matMesh.mesh.vertices[i * 3 + 1] = vertices[i].y;
-            matMesh.mesh.vertices[i * 3 + 2] = vertices[i].z;
-            
-            matMesh.mesh.normals[i * 3] = normals[i].x;
-            matMesh.mesh.normals[i * 3 + 1] = normals[i].y;
-            matMesh.mesh.normals[i * 3 + 2] = normals[i].z;
-            
-            matMesh.mesh.texcoords[i * 2] = texcoords[i].x;
-            matMesh.mesh.texcoords[i * 2 + 1] = texcoords[i].y;
+        for (const BlockEdit& edit : pair.second) {
+            int localX = edit.x - chunkX * VoxelChunk::CHUNK_SIZE;
+            int localZ = edit.z - chunkZ * VoxelChunk::CHUNK_SIZE;
+            chunk->SetVoxel(localX, edit.y, localZ, edit.type, edit.metadata);
             
-            matMesh.mesh.colors[i * 4] = colors[i].r;
-            matMesh.mesh.colors[i * 4 + 1] = colors[i].g;
-            matMesh.mesh.colors[i * 4 + 2] = colors[i].b;
-            matMesh.mesh.colors[i * 4 + 3] = colors[i].a;
+            // Faces on the shared border belong to the neighbor's mesh too
+            if (localX == 0 && GetChunk(chunkX - 1, chunkZ)) chunks[chunkX - 1][chunkZ]->MarkForUpdate();
+            if (localX == VoxelChunk::CHUNK_SIZE - 1 && GetChunk(chunkX + 1, chunkZ)) chunks[chunkX + 1][chunkZ]->MarkForUpdate();
+            if (localZ == 0 && GetChunk(chunkX, chunkZ - 1)) chunks[chunkX][chunkZ - 1]->MarkForUpdate();
+            if (localZ == VoxelChunk::CHUNK_SIZE - 1 && GetChunk(chunkX, chunkZ + 1)) chunks[chunkX][chunkZ + 1]->MarkForUpdate();
         }
-        
-        // Upload mesh to GPU
-        UploadMesh(&matMesh.mesh, false);
-        matMesh.isGenerated = true;
-        
-        // Set up material with appropriate texture
-        matMesh.material = LoadMaterialDefault();
-        if (textureManager && textureManager->HasTexture(textureName)) {
-            matMesh.material.maps[MATERIAL_MAP_DIFFUSE].texture = textureManager->GetTexture(textureName);
+    }
+    
+    for (auto& pair : editsByChunk) {
+        for (auto& listener : editListeners) {
+            listener.second(pair.first.first, pair.first.second, pair.second);
         }
     }
 }
 
-int VoxelChunk::GetMaxLayerForFace(FaceDirection face) const {
-    switch (face) {
-        case FACE_TOP:
-        case FACE_BOTTOM:
-            return CHUNK_HEIGHT;  // Y layers
-        case FACE_FRONT:
-        case FACE_BACK:
-            return CHUNK_SIZE;    // Z layers
-        case FACE_RIGHT:
-        case FACE_LEFT:
-            return CHUNK_SIZE;    // X layers
-        default:
-            return 1;
-    }
+int VoxelWorld::AddEditListener(EditListener listener) {
+    int id = nextListenerId++;
+    editListeners.emplace_back(id, std::move(listener));
+    return id;
 }
 
-void VoxelChunk::ExtractFaceMask(FaceDirection face, int layer, VoxelWorld* world, TextureManager* textureManager, 
-                                 FaceMask mask[CHUNK_SIZE][CHUNK_SIZE]) {
-    // Initialize mask
-    for (int i = 0; i < CHUNK_SIZE; i++) {
-        for (int j = 0; j < CHUNK_SIZE; j++) {
-            mask[i][j] = FaceMask();
-        }
+void VoxelWorld::RemoveEditListener(int listenerId) {
+    editListeners.erase(std::remove_if(editListeners.begin(), editListeners.end(),
+                                       [listenerId](const std::pair<int, EditListener>& entry) {
+                                           return entry.first == listenerId;
+                                       }),
+                        editListeners.end());
+}
+
+float VoxelWorld::GetBlastResistance(VoxelType type, bool& breakable) const {
+    const BlockRegistry& registry = BlockRegistry::Get();
+    breakable = registry.HasFlag(type, BLOCK_BREAKABLE);
+    return registry.hardness[type];
+}
+
+int VoxelWorld::Explode(Vector3 center, float power, std::vector<BlockEdit>* destroyed) {
+    const int RAYS_PER_EDGE = 16;
+    const float STEP = 0.3f;
+    const float AIR_FALLOFF = 0.225f;
+    
+    // Resolve block properties once instead of per ray step
+    float resistance[VOXEL_TYPE_LIMIT];
+    bool breakable[VOXEL_TYPE_LIMIT];
+    for (int type = 0; type < VOXEL_TYPE_LIMIT; type++) {
+        resistance[type] = GetBlastResistance((VoxelType)type, breakable[type]);
     }
     
-    // Extract face information for the specific layer
-    for (int u = 0; u < CHUNK_SIZE; u++) {
-        for (int v = 0; v < CHUNK_SIZE; v++) {
-            // Convert u,v coordinates to x,y,z based on face direction and layer
-            int x, y, z;
-            
-            switch (face) {
-                case FACE_TOP:
-                    x = u; y = layer; z = v;
-                    break;
-                case FACE_BOTTOM:
-                    x = u; y = layer; z = v;
-                    break;
-                case FACE_FRONT:
-                    x = u; y = v; z = layer;
-                    break;
-                case FACE_BACK:
-                    x = u; y = v; z = layer;
-                    break;
-                case FACE_RIGHT:
-                    x = layer; y = v; z = u;
-                    break;
-                case FACE_LEFT:
-                    x = layer; y = v; z = u;
-                    break;
-                default:
-                    continue;
+    // One ray through every cell on the surface of a 16x16x16 cube
+    std::vector<Vector3> directions;
+    for (int i = 0; i < RAYS_PER_EDGE; i++) {
+        for (int j = 0; j < RAYS_PER_EDGE; j++) {
+            for (int k = 0; k < RAYS_PER_EDGE; k++) {
+                bool onSurface = i == 0 || i == RAYS_PER_EDGE - 1 || j == 0 || j == RAYS_PER_EDGE - 1 ||
+                                 k == 0 || k == RAYS_PER_EDGE - 1;
+                if (!onSurface) continue;
+                Vector3 dir = {i / (RAYS_PER_EDGE - 1.0f) * 2.0f - 1.0f,
+                               j / (RAYS_PER_EDGE - 1.0f) * 2.0f - 1.0f,
+                               k / (RAYS_PER_EDGE - 1.0f) * 2.0f - 1.0f};
+                directions.push_back(Vector3Scale(Vector3Normalize(dir), STEP));
             }
+        }
+    }
+    
+    // Rays only read the world; hits are collected per ray and merged afterwards
+    std::vector<std::vector<BlockEdit>> rayHits(directions.size());
+    JobSystem::Get().ParallelFor((int)directions.size(), 64, [&](int begin, int end) {
+        for (int r = begin; r < end; r++) {
+            // Cheap per-ray jitter in [0.7, 1.3] so blast edges aren't perfectly round
+            uint32_t hash = (uint32_t)r * 2654435761u;
+            hash ^= hash >> 16;
+            float intensity = power * (0.7f + (hash & 0xFFFF) / 65535.0f * 0.6f);
             
-            // Check if we should render this face
-            if (IsValidPosition(x, y, z) && IsFaceVisible(x, y, z, face, world)) {
-                VoxelType voxelType = voxels[x][y][z].type;
-                std::string textureName = textureManager ? 
-                    textureManager->GetTextureNameForVoxel(voxelType, face) : "stone";
+            Vector3 pos = center;
+            int lastX = INT32_MIN, lastY = INT32_MIN, lastZ = INT32_MIN;
+            while (intensity > 0.0f) {
+                int x = (int)floorf(pos.x + 0.5f);
+                int y = (int)floorf(pos.y + 0.5f);
+                int z = (int)floorf(pos.z + 0.5f);
+                if (y < 0 || y >= VoxelChunk::CHUNK_HEIGHT) break;
                 
-                mask[u][v] = FaceMask(true, voxelType, textureName);
+                VoxelType type = GetVoxel(x, y, z).type;
+                if (type != VOXEL_AIR) {
+                    if (resistance[type] < 0.0f) break;
+                    intensity -= (resistance[type] + STEP) * STEP;
+                    bool newCell = x != lastX || y != lastY || z != lastZ;
+                    if (intensity > 0.0f && breakable[type] && newCell) {
+                        rayHits[r].emplace_back(x, y, z, type);
+                    }
+                }
+                lastX = x; lastY = y; lastZ = z;
+                
+                intensity -= AIR_FALLOFF;
+                pos = Vector3Add(pos, directions[r]);
             }
         }
+    });
+    
+    std::vector<BlockEdit> hits;
+    for (const std::vector<BlockEdit>& rayHit : rayHits) {
+        hits.insert(hits.end(), rayHit.begin(), rayHit.end());
     }
+    std::sort(hits.begin(), hits.end(), [](const BlockEdit& a, const BlockEdit& b) {
+        if (a.x != b.x) return a.x < b.x;
+        if (a.y != b.y) return a.y < b.y;
+        return a.z < b.z;
+    });
+    hits.erase(std::unique(hits.begin(), hits.end(), [](const BlockEdit& a, const BlockEdit& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }), hits.end());
+    
+    // One batch: each touched chunk is remeshed once and listeners hear about it once
+    std::vector<BlockEdit> edits;
+    edits.reserve(hits.size());
+    for (const BlockEdit& hit : hits) {
+        edits.emplace_back(hit.x, hit.y, hit.z, VOXEL_AIR);
+    }
+    ApplyEdits(edits);
+    
+    if (destroyed) {
+        destroyed->insert(destroyed->end(), hits.begin(), hits.end());
+    }
+    return (int)hits.size();
 }
 
-void VoxelChunk::GreedyMeshFace(FaceDirection face, int layer, FaceMask mask[CHUNK_SIZE][CHUNK_SIZE], 
-                                std::vector<QuadMesh>& quads) {
-    // Create a copy of the mask to mark processed areas
-    bool processed[CHUNK_SIZE][CHUNK_SIZE] = {false};
+void VoxelWorld::GenerateTestTerrain() {
+    const int SEA_LEVEL = 3;
+    const int tallGrass = BlockRegistry::Get().FindBlock("tall_grass");  // -1 without blocks.json
+    const int rose = BlockRegistry::Get().FindBlock("rose");
     
-    for (int u = 0; u < CHUNK_SIZE; u++) {
-        for (int v = 0; v < CHUNK_SIZE; v++) {
-            if (processed[u][v] || !mask[u][v].visible) continue;
-            
-            // Find the width of the quad (extend in u direction)
-            int width = 1;
-            while (u + width < CHUNK_SIZE && 
-                   !processed[u + width][v] && 
-                   mask[u + width][v].visible &&
-                   mask[u + width][v] == mask[u][v]) {
-                width++;
-            }
+    for (int chunkX = 0; chunkX < worldWidth; chunkX++) {
+        for (int chunkZ = 0; chunkZ < worldDepth; chunkZ++) {
+            BeginChunkLoad(chunkX, chunkZ);
+        }
+    }
+    
+    // Generate a simple test terrain
+    for (int x = 0; x < worldWidth * VoxelChunk::CHUNK_SIZE; x++) {
+        for (int z = 0; z < worldDepth * VoxelChunk::CHUNK_SIZE; z++) {
+            // Simple height map
+            int height = 4 + (int)(sin(x * 0.1f) * cos(z * 0.1f) * 3.0f);
             
-            // Find the height of the quad (extend in v direction)
-            int height = 1;
-            bool canExtend = true;
-            while (v + height < CHUNK_SIZE && canExtend) {
-                // Check if the entire row can be extended
-                for (int i = 0; i < width; i++) {
-                    if (processed[u + i][v + height] || 
-                        !mask[u + i][v + height].visible ||
-                        !(mask[u + i][v + height] == mask[u][v])) {
-                        canExtend = false;
-                        break;
-                    }
-                }
-                if (canExtend) height++;
+            for (int y = 0; y < height && y < VoxelChunk::CHUNK_HEIGHT; y++) {
+                VoxelType type = VOXEL_STONE;
+                if (y == height - 1) type = VOXEL_GRASS;
+                else if (y >= height - 3) type = VOXEL_DIRT;
+                
+                SetVoxel(x, y, z, type);
             }
             
-            // Mark the quad area as processed
-            for (int i = 0; i < width; i++) {
-                for (int j = 0; j < height; j++) {
-                    processed[u + i][v + j] = true;
-                }
+            // Flood low ground up to sea level with still water
+            for (int y = height; y < SEA_LEVEL; y++) {
+                SetVoxel(x, y, z, VOXEL_WATER);
             }
             
-            // Create the quad with the position of the first voxel
-            Vector3 startPosition;
-            
-            // Convert u,v coordinates and layer back to world position
-            switch (face) {
-                case FACE_TOP:
-                    startPosition = GetWorldPosition(u, layer, v);
-                    break;
-                case FACE_BOTTOM:
-                    startPosition = GetWorldPosition(u, layer, v);
-                    break;
-                case FACE_FRONT:
-                    startPosition = GetWorldPosition(u, v, layer);
-                    break;
-                case FACE_BACK:
-                    startPosition = GetWorldPosition(u, v, layer);
-                    break;
-                case FACE_RIGHT:
-                    startPosition = GetWorldPosition(layer, v, u);
-                    break;
-                case FACE_LEFT:
-                    startPosition = GetWorldPosition(layer, v, u);
-                    break;
+            // Scatter plants on dry grass
+            if (height >= SEA_LEVEL && height < VoxelChunk::CHUNK_HEIGHT) {
+                uint32_t roll = PositionHash(x, height, z) % 100;
+                if (roll < 2 && rose >= 0) SetVoxel(x, height, z, (VoxelType)rose);
+                else if (roll < 14 && tallGrass >= 0) SetVoxel(x, height, z, (VoxelType)tallGrass);
             }
-            
-            quads.emplace_back(startPosition, width, height, face, mask[u][v].textureName);
         }
     }
-}
-
-void VoxelChunk::AddQuadToMesh(std::vector<Vector3>& vertices, std::vector<Vector3>& normals, 
-                               std::vector<Vector2>& texcoords, std::vector<Color>& colors,
-                               const QuadMesh& quad) const {
-    // Instead of creating custom vertex logic, use the original AddFaceToMesh for each voxel position
-    // This preserves the exact same rotation and positioning as the working single-face system
     
-    for (int w = 0; w < quad.width; w++) {
-        for (int h = 0; h < quad.height; h++) {
-            Vector3 voxelPosition = quad.startPosition;
-            
-            // Calculate the position offset for this voxel in the quad
-            switch (quad.face) {
-                case FACE_TOP:
-                case FACE_BOTTOM:
-                    // For top/bottom faces: width extends in X, height extends in Z
-                    voxelPosition.x += w;
-                    voxelPosition.z += h;
-                    break;
-                case FACE_FRONT:
-                case FACE_BACK:
-                    // For front/back faces: width extends in X, height extends in Y
-                    voxelPosition.x += w;
-                    voxelPosition.y += h;
-                    break;
-                case FACE_RIGHT:
-                case FACE_LEFT:
-                    // For left/right faces: width extends in Z, height extends in Y
-                    voxelPosition.z += w;
-                    voxelPosition.y += h;
-                    break;
-            }
-            
-            // Use the original AddFaceToMesh function - this keeps rotation/positioning identical
-            AddFaceToMesh(vertices, normals, texcoords, colors, voxelPosition, quad.face);
+    for (int chunkX = 0; chunkX < worldWidth; chunkX++) {
+        for (int chunkZ = 0; chunkZ < worldDepth; chunkZ++) {
+            FinishChunkLoad(chunkX, chunkZ);
         }
     }
 }
-
@@ -0,0 +1,111 @@
+#include "../include/job_system.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+// Stress test for JobSystem, meant to run under ThreadSanitizer: see the "build job
+// system stress test (tsan)" task. Covers nested ParallelFor, jobs spawning jobs
+// on a shared counter, build -> main-thread chains like the mesh pipeline's, and
+// background jobs running meanwhile. Exits non-zero on a wrong total.
+
+namespace {
+    bool Expect(long long actual, long long expected, const char* what) {
+        if (actual != expected) {
+            printf("FAILED: %s: %lld, expected %lld\n", what, actual, expected);
+        }
+        return actual == expected;
+    }
+
+    // Plain writes from workers, read on the main thread after the ParallelFor returns
+    bool RunNestedParallelFor(JobSystem& jobs) {
+        const int OUTER = 64, INNER = 256;
+        std::vector<int> cells(OUTER * INNER, 0);
+        jobs.ParallelFor(OUTER, 1, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                jobs.ParallelFor(INNER, 16, [&, i](int innerBegin, int innerEnd) {
+                    for (int j = innerBegin; j < innerEnd; j++) cells[i * INNER + j] += i + j;
+                });
+            }
+        });
+        long long sum = 0;
+        for (int value : cells) sum += value;
+        return Expect(sum, (long long)INNER * OUTER * (OUTER - 1) / 2 + (long long)OUTER * INNER * (INNER - 1) / 2,
+                      "nested ParallelFor");
+    }
+
+    // A binary tree of jobs, each counted on the same counter before its parent finishes
+    void Spawn(JobSystem& jobs, JobCounter& counter, std::atomic<int>& leaves, int depth) {
+        if (depth == 0) {
+            leaves.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        for (int child = 0; child < 2; child++) {
+            jobs.Submit([&jobs, &counter, &leaves, depth]() { Spawn(jobs, counter, leaves, depth - 1); },
+                        JOB_NORMAL, &counter);
+        }
+    }
+
+    bool RunRecursiveSpawn(JobSystem& jobs) {
+        JobCounter counter;
+        std::atomic<int> leaves(0);
+        jobs.Submit([&]() { Spawn(jobs, counter, leaves, 10); }, JOB_NORMAL, &counter);
+        jobs.Wait(counter);
+        return Expect(leaves.load(), 1 << 10, "recursive spawn");
+    }
+
+    // Worker builds into plain memory; its main-thread continuation reads it, like
+    // BuildMesh followed by UploadPendingMesh. Drained either by Wait, as the mesh
+    // pipeline does, or by polling RunMainThreadJobs like the frame loop, which never
+    // runs a build itself and so catches a continuation released too early.
+    bool RunMainThreadChains(JobSystem& jobs, bool poll) {
+        const int CHAINS = 200;
+        std::vector<std::vector<int>> built(CHAINS);
+        std::unique_ptr<JobCounter[]> builds(new JobCounter[CHAINS]);
+        JobCounter uploaded;
+        long long sum = 0;
+        int wrongThread = 0;
+        for (int i = 0; i < CHAINS; i++) {
+            jobs.Submit([&built, i]() { built[i].assign(100, i); }, JOB_HIGH, &builds[i]);
+            jobs.SubmitMainThreadAfter(builds[i], [&, i]() {
+                if (!jobs.IsMainThread()) wrongThread++;
+                for (int value : built[i]) sum += value;
+            }, &uploaded);
+        }
+        if (poll) {
+            while (!uploaded.IsDone()) jobs.RunMainThreadJobs();
+        } else {
+            jobs.Wait(uploaded, JOB_HIGH);
+        }
+        return Expect(wrongThread, 0, "continuations off the main thread") &&
+               Expect(sum, 100LL * CHAINS * (CHAINS - 1) / 2, "main-thread chains");
+    }
+}
+
+// Usage: jobSystemStressTest [rounds] [workers]
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20;
+    int workers = argc > 2 ? atoi(argv[2]) : 4;  // More than the cores, to shake out interleavings
+    JobSystem jobs(workers);
+
+    // Background work competing for the workers throughout, as path requests do
+    JobCounter background;
+    std::atomic<long long> backgroundSum(0);
+    for (int i = 0; i < 1000; i++) {
+        jobs.Submit([&backgroundSum, i]() { backgroundSum.fetch_add(i, std::memory_order_relaxed); },
+                    JOB_LOW, &background);
+    }
+
+    for (int round = 0; round < rounds; round++) {
+        if (!RunNestedParallelFor(jobs) || !RunRecursiveSpawn(jobs) || !RunMainThreadChains(jobs, false) ||
+            !RunMainThreadChains(jobs, true)) {
+            return 1;
+        }
+    }
+    jobs.Wait(background);
+    if (!Expect(backgroundSum.load(), 1000LL * 999 / 2, "background jobs")) return 1;
+
+    printf("job system: %d rounds ok on %d workers\n", rounds, jobs.GetWorkerCount());
+    return 0;
+}
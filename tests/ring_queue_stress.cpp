@@ -0,0 +1,120 @@
+#include "../include/ring_queue.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stress test for SpscRingQueue and MpscRingQueue, meant to run under ThreadSanitizer:
+// see the "build queue stress test (tsan)" task. Small capacities keep the queues
+// wrapping and running full, and every value carries a heap-allocated string so a
+// slot read before its write was published shows up as a race or a wrong payload.
+// Exits non-zero on the first lost, duplicated or reordered item.
+
+namespace {
+    struct Item {
+        int producer;
+        int sequence;
+        std::string payload;
+    };
+
+    std::string PayloadFor(int producer, int sequence) {
+        return std::to_string(producer) + ":" + std::to_string(sequence) + ":padding-past-small-string-storage";
+    }
+
+    bool Check(bool condition, const char* what, const Item& item) {
+        if (!condition) {
+            printf("FAILED: %s (producer %d, sequence %d)\n", what, item.producer, item.sequence);
+        }
+        return condition;
+    }
+
+    // One producer, one consumer, alternating single pops and batches
+    bool RunSpsc(int items, size_t capacity) {
+        SpscRingQueue<Item> queue(capacity);
+        std::thread producer([&]() {
+            for (int i = 0; i < items; i++) {
+                Item item{0, i, PayloadFor(0, i)};
+                while (!queue.TryPush(item)) std::this_thread::yield();
+            }
+        });
+
+        int expected = 0;
+        bool ok = true;
+        std::vector<Item> batch;
+        while (ok && expected < items) {
+            batch.clear();
+            if (expected % 3 == 0) {
+                Item item;
+                if (queue.TryPop(item)) batch.push_back(std::move(item));
+            } else {
+                queue.PopBatch(batch, 1 + expected % 7);
+            }
+            if (batch.empty()) std::this_thread::yield();
+            for (const Item& item : batch) {
+                ok = ok && Check(item.sequence == expected, "spsc order", item) &&
+                     Check(item.payload == PayloadFor(0, item.sequence), "spsc payload", item);
+                expected++;
+            }
+        }
+        producer.join();
+        Item extra;
+        return ok && !queue.TryPop(extra);
+    }
+
+    // Several producers; each one's items must come out in the order it pushed them
+    bool RunMpsc(int producers, int itemsPerProducer, size_t capacity) {
+        MpscRingQueue<Item> queue(capacity);
+        std::atomic<bool> start(false);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                while (!start.load()) std::this_thread::yield();
+                for (int i = 0; i < itemsPerProducer; i++) {
+                    Item item{p, i, PayloadFor(p, i)};
+                    while (!queue.TryPush(item)) std::this_thread::yield();
+                }
+            });
+        }
+        start.store(true);
+
+        std::vector<int> next(producers, 0);
+        int received = 0;
+        bool ok = true;
+        std::vector<Item> batch;
+        while (ok && received < producers * itemsPerProducer) {
+            batch.clear();
+            if (received % 2 == 0) {
+                Item item;
+                if (queue.TryPop(item)) batch.push_back(std::move(item));
+            } else {
+                queue.PopBatch(batch, 1 + received % 5);
+            }
+            if (batch.empty()) std::this_thread::yield();
+            for (const Item& item : batch) {
+                ok = ok && Check(item.producer >= 0 && item.producer < producers, "mpsc producer", item) &&
+                     Check(item.sequence == next[item.producer], "mpsc per-producer order", item) &&
+                     Check(item.payload == PayloadFor(item.producer, item.sequence), "mpsc payload", item);
+                if (ok) next[item.producer]++;
+                received++;
+            }
+        }
+        for (std::thread& thread : threads) thread.join();
+        Item extra;
+        return ok && !queue.TryPop(extra);
+    }
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20;
+
+    for (int round = 0; round < rounds; round++) {
+        size_t capacity = (size_t)2 << (round % 5);  // 2 .. 32
+        if (!RunSpsc(20000, capacity)) return 1;
+        if (!RunMpsc(4, 5000, capacity)) return 1;
+        if (!RunMpsc(16, 500, capacity)) return 1;
+    }
+    printf("ring queues: %d rounds ok\n", rounds);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "../include/spatial_grid.h"
+#include "../include/voxel.h"
+#include "../include/block_registry.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Regression test for world -> chunk coordinate conversion at negative coordinates
+// and for SpatialGrid::BoxHitsVoxels on boxes at or past the world edges, which once
+// looped forever at x = -16. A watchdog fails the run instead of letting it hang.
+// See the "build voxel coords test" task; run from the workspace folder so
+// assets/data/blocks.json is found. Exits non-zero on the first failure.
+
+namespace {
+    const int WATCHDOG_SECONDS = 10;
+
+    bool Check(bool condition, const char* what, int value) {
+        if (!condition) {
+            printf("FAILED: %s (%d)\n", what, value);
+        }
+        return condition;
+    }
+
+    bool CheckChunkCoords(const VoxelWorld& world) {
+        bool ok = true;
+        for (int worldX = -70; worldX <= 70; worldX++) {
+            int chunkX, chunkZ, localX, localZ;
+            world.WorldToChunkCoords(worldX, -worldX, chunkX, chunkZ, localX, localZ);
+
+            ok &= Check(localX >= 0 && localX < VoxelChunk::CHUNK_SIZE, "local x in range", worldX);
+            ok &= Check(localZ >= 0 && localZ < VoxelChunk::CHUNK_SIZE, "local z in range", worldX);
+            ok &= Check(chunkX * VoxelChunk::CHUNK_SIZE + localX == worldX, "x round trip", worldX);
+            ok &= Check(chunkZ * VoxelChunk::CHUNK_SIZE + localZ == -worldX, "z round trip", worldX);
+        }
+        return ok;
+    }
+
+    BoundingBox BoxAround(float x, float y, float z, float halfSize) {
+        return (BoundingBox){{x - halfSize, y - halfSize, z - halfSize}, {x + halfSize, y + halfSize, z + halfSize}};
+    }
+
+    bool CheckBoxes(const VoxelWorld& world) {
+        bool ok = true;
+        int span = world.GetWidth() * VoxelChunk::CHUNK_SIZE;
+
+        // Past the west and north edges, across chunk-sized steps: nothing there is solid
+        for (int edge = -64; edge <= 0; edge += VoxelChunk::CHUNK_SIZE) {
+            for (float offset = -1.0f; offset <= 1.0f; offset += 0.25f) {
+                float v = edge + offset - 1.5f;
+                ok &= Check(!SpatialGrid::BoxHitsVoxels(&world, BoxAround(v, 4.0f, 8.0f, 0.3f)), "clear past -x", edge);
+                ok &= Check(!SpatialGrid::BoxHitsVoxels(&world, BoxAround(8.0f, 4.0f, v, 0.3f)), "clear past -z", edge);
+                ok &= Check(!SpatialGrid::BoxHitsVoxels(&world, BoxAround(v, 4.0f, v, 0.3f)), "clear past both", edge);
+            }
+        }
+
+        // Boxes reaching in from outside still find blocks on the edges
+        ok &= Check(SpatialGrid::BoxHitsVoxels(&world, BoxAround(-0.4f, 4.0f, 5.0f, 0.3f)), "hit at x = 0", 0);
+        ok &= Check(SpatialGrid::BoxHitsVoxels(&world, BoxAround(5.0f, 4.0f, -0.4f, 0.3f)), "hit at z = 0", 0);
+        ok &= Check(SpatialGrid::BoxHitsVoxels(&world, BoxAround(span - 0.6f, 4.0f, 5.0f, 0.3f)), "hit at the far x edge", span);
+
+        // A box spanning the whole world and beyond
+        BoundingBox everything = {{-40.0f, -40.0f, -40.0f}, {span + 40.0f, 40.0f, span + 40.0f}};
+        ok &= Check(SpatialGrid::BoxHitsVoxels(&world, everything), "hit from a box covering the world", span);
+        return ok;
+    }
+}
+
+int main() {
+    std::thread watchdog([]() {
+        std::this_thread::sleep_for(std::chrono::seconds(WATCHDOG_SECONDS));
+        printf("FAILED: still running after %d seconds\n", WATCHDOG_SECONDS);
+        fflush(stdout);
+        std::_Exit(1);
+    });
+    watchdog.detach();
+
+    BlockRegistry::Get().LoadModels();
+    BlockRegistry::Get().LoadFromJson();
+    VoxelWorld world(2, 2);
+    int span = world.GetWidth() * VoxelChunk::CHUNK_SIZE;
+    world.SetVoxel(0, 4, 5, VOXEL_STONE);
+    world.SetVoxel(5, 4, 0, VOXEL_STONE);
+    world.SetVoxel(span - 1, 4, 5, VOXEL_STONE);
+
+    bool ok = CheckChunkCoords(world);
+    ok &= CheckBoxes(world);
+
+    printf(ok ? "voxel coords test passed\n" : "voxel coords test FAILED\n");
+    return ok ? 0 : 1;
+}